@@ -0,0 +1,190 @@
+/*
+ *  pico]OS memory function example 1
+ *
+ *  Benchmark of the nano layer memory functions.
+ *
+ *  The example measures the throughput of the functions nosMemSet,
+ *  nosMemCopy, nosMemMove and nosMemCmp for several block sizes and
+ *  several source / destination alignments, and compares the results
+ *  with a simple byte copy loop. Every function is executed as often
+ *  as possible for a fixed count of timer ticks. The results are
+ *  printed in kilobytes per second.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+
+/* Include source code for pico]OS
+ * initialization with nano layer.
+ */
+#include "ex_init4.c"
+
+
+/* we need some features to be enabled */
+#if POSCFG_FEATURE_JIFFIES == 0
+#error The feature POSCFG_FEATURE_JIFFIES is not enabled!
+#endif
+#if NOSCFG_FEATURE_CONOUT == 0
+#error The feature NOSCFG_FEATURE_CONOUT is not enabled!
+#endif
+#if NOSCFG_FEATURE_PRINTF == 0
+#error The feature NOSCFG_FEATURE_PRINTF is not enabled!
+#endif
+#if (NOSCFG_FEATURE_MEMSET == 0) || (NOSCFG_FEATURE_MEMCOPY == 0)
+#error The features NOSCFG_FEATURE_MEMSET and NOSCFG_FEATURE_MEMCOPY must be enabled!
+#endif
+#if (NOSCFG_FEATURE_MEMMOVE == 0) || (NOSCFG_FEATURE_MEMCMP == 0)
+#error The features NOSCFG_FEATURE_MEMMOVE and NOSCFG_FEATURE_MEMCMP must be enabled!
+#endif
+
+
+/* count of timer ticks every single measurement runs */
+#define BENCH_TICKS   (HZ / 4 + 1)
+
+/* largest block size that is measured, plus some space for misalignment */
+#define BENCH_MAXSIZE 2048
+#define BENCH_BUFSIZE (BENCH_MAXSIZE + 16)
+
+/* memory buffers */
+static char srcbuf_g[BENCH_BUFSIZE];
+static char dstbuf_g[BENCH_BUFSIZE];
+
+/* tested block sizes */
+static const UINT_t sizes_g[] = { 8, 32, 128, 512, BENCH_MAXSIZE };
+#define SIZES  (sizeof(sizes_g) / sizeof(sizes_g[0]))
+
+/* tested source / destination offsets */
+static const UVAR_t aligns_g[][2] = { {0,0}, {1,1}, {0,1}, {3,0}, {1,6} };
+#define ALIGNS (sizeof(aligns_g) / sizeof(aligns_g[0]))
+
+/* function numbers */
+#define FUNC_BYTECOPY  0
+#define FUNC_MEMCOPY   1
+#define FUNC_MEMMOVE   2
+#define FUNC_MEMSET    3
+#define FUNC_MEMCMP    4
+#define FUNCS          5
+
+static const char *funcname_g[FUNCS] =
+  { "bytecopy", "nosMemCopy", "nosMemMove", "nosMemSet", "nosMemCmp" };
+
+
+/* function prototypes */
+void firsttask(void *arg);
+static void bytecopy(char *dst, const char *src, UINT_t count);
+static unsigned long measure(UVAR_t func, char *dst, char *src, UINT_t size);
+
+
+
+/* Reference function: simple byte copy loop.
+ * Note that optimizing compilers may replace this loop
+ * by a call to the memcpy function of the runtime library.
+ */
+static void bytecopy(char *dst, const char *src, UINT_t count)
+{
+  while (count != 0)
+  {
+    *dst++ = *src++;
+    --count;
+  }
+}
+
+
+
+/* Executes a memory function as often as possible for BENCH_TICKS ticks.
+ * Returns the throughput in kilobytes per second.
+ */
+static unsigned long measure(UVAR_t func, char *dst, char *src, UINT_t size)
+{
+  unsigned long calls = 0;
+  JIF_t  start;
+  VAR_t  cmp = 0;
+
+  /* synchronize to the timer tick */
+  start = jiffies;
+  while (start == jiffies);
+  start = jiffies;
+
+  while ((JIF_t)(jiffies - start) < BENCH_TICKS)
+  {
+    switch (func)
+    {
+      case FUNC_BYTECOPY: bytecopy(dst, src, size);     break;
+      case FUNC_MEMCOPY:  nosMemCopy(dst, src, size);   break;
+      case FUNC_MEMMOVE:  nosMemMove(dst, src, size);   break;
+      case FUNC_MEMSET:   nosMemSet(dst, 0x5A, size);   break;
+      default:            cmp |= nosMemCmp(dst, src, size); break;
+    }
+    calls++;
+  }
+
+  /* avoid that the compiler optimizes the compare function away */
+  if (cmp == 127)
+    nosPrint("?");
+
+  return (calls * size * HZ) / (1024UL * BENCH_TICKS);
+}
+
+
+
+/* This function is executed by the first task that is started
+ * by pico]OS ( see the nosInit()-call in main(), file ex_init4.c ).
+ */
+void firsttask(void *arg)
+{
+  UVAR_t  s, a, f;
+  UINT_t  i;
+
+  (void) arg;
+
+  /* fill source buffer with a pattern */
+  for (i = 0; i < BENCH_BUFSIZE; i++)
+  {
+    srcbuf_g[i] = (char) i;
+  }
+
+  nosPrint("Memory function benchmark, results in KB/s\n\n");
+
+  for (f = 0; f < FUNCS; f++)
+  {
+    nosPrintf1("%s:\n", funcname_g[f]);
+    nosPrint("  size  0/0    1/1    0/1    3/0    1/6   (src/dst offset)\n");
+
+    for (s = 0; s < SIZES; s++)
+    {
+      nosPrintf1("  %4u", sizes_g[s]);
+
+      for (a = 0; a < ALIGNS; a++)
+      {
+        /* compare needs equal buffers to scan the full block */
+        if (f == FUNC_MEMCMP)
+        {
+          nosMemCopy(dstbuf_g + aligns_g[a][1],
+                     srcbuf_g + aligns_g[a][0], sizes_g[s]);
+        }
+
+        nosPrintf1(" %6u", (UINT_t)
+                   measure(f, dstbuf_g + aligns_g[a][1],
+                           srcbuf_g + aligns_g[a][0], sizes_g[s]));
+      }
+      nosPrint("\n");
+    }
+    nosPrint("\n");
+  }
+
+  /* verify the results of the copy functions */
+  nosMemSet(dstbuf_g, 0, BENCH_BUFSIZE);
+  nosMemCopy(dstbuf_g + 1, srcbuf_g + 6, BENCH_MAXSIZE);
+  if (nosMemCmp(dstbuf_g + 1, srcbuf_g + 6, BENCH_MAXSIZE) != 0)
+  {
+    nosPrint("ERROR: nosMemCopy failed!\n");
+  }
+  nosMemMove(dstbuf_g + 3, dstbuf_g + 1, BENCH_MAXSIZE);
+  if (nosMemCmp(dstbuf_g + 3, srcbuf_g + 6, BENCH_MAXSIZE) != 0)
+  {
+    nosPrint("ERROR: nosMemMove failed!\n");
+  }
+
+  nosPrint("Benchmark finished.\n");
+}
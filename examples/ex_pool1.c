@@ -0,0 +1,105 @@
+/*
+ *  pico]OS task pool example 1
+ *
+ *  How to use a task pool to execute jobs in parallel.
+ *
+ *  A pool of three worker tasks is created. The first task submits
+ *  several jobs to the pool and collects the results of the jobs with
+ *  the function nosJobWait. One job is released without waiting for
+ *  its result. At the end the pool is joined, that means the first
+ *  task waits until all workers have terminated.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+
+/* Include source code for pico]OS
+ * initialization with nano layer.
+ */
+#include "ex_init4.c"
+
+
+/* we need some features to be enabled */
+#if NOSCFG_FEATURE_TASKPOOL == 0
+#error The feature NOSCFG_FEATURE_TASKPOOL is not enabled!
+#endif
+#if NOSCFG_FEATURE_PRINTF == 0
+#error The feature NOSCFG_FEATURE_PRINTF is not enabled!
+#endif
+#if POSCFG_FEATURE_SLEEP == 0
+#error The feature POSCFG_FEATURE_SLEEP is not enabled!
+#endif
+
+
+/* count of jobs the first task submits */
+#define JOBS  6
+
+
+/* function prototypes */
+void  firsttask(void *arg);
+void* jobfunc(void *arg);
+
+
+
+/* This is the job function. It is executed by the
+ * worker tasks of the pool. The function simulates
+ * some work and returns the square of its argument.
+ */
+void* jobfunc(void *arg)
+{
+  UINT_t n = (UINT_t)(MEMPTR_t) arg;
+
+  nosPrintf1("job %u started\n", n);
+  nosTaskSleep(MS(100) * n);
+  nosPrintf1("job %u done\n", n);
+  return (void*)(MEMPTR_t)(n * n);
+}
+
+
+
+/* This function is executed by the first task that is started
+ * by pico]OS ( see the nosInit()-call in main(), file ex_init4.c ).
+ */
+void firsttask(void *arg)
+{
+  NOSPOOL_t  pool;
+  NOSJOB_t   job[JOBS];
+  void       *result;
+  UINT_t     i;
+
+  (void) arg;
+
+  /* create a pool of three worker tasks */
+  pool = nosPoolCreate(3, 2, 0);
+  if (pool == NULL)
+  {
+    nosPrint("Failed to create the task pool!\n");
+    return;
+  }
+
+  /* submit the jobs */
+  for (i = 0; i < JOBS; i++)
+  {
+    job[i] = nosPoolSubmit(pool, jobfunc, (void*)(MEMPTR_t)(i + 1));
+  }
+
+  /* we are not interested in the result of the first job */
+  nosJobRelease(job[0]);
+
+  /* collect the results of the other jobs */
+  for (i = 1; i < JOBS; i++)
+  {
+    result = NULL;
+    while (nosJobWait(job[i], MS(150), &result) > 0)
+    {
+      nosPrintf1("waiting for job %u ...\n", i + 1);
+    }
+    nosPrintf2("result of job %u is %u\n",
+               i + 1, (UINT_t)(MEMPTR_t) result);
+  }
+
+  /* wait until all workers have terminated */
+  nosPoolJoin(pool);
+  nosPrint("task pool joined\n");
+}
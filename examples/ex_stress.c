@@ -0,0 +1,699 @@
+/*
+ *  pico]OS stress test
+ *
+ *  Randomized workload generator that shows how the kernel scales
+ *  with the count of tasks and objects.
+ *
+ *  STRESS_TASKS worker tasks run a random mix of operations on
+ *  STRESS_SEMAS semaphores, STRESS_MUTEXES mutexes, STRESS_FLAGS flag
+ *  objects and STRESS_LISTS lists, and send messages to each other.
+ *  STRESS_TIMERS periodic timers signal a semaphore the workers poll,
+ *  and an injector task raises bursts of software interrupts whose
+ *  handlers set flags and signal a semaphore, like hardware interrupts
+ *  would do. After STRESS_SECONDS the workers are stopped, the
+ *  invariants of all objects are checked and the throughput is
+ *  printed in operations per second.
+ *
+ *  The workers share one priority and use only the non-blocking
+ *  variants of the functions (timeout 0, posMutexTryLock), so the
+ *  throughput is limited by the kernel and not by the timer tick.
+ *  Operations that found the object busy or empty are counted too.
+ *  Every operation is chosen at random with the same probability, so
+ *  the count of operations is about the same for all kinds. With
+ *  POSCFG_FEATURE_HRTIME the time of each operation is measured, and
+ *  the mean cost of every kind is printed in nanoseconds. Operations
+ *  that yielded to another task are not measured.
+ *  On host ports the program exits with status 0 when the test
+ *  passed and with status 1 when it failed (STRESS_EXIT).
+ *
+ *  All STRESS_ defines can be overridden on the compiler command line,
+ *  e.g. -DSTRESS_TASKS=32 -DSTRESS_MUTEXES=16. The pico]OS
+ *  configuration must provide enough tasks, events, messages and
+ *  timers (POSCFG_MAX_TASKS, POSCFG_MAX_EVENTS, ...), every worker
+ *  needs an event for its message box. On the Unix / Linux port, the
+ *  operating system can be observed meanwhile with the statistics
+ *  page (see nosStatPageStart and ports/unix/tools/statview.c).
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+
+/* Include source code for pico]OS
+ * initialization with nano layer.
+ */
+#include "ex_init4.c"
+
+
+/* we need some features to be enabled */
+#if POSCFG_FEATURE_SEMAWAIT == 0
+#error The feature POSCFG_FEATURE_SEMAWAIT is not enabled!
+#endif
+#if POSCFG_FEATURE_MUTEXES == 0 || POSCFG_FEATURE_MUTEXTRYLOCK == 0
+#error The feature POSCFG_FEATURE_MUTEXTRYLOCK is not enabled!
+#endif
+#if POSCFG_FEATURE_FLAGS == 0 || POSCFG_FEATURE_FLAGWAIT == 0
+#error The feature POSCFG_FEATURE_FLAGWAIT is not enabled!
+#endif
+#if POSCFG_FEATURE_MSGBOXES == 0
+#error The feature POSCFG_FEATURE_MSGBOXES is not enabled!
+#endif
+#if POSCFG_FEATURE_LISTS == 0
+#error The feature POSCFG_FEATURE_LISTS is not enabled!
+#endif
+#if POSCFG_FEATURE_TIMER == 0
+#error The feature POSCFG_FEATURE_TIMER is not enabled!
+#endif
+#if POSCFG_FEATURE_SOFTINTS == 0
+#error The feature POSCFG_FEATURE_SOFTINTS is not enabled!
+#endif
+#if POSCFG_FEATURE_JIFFIES == 0
+#error The feature POSCFG_FEATURE_JIFFIES is not enabled!
+#endif
+#if POSCFG_FEATURE_SETPRIORITY == 0
+#error The feature POSCFG_FEATURE_SETPRIORITY is not enabled!
+#endif
+#if NOSCFG_FEATURE_PRINTF == 0
+#error The feature NOSCFG_FEATURE_PRINTF is not enabled!
+#endif
+
+
+/* workload configuration */
+#ifndef STRESS_TASKS
+#define STRESS_TASKS      4     /* count of worker tasks */
+#endif
+#ifndef STRESS_SEMAS
+#define STRESS_SEMAS      2     /* count of resource semaphores */
+#endif
+#ifndef STRESS_MUTEXES
+#define STRESS_MUTEXES    1     /* count of mutexes */
+#endif
+#ifndef STRESS_FLAGS
+#define STRESS_FLAGS      1     /* count of flag objects */
+#endif
+#ifndef STRESS_LISTS
+#define STRESS_LISTS      2     /* count of lists */
+#endif
+#ifndef STRESS_LISTELEMS
+#define STRESS_LISTELEMS  16    /* count of elements moved between lists */
+#endif
+#ifndef STRESS_TIMERS
+#define STRESS_TIMERS     2     /* count of periodic timers */
+#endif
+#ifndef STRESS_SECONDS
+#define STRESS_SECONDS    10    /* run time of the test */
+#endif
+#ifndef STRESS_SEED
+#define STRESS_SEED       1     /* seed of the random generators */
+#endif
+#ifndef STRESS_SOFTINT
+#define STRESS_SOFTINT    4     /* software interrupt for the injection */
+#endif
+#ifndef STRESS_EXIT
+#if defined(__unix__) || defined(_WIN32)
+#define STRESS_EXIT       1     /* end the program with an exit status */
+#else
+#define STRESS_EXIT       0
+#endif
+#endif
+
+#if STRESS_SOFTINT >= POSCFG_SOFTINTERRUPTS
+#error STRESS_SOFTINT must be less than POSCFG_SOFTINTERRUPTS
+#endif
+#if STRESS_EXIT != 0
+#include <stdlib.h>
+#endif
+#if NOSCFG_FEATURE_STATPAGE != 0
+#include <pos_stpage.h>
+#endif
+
+/* units a resource semaphore hands out */
+#define SEMA_UNITS        2
+
+/* flag numbers used by the test */
+#define FLAG_BITS         4
+
+/* limit of the messages in flight, so posMessageAlloc never blocks */
+#define MSG_CREDITS       ((POSCFG_MAX_MESSAGES + 1) / 2)
+
+/* priorities of the tasks, the first task runs above all others */
+#define PRIO_WORKER       1
+#define PRIO_STATPAGE     2
+#define PRIO_INJECTOR     (POSCFG_MAX_PRIO_LEVEL - 2)
+
+/* magic numbers to check list elements and messages */
+#define ELEM_MAGIC        0x5A
+#define MSG_MAGIC         0xA5
+
+
+/* operations of the workload */
+#define OP_SEMA     0
+#define OP_MUTEX    1
+#define OP_FLAG     2
+#define OP_LIST     3
+#define OP_MSG      4
+#define OP_TIMER    5
+#define OP_IRQ      6
+#define OP_YIELD    7
+#define OPS         8
+
+static const char *opname_g[OPS] = {
+  "semaphore", "mutex", "flag", "list", "message",
+  "timer", "interrupt", "yield"
+};
+
+/* yields to another worker, an operation that yielded is not timed */
+#if POSCFG_FEATURE_HRTIME != 0
+#define YIELD(yielded)  do { (yielded) = 1; posTaskYield(); } while(0)
+#else
+#define YIELD(yielded)  posTaskYield()
+#endif
+
+
+/* list element */
+typedef struct {
+  POSLIST_t  list;
+  UVAR_t     magic;
+  UVAR_t     taken;
+} ELEM_t;
+
+/* message */
+typedef struct {
+  UVAR_t     magic;
+  UINT_t     sender;
+  UINT_t     check;
+} MESSAGE_t;
+
+/* per-task state */
+typedef struct {
+  POSTASK_t  handle;
+  unsigned long seed;
+  UINT_t     ops[OPS];
+#if POSCFG_FEATURE_HRTIME != 0
+  UINT_t     timed[OPS];
+  POSCYCLES_t cycles[OPS];
+#endif
+  UINT_t     locked;
+  UINT_t     sent;
+  UINT_t     received;
+} WORKER_t;
+
+
+/* function prototypes */
+void firsttask(void *arg);
+void workertask(void *arg);
+void injectortask(void *arg);
+void softinthandler(UVAR_t arg);
+static UINT_t nextrandom(WORKER_t *w);
+static void   takemessages(WORKER_t *w);
+static void   error(const char *text);
+static void   finish(int failed);
+
+
+/* global variables */
+static WORKER_t      worker_g[STRESS_TASKS];
+static POSSEMA_t     sema_g[STRESS_SEMAS];
+static UINT_t        semaholders_g[STRESS_SEMAS];
+static POSMUTEX_t    mutex_g[STRESS_MUTEXES];
+static WORKER_t      *mutexowner_g[STRESS_MUTEXES];
+static UINT_t        mutexcount_g[STRESS_MUTEXES];
+static POSFLAG_t     flag_g[STRESS_FLAGS];
+static POSLISTHEAD_t list_g[STRESS_LISTS];
+static ELEM_t        elem_g[STRESS_LISTELEMS];
+static POSTIMER_t    timer_g[STRESS_TIMERS];
+static POSSEMA_t     tickersema_g;
+static POSSEMA_t     irqsema_g;
+static volatile UINT_t  irqraised_g;
+static volatile UINT_t  irqhandled_g;
+static volatile UVAR_t  stop_g;
+static volatile UINT_t  stopped_g;
+static volatile UINT_t  done_g;
+static volatile UINT_t  credits_g = MSG_CREDITS;
+static volatile UINT_t  errors_g;
+
+
+
+/* Simple linear congruential random generator, one per task.
+ * The low bits of the generator repeat with a short period, so only
+ * the bits 16 to 30 are returned. The highest bits are the most
+ * random ones.
+ */
+static UINT_t nextrandom(WORKER_t *w)
+{
+  w->seed = (w->seed * 1103515245UL + 12345) & 0xFFFFFFFFUL;
+  return (UINT_t) ((w->seed >> 16) & 0x7FFF);
+}
+
+
+
+/* Counts an invariant violation.
+ */
+static void error(const char *text)
+{
+  errors_g++;
+  if (errors_g < 10)
+    nosPrintf1("INVARIANT VIOLATED: %s\n", text);
+}
+
+
+
+/* Ends the test. On host ports the program exits with a status
+ * that tells if the test passed.
+ */
+static void finish(int failed)
+{
+#if STRESS_EXIT != 0
+  exit(failed ? 1 : 0);
+#else
+  (void) failed;
+#endif
+}
+
+
+
+/* Handler of the injected interrupts. Only functions that are allowed
+ * in interrupt context are called here.
+ */
+void softinthandler(UVAR_t arg)
+{
+  irqhandled_g++;
+  posFlagSet(flag_g[arg % STRESS_FLAGS], (UVAR_t) (arg % FLAG_BITS));
+  posSemaSignal(irqsema_g);
+}
+
+
+
+/* This task injects bursts of interrupts once per timer tick.
+ */
+void injectortask(void *arg)
+{
+  WORKER_t  rnd;
+  UINT_t    i, n;
+
+  (void) arg;
+  rnd.seed = STRESS_SEED;
+
+  while (!stop_g)
+  {
+    n = nextrandom(&rnd) % 4;
+    for (i = 0; i < n; i++)
+    {
+      irqraised_g++;
+      posSoftInt(STRESS_SOFTINT, (UVAR_t) nextrandom(&rnd));
+    }
+    posTaskSleep(1);
+  }
+  posTaskSchedLock();
+  done_g++;
+  posTaskSchedUnlock();
+  for(;;)
+    posTaskSleep(HZ);
+}
+
+
+
+/* Receives all messages that are waiting in the message box
+ * of the calling task and checks them.
+ */
+static void takemessages(WORKER_t *w)
+{
+  MESSAGE_t  *msg;
+
+  while (posMessageAvailable() > 0)
+  {
+    msg = (MESSAGE_t*) posMessageGet();
+    if (msg == NULL)
+    {
+      error("message receive failed");
+      break;
+    }
+    if ((msg->magic != MSG_MAGIC) ||
+        (msg->check != (UINT_t) ~msg->sender))
+      error("corrupted message");
+    msg->magic = 0;
+    posMessageFree(msg);
+    posTaskSchedLock();
+    credits_g++;
+    posTaskSchedUnlock();
+    w->received++;
+  }
+}
+
+
+
+/* This function is executed by the worker tasks.
+ */
+void workertask(void *arg)
+{
+  WORKER_t   *w = (WORKER_t*) arg;
+  WORKER_t   *dst;
+  POSLIST_t  *l;
+  ELEM_t     *e;
+  MESSAGE_t  *msg;
+  UINT_t     r, op, i;
+  VAR_t      f;
+#if POSCFG_FEATURE_HRTIME != 0
+  POSCYCLES_t start;
+  UVAR_t     yielded;
+#endif
+
+  while (!stop_g)
+  {
+    /* the operation is taken from the highest bits (seed bits 28..30),
+       the lower bits select the objects */
+    r  = nextrandom(w);
+    op = (r >> 12) % OPS;
+    r  = r & 0xFFF;
+#if POSCFG_FEATURE_HRTIME != 0
+    yielded = 0;
+    start = posGetCycles();
+#endif
+
+    switch (op)
+    {
+      case OP_SEMA:
+        /* take a unit of a resource, at most SEMA_UNITS holders */
+        i = r % STRESS_SEMAS;
+        if (posSemaWait(sema_g[i], 0) != 0)
+          break;
+        posTaskSchedLock();
+        if (++semaholders_g[i] > SEMA_UNITS)
+          error("too many semaphore holders");
+        posTaskSchedUnlock();
+        if (r & 0x100)
+          YIELD(yielded);
+        posTaskSchedLock();
+        --semaholders_g[i];
+        posTaskSchedUnlock();
+        posSemaSignal(sema_g[i]);
+        break;
+
+      case OP_MUTEX:
+        /* mutual exclusion, the counter is only changed by the owner */
+        i = r % STRESS_MUTEXES;
+        if (posMutexTryLock(mutex_g[i]) != 0)
+          break;
+        if (mutexowner_g[i] != NULL)
+          error("mutex owned twice");
+        mutexowner_g[i] = w;
+        mutexcount_g[i]++;
+        w->locked++;
+        if (r & 0x100)
+          YIELD(yielded);
+        if (mutexowner_g[i] != w)
+          error("mutex owner changed");
+        mutexowner_g[i] = NULL;
+        posMutexUnlock(mutex_g[i]);
+        break;
+
+      case OP_FLAG:
+        /* set a flag and take the flags of another flag object */
+        posFlagSet(flag_g[r % STRESS_FLAGS], (UVAR_t) ((r >> 4) % FLAG_BITS));
+        f = posFlagWait(flag_g[(r >> 2) % STRESS_FLAGS], 0);
+        if ((f < 0) || ((UVAR_t) f >= (1 << FLAG_BITS)))
+          error("unexpected flags");
+        break;
+
+      case OP_LIST:
+        /* move an element from one list to another */
+        l = posListGet(&list_g[r % STRESS_LISTS], POSLIST_HEAD, 0);
+        if (l == NULL)
+          break;
+        e = POSLIST_ELEMENT(l, ELEM_t, list);
+        if ((e->magic != ELEM_MAGIC) || (e->taken != 0))
+          error("corrupted list element");
+        e->taken = 1;
+        if (r & 0x100)
+          YIELD(yielded);
+        e->taken = 0;
+        posListAdd(&list_g[(r >> 2) % STRESS_LISTS],
+                   (r & 0x200) ? POSLIST_HEAD : POSLIST_TAIL, &e->list);
+        break;
+
+      case OP_MSG:
+        /* send a message to a random worker, if a credit is available */
+        posTaskSchedLock();
+        i = credits_g;
+        if (i != 0)
+          credits_g = i - 1;
+        posTaskSchedUnlock();
+        if (i != 0)
+        {
+          msg = (MESSAGE_t*) posMessageAlloc();
+          if (msg == NULL)
+          {
+            error("message allocation failed");
+            break;
+          }
+          dst = &worker_g[r % STRESS_TASKS];
+          msg->magic  = MSG_MAGIC;
+          msg->sender = (UINT_t) (w - worker_g);
+          msg->check  = (UINT_t) ~msg->sender;
+          if (posMessageSend(msg, dst->handle) != 0)
+          {
+            error("message send failed");
+            posMessageFree(msg);
+            posTaskSchedLock();
+            credits_g++;
+            posTaskSchedUnlock();
+            break;
+          }
+          w->sent++;
+        }
+        break;
+
+      case OP_TIMER:
+        /* consume a timer tick */
+        (void) posSemaWait(tickersema_g, 0);
+        break;
+
+      case OP_IRQ:
+        /* consume an injected interrupt */
+        (void) posSemaWait(irqsema_g, 0);
+        break;
+
+      default:
+        YIELD(yielded);
+        break;
+    }
+
+#if POSCFG_FEATURE_HRTIME != 0
+    if (!yielded)
+    {
+      w->cycles[op] += posGetCycles() - start;
+      w->timed[op]++;
+    }
+#endif
+    w->ops[op]++;
+    takemessages(w);
+  }
+
+  /* Stop sending. When all workers have stopped,
+     no new messages arrive and the box can be emptied. */
+  posTaskSchedLock();
+  stopped_g++;
+  posTaskSchedUnlock();
+  while (stopped_g < STRESS_TASKS)
+  {
+    takemessages(w);
+    posTaskSleep(1);
+  }
+  takemessages(w);
+  posTaskSchedLock();
+  done_g++;
+  posTaskSchedUnlock();
+
+  for(;;)
+    posTaskSleep(HZ);
+}
+
+
+
+/* This function is executed by the first task that is started
+ * by pico]OS ( see the nosInit()-call in main(), file ex_init4.c ).
+ */
+void firsttask(void *arg)
+{
+  UINT_t  i, j, total, locked, sent, received, elems;
+  UINT_t  ops[OPS];
+  JIF_t   start, ticks;
+#if POSCFG_FEATURE_HRTIME != 0
+  UINT_t  timed[OPS];
+  POSCYCLES_t cycles[OPS];
+#endif
+
+  (void) arg;
+
+  /* create the objects */
+  tickersema_g = posSemaCreate(0);
+  irqsema_g    = posSemaCreate(0);
+  if ((tickersema_g == NULL) || (irqsema_g == NULL))
+    goto failed;
+  for (i = 0; i < STRESS_SEMAS; i++)
+  {
+    if ((sema_g[i] = posSemaCreate(SEMA_UNITS)) == NULL)
+      goto failed;
+  }
+  for (i = 0; i < STRESS_MUTEXES; i++)
+  {
+    if ((mutex_g[i] = posMutexCreate()) == NULL)
+      goto failed;
+  }
+  for (i = 0; i < STRESS_FLAGS; i++)
+  {
+    if ((flag_g[i] = posFlagCreate()) == NULL)
+      goto failed;
+  }
+  for (i = 0; i < STRESS_LISTS; i++)
+  {
+    posListInit(&list_g[i]);
+  }
+  for (i = 0; i < STRESS_LISTELEMS; i++)
+  {
+    elem_g[i].magic = ELEM_MAGIC;
+    elem_g[i].taken = 0;
+    posListAdd(&list_g[i % STRESS_LISTS], POSLIST_TAIL, &elem_g[i].list);
+  }
+  for (i = 0; i < STRESS_TIMERS; i++)
+  {
+    timer_g[i] = posTimerCreate();
+    if ((timer_g[i] == NULL) ||
+        (posTimerSet(timer_g[i], tickersema_g, i + 1, i + 1) != 0))
+      goto failed;
+  }
+  if (posSoftIntSetHandler(STRESS_SOFTINT, softinthandler) != 0)
+    goto failed;
+
+  nosPrintf4("stress test: %u tasks, %u semaphores, %u mutexes, %u flags,",
+             STRESS_TASKS, STRESS_SEMAS, STRESS_MUTEXES, STRESS_FLAGS);
+  nosPrintf3(" %u lists, %u timers, %u seconds\n",
+             STRESS_LISTS, STRESS_TIMERS, STRESS_SECONDS);
+
+  /* The workers never block while the workload runs. They share
+     one priority and are scheduled round robin, and all other tasks
+     run above them. The first task stops them in time. */
+  posTaskSetPriority(posTaskGetCurrent(), POSCFG_MAX_PRIO_LEVEL - 1);
+#if (NOSCFG_FEATURE_STATPAGE != 0) && defined(NOSCFG_STATPAGE_SHMNAME)
+  if (nosStatPageStart(NULL, NOSSTATPAGE_SIZE(POSCFG_MAX_TASKS),
+                       PRIO_STATPAGE, HZ / 2 + 1) != E_OK)
+    nosPrint("statistics page not available\n");
+#endif
+  for (i = 0; i < STRESS_TASKS; i++)
+  {
+    worker_g[i].seed = STRESS_SEED + i * 7919;
+    worker_g[i].handle = nosTaskCreate(workertask, &worker_g[i],
+                                       PRIO_WORKER, 0, NULL);
+    if (worker_g[i].handle == NULL)
+      goto failed;
+  }
+  if (nosTaskCreate(injectortask, NULL, PRIO_INJECTOR,
+                    0, "injector") == NULL)
+    goto failed;
+
+  /* run the workload */
+  start = jiffies;
+  for (i = 0; i < STRESS_TIMERS; i++)
+  {
+    posTimerStart(timer_g[i]);
+  }
+  posTaskSleep(STRESS_SECONDS * HZ);
+  stop_g = 1;
+  ticks = (JIF_t) (jiffies - start);
+  for (i = 0; i < STRESS_TIMERS; i++)
+  {
+    posTimerStop(timer_g[i]);
+  }
+  while (done_g <= STRESS_TASKS)
+  {
+    posTaskSleep(1);
+  }
+
+  /* check the invariants */
+  for (i = 0, elems = 0; i < STRESS_LISTS; i++)
+  {
+    elems += posListLen(&list_g[i]);
+  }
+  if (elems != STRESS_LISTELEMS)
+    error("list elements lost");
+  for (i = 0; i < STRESS_SEMAS; i++)
+  {
+    if ((semaholders_g[i] != 0) || (posSemaWait(sema_g[i], 0) != 0) ||
+        (posSemaWait(sema_g[i], 0) != 0) || (posSemaWait(sema_g[i], 0) == 0))
+      error("semaphore units lost");
+  }
+  for (i = 0; i < OPS; i++)
+  {
+    ops[i] = 0;
+#if POSCFG_FEATURE_HRTIME != 0
+    timed[i]  = 0;
+    cycles[i] = 0;
+#endif
+  }
+  for (i = 0, locked = 0, sent = 0, received = 0; i < STRESS_TASKS; i++)
+  {
+    for (j = 0; j < OPS; j++)
+    {
+      ops[j] += worker_g[i].ops[j];
+#if POSCFG_FEATURE_HRTIME != 0
+      timed[j]  += worker_g[i].timed[j];
+      cycles[j] += worker_g[i].cycles[j];
+#endif
+    }
+    locked   += worker_g[i].locked;
+    sent     += worker_g[i].sent;
+    received += worker_g[i].received;
+  }
+  for (i = 0, j = 0; i < STRESS_MUTEXES; i++)
+  {
+    j += mutexcount_g[i];
+  }
+  if (j != locked)
+    error("mutex counters lost updates");
+  if (sent != received)
+    error("messages lost");
+  if (irqhandled_g != irqraised_g)
+    error("interrupts lost");
+
+  /* print the results */
+  if (ticks == 0)
+    ticks = 1;
+  for (i = 0, total = 0; i < OPS; i++)
+  {
+#if POSCFG_FEATURE_HRTIME != 0
+    /* mean cost of the operations that did not yield */
+    if (timed[i] != 0)
+    {
+      nosPrintf3("%s: %u ops, %u ns/op\n", opname_g[i], ops[i],
+                 (UINT_t) (((POSTIME_t) (cycles[i] / timed[i]) *
+                            1000000000UL) / POS_CYCLES_HZ));
+    }
+    else
+    {
+      nosPrintf2("%s: %u ops, always yielded\n", opname_g[i], ops[i]);
+    }
+#else
+    nosPrintf2("%s: %u ops\n", opname_g[i], ops[i]);
+#endif
+    total += ops[i];
+  }
+  nosPrintf1("total: %u ops/s\n",
+             (UINT_t) (((unsigned long) total * HZ) / ticks));
+  nosPrintf2("messages: %u sent, %u received\n", sent, received);
+  nosPrintf2("interrupts: %u raised, %u handled\n",
+             irqraised_g, irqhandled_g);
+  if (errors_g == 0)
+  {
+    nosPrint("stress test passed\n");
+  }
+  else
+  {
+    nosPrintf1("stress test FAILED, %u invariant violations\n", errors_g);
+  }
+  finish(errors_g != 0);
+  return;
+
+failed:
+  nosPrint("Failed to set up the stress test, "
+           "check the pico]OS configuration!\n");
+  finish(1);
+}
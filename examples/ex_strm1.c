@@ -0,0 +1,140 @@
+/*
+ *  pico]OS stream buffer example 1
+ *
+ *  How to pass variable-length packets between tasks without copying.
+ *
+ *  A producer task builds packets of different lengths directly in a
+ *  stream buffer: it reserves space for the largest possible packet,
+ *  writes a small header and the payload in place and commits only
+ *  the bytes it has really used. A consumer task peeks at the oldest
+ *  packet, checks it in place and frees it. No message buffers and
+ *  no heap blocks are allocated per packet.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+
+/* Include source code for pico]OS
+ * initialization with nano layer.
+ */
+#include "ex_init4.c"
+
+
+/* we need some features to be enabled */
+#if NOSCFG_FEATURE_STREAMBUF == 0
+#error The feature NOSCFG_FEATURE_STREAMBUF is not enabled!
+#endif
+#if NOSCFG_FEATURE_PRINTF == 0
+#error The feature NOSCFG_FEATURE_PRINTF is not enabled!
+#endif
+#if POSCFG_FEATURE_SLEEP == 0
+#error The feature POSCFG_FEATURE_SLEEP is not enabled!
+#endif
+
+
+/* size of the stream buffer in bytes */
+#define STREAMSIZE   256
+
+/* largest payload of a packet */
+#define MAXPAYLOAD   40
+
+/* Size of a packet in the stream buffer. The size is rounded up,
+ * so every packet header starts at an aligned address.
+ */
+#define PACKETSIZE(len) \
+  ((sizeof(PACKETHDR_t) + (len) + sizeof(UINT_t) - 1) & \
+   ~(UINT_t)(sizeof(UINT_t) - 1))
+
+
+/* packet header, it is followed by the payload */
+typedef struct {
+  UINT_t  number;
+  UINT_t  length;
+} PACKETHDR_t;
+
+
+/* function prototypes */
+void firsttask(void *arg);
+void consumertask(void *arg);
+
+
+/* global variables */
+static NOSSTREAM_t  stream_g;
+
+
+
+/* This task reads the packets from the stream buffer.
+ * The packets are processed in place and freed afterwards.
+ */
+void consumertask(void *arg)
+{
+  PACKETHDR_t    *hdr;
+  unsigned char  *payload;
+  UINT_t         size, sum, i;
+
+  (void) arg;
+
+  for(;;)
+  {
+    if (nosStreamPeek(stream_g, (void**) &hdr, &size, INFINITE) != 0)
+      continue;
+
+    /* a packet was committed in one piece, so it is peeked in one piece */
+    payload = (unsigned char*) (hdr + 1);
+    for (sum = 0, i = 0; i < hdr->length; i++)
+    {
+      sum += payload[i];
+    }
+    nosPrintf3("packet %u: %u bytes, checksum %u\n",
+               hdr->number, hdr->length, sum);
+
+    nosStreamConsume(stream_g, PACKETSIZE(hdr->length));
+  }
+}
+
+
+
+/* This function is executed by the first task that is started
+ * by pico]OS ( see the nosInit()-call in main(), file ex_init4.c ).
+ * It produces the packets.
+ */
+void firsttask(void *arg)
+{
+  PACKETHDR_t    *hdr;
+  unsigned char  *payload;
+  UINT_t         number, i;
+
+  (void) arg;
+
+  stream_g = nosStreamCreate(STREAMSIZE);
+  if ((stream_g == NULL) ||
+      (nosTaskCreate(consumertask, NULL, 2, 0, "consumer") == NULL))
+  {
+    nosPrint("Failed to set up the stream buffer!\n");
+    return;
+  }
+
+  for (number = 1; ; number++)
+  {
+    /* reserve space for the largest packet, wait until it is free */
+    if (nosStreamReserve(stream_g, PACKETSIZE(MAXPAYLOAD),
+                         (void**) &hdr, INFINITE) != 0)
+      continue;
+
+    /* build the packet in place */
+    hdr->number = number;
+    hdr->length = (number * 7) % (MAXPAYLOAD + 1);
+    payload = (unsigned char*) (hdr + 1);
+    for (i = 0; i < hdr->length; i++)
+    {
+      payload[i] = (unsigned char) (number + i);
+    }
+
+    /* publish only the bytes that are really used */
+    nosStreamCommit(stream_g, PACKETSIZE(hdr->length));
+
+    if ((number % 4) == 0)
+      posTaskSleep(MS(500));
+  }
+}
@@ -0,0 +1,125 @@
+/*
+ *  pico]OS task example 5
+ *
+ *  How to use the earliest-deadline-first scheduling class.
+ *
+ *  Three periodic tasks are created at the priority level POSCFG_EDF_PRIO.
+ *  Each task gets a period and a relative deadline, does some work that
+ *  takes a few timer ticks, and then waits for its next period. The
+ *  scheduler always runs the task with the earliest deadline first,
+ *  so all deadlines are met although the tasks have the same priority.
+ *  The first task prints the deadline-miss counters once per second.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+
+/* Include source code for pico]OS
+ * initialization with nano layer.
+ */
+#include "ex_init4.c"
+
+
+/* we need some features to be enabled */
+#if POSCFG_FEATURE_EDF == 0
+#error The feature POSCFG_FEATURE_EDF is not enabled!
+#endif
+#if NOSCFG_FEATURE_PRINTF == 0
+#error The feature NOSCFG_FEATURE_PRINTF is not enabled!
+#endif
+
+
+/* count of periodic tasks */
+#define TASKS  3
+
+
+/* period, relative deadline and work time (all in timer ticks) */
+typedef struct {
+  UINT_t  period;
+  UINT_t  deadline;
+  UINT_t  work;
+} PERIODIC_t;
+
+static const PERIODIC_t periodic_g[TASKS] = {
+  { 10,  4, 2 },
+  { 15, 15, 4 },
+  { 30, 20, 6 }
+};
+
+
+/* function prototypes */
+void firsttask(void *arg);
+void periodictask(void *arg);
+
+
+
+/* This function is executed by the periodic tasks.
+ * The task sets its period and deadline, and then executes
+ * its work once in each period.
+ */
+void periodictask(void *arg)
+{
+  const PERIODIC_t *p = (const PERIODIC_t*) arg;
+  JIF_t  start;
+  UINT_t done;
+
+  posTaskSetDeadline(posTaskGetCurrent(), p->period, p->deadline);
+
+  for(;;)
+  {
+    /* Simulate some work. The time is counted only while the
+       task is running, so the task may be preempted meanwhile. */
+    done  = 0;
+    start = jiffies;
+    while (done < p->work)
+    {
+      if (jiffies != start)
+      {
+        start = jiffies;
+        done++;
+      }
+    }
+
+    /* wait for the next period */
+    if (posTaskWaitPeriod() > 0)
+    {
+      nosPrintf1("task %u has missed its deadline\n",
+                 (UINT_t)(p - periodic_g) + 1);
+    }
+  }
+}
+
+
+
+/* This function is executed by the first task that is started
+ * by pico]OS ( see the nosInit()-call in main(), file ex_init4.c ).
+ */
+void firsttask(void *arg)
+{
+  POSTASK_t  task[TASKS];
+  UVAR_t     i;
+
+  (void) arg;
+
+  for (i = 0; i < TASKS; i++)
+  {
+    task[i] = nosTaskCreate(periodictask, (void*) &periodic_g[i],
+                            POSCFG_EDF_PRIO, 0, NULL);
+    if (task[i] == NULL)
+    {
+      nosPrint("Failed to create a periodic task!\n");
+      return;
+    }
+  }
+
+  for(;;)
+  {
+    posTaskSleep(HZ);
+    for (i = 0; i < TASKS; i++)
+    {
+      nosPrintf2("task %u: %u missed deadlines\n",
+                 i + 1, posTaskGetDeadlineMisses(task[i]));
+    }
+  }
+}
@@ -0,0 +1,114 @@
+/*
+ *  pico]OS task example 6
+ *
+ *  Benchmark of the context switch.
+ *
+ *  Two tasks pass the control to each other by use of two semaphores.
+ *  The example counts the context switches that are done in a fixed
+ *  count of timer ticks and prints the result in switches per second.
+ *  Build the example with different configurations (for example with
+ *  and without POSCFG_FEATURE_STACKCHECK) to measure the costs of
+ *  optional kernel features.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+
+/* Include source code for pico]OS
+ * initialization with nano layer.
+ */
+#include "ex_init4.c"
+
+
+/* we need some features to be enabled */
+#if POSCFG_FEATURE_JIFFIES == 0
+#error The feature POSCFG_FEATURE_JIFFIES is not enabled!
+#endif
+#if NOSCFG_FEATURE_PRINTF == 0
+#error The feature NOSCFG_FEATURE_PRINTF is not enabled!
+#endif
+
+
+/* count of timer ticks every single measurement runs */
+#define BENCH_TICKS   (HZ + 1)
+
+/* count of measurements */
+#define BENCH_RUNS    5
+
+
+/* function prototypes */
+void firsttask(void *arg);
+void pongtask(void *arg);
+
+
+/* global variables */
+static POSSEMA_t  pingsem_g;
+static POSSEMA_t  pongsem_g;
+
+
+
+/* This task has a higher priority than the first task.
+ * It waits for the ping and answers with a pong.
+ * Every round trip causes two context switches.
+ */
+void pongtask(void *arg)
+{
+  (void) arg;
+
+  for(;;)
+  {
+    posSemaGet(pingsem_g);
+    posSemaSignal(pongsem_g);
+  }
+}
+
+
+
+/* This function is executed by the first task that is started
+ * by pico]OS ( see the nosInit()-call in main(), file ex_init4.c ).
+ */
+void firsttask(void *arg)
+{
+  unsigned long rounds;
+  JIF_t   start;
+  UVAR_t  i;
+
+  (void) arg;
+
+  pingsem_g = posSemaCreate(0);
+  pongsem_g = posSemaCreate(0);
+  if ((pingsem_g == NULL) || (pongsem_g == NULL) ||
+      (nosTaskCreate(pongtask, NULL, 2, 0, "pong") == NULL))
+  {
+    nosPrint("Failed to set up the benchmark!\n");
+    return;
+  }
+
+#if POSCFG_FEATURE_STACKCHECK != 0
+  nosPrint("Context switch benchmark (stack check enabled)\n");
+#else
+  nosPrint("Context switch benchmark (stack check disabled)\n");
+#endif
+
+  for (i = 0; i < BENCH_RUNS; i++)
+  {
+    /* synchronize to the timer tick */
+    start = jiffies;
+    while (start == jiffies);
+    start = jiffies;
+
+    rounds = 0;
+    while ((JIF_t)(jiffies - start) < BENCH_TICKS)
+    {
+      posSemaSignal(pingsem_g);
+      posSemaGet(pongsem_g);
+      rounds++;
+    }
+
+    nosPrintf1("%u context switches per second\n",
+               (UINT_t) ((2 * rounds * HZ) / BENCH_TICKS));
+  }
+
+  nosPrint("Benchmark finished.\n");
+}
@@ -0,0 +1,109 @@
+/*
+ *  pico]OS timer example 3
+ *
+ *  How to use timers with callback functions.
+ *
+ *  Several periodic jobs are executed without creating a task for
+ *  each job. One timer calls its function directly in the timer
+ *  interrupt and only counts the ticks. The other timers call their
+ *  functions in the timer service task, so all jobs share one stack.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+
+/* Include source code for pico]OS
+ * initialization with nano layer.
+ */
+#include "ex_init4.c"
+
+
+/* we need some features to be enabled */
+#if POSCFG_FEATURE_TIMERCALLBACK == 0
+#error The feature POSCFG_FEATURE_TIMERCALLBACK is not enabled!
+#endif
+#if NOSCFG_FEATURE_PRINTF == 0
+#error The feature NOSCFG_FEATURE_PRINTF is not enabled!
+#endif
+
+
+/* count of periodic jobs executed by the timer service task */
+#define JOBS  3
+
+/* periods of the jobs in milliseconds */
+static const UINT_t period_g[JOBS] = { 500, 1000, 3000 };
+
+
+/* function prototypes */
+void firsttask(void *arg);
+void tickjob(POSTIMER_t tmr, void *arg);
+void periodicjob(POSTIMER_t tmr, void *arg);
+
+
+/* global variable: counted by the timer interrupt */
+static volatile UINT_t ticks_g;
+
+
+
+/* This function is called in the timer interrupt.
+ * It must be short and must not block.
+ */
+void tickjob(POSTIMER_t tmr, void *arg)
+{
+  (void) tmr;
+  (void) arg;
+  ticks_g++;
+}
+
+
+
+/* This function is called by the timer service task.
+ * It is allowed to print text here.
+ */
+void periodicjob(POSTIMER_t tmr, void *arg)
+{
+  UINT_t job = (UINT_t) ((const UINT_t*) arg - period_g);
+
+  (void) tmr;
+  nosPrintf2("job %u: %u ticks counted\n", job + 1, ticks_g);
+}
+
+
+
+/* This function is executed by the first task that is started
+ * by pico]OS ( see the nosInit()-call in main(), file ex_init4.c ).
+ */
+void firsttask(void *arg)
+{
+  POSTIMER_t  tmr;
+  UVAR_t      i;
+
+  (void) arg;
+
+  /* timer that counts the ticks in interrupt context */
+  tmr = posTimerCreate();
+  if ((tmr == NULL) ||
+      (posTimerSetCallback(tmr, tickjob, NULL, POSTIMER_TICKCTX,
+                           1, 1) != E_OK))
+  {
+    nosPrint("Failed to set up the tick timer!\n");
+    return;
+  }
+  posTimerStart(tmr);
+
+  /* periodic jobs, executed by the timer service task */
+  for (i = 0; i < JOBS; i++)
+  {
+    tmr = posTimerCreate();
+    if ((tmr == NULL) ||
+        (posTimerSetCallback(tmr, periodicjob, (void*) &period_g[i],
+                             POSTIMER_TASKCTX, MS(period_g[i]),
+                             MS(period_g[i])) != E_OK))
+    {
+      nosPrint("Failed to set up a timer!\n");
+      return;
+    }
+    posTimerStart(tmr);
+  }
+}
@@ -143,6 +143,77 @@ extern void *__heap_end;
  */
 #define NOSCFG_MEM_MANAGE_MODE       0
 
+/** Enable heap statistics.
+ * If this definition is set to 1, the nano layer counts allocations,
+ * failed allocations and the heap usage, and the function ::nosMemStats
+ * is added to the user API. If the user registry is enabled, the
+ * statistics can also be found in the registry under the key
+ * ::NOS_MEMSTATS_REGKEY.
+ */
+#define NOSCFG_FEATURE_MEMSTATS      1
+
+/** Enable per-task memory caches.
+ * If this definition is set to 1, every task that was created with
+ * ::nosTaskCreate gets a private cache of small memory blocks.
+ * ::nosMemAlloc and ::nosMemFree take blocks from and return blocks to
+ * this cache without locking the task scheduler. The cache is refilled
+ * from the heap and flushed back to the heap in batches of
+ * ::NOSCFG_MEMCACHE_BATCH blocks. This reduces the allocation time and
+ * the time the scheduler is locked, but needs some more heap memory.
+ * When a task terminates, its cache is freed to the heap.
+ */
+#define NOSCFG_FEATURE_MEMCACHE      0
+
+/** Count of size classes in the per-task memory caches.
+ * The block size of the first class is ::NOSCFG_MEMCACHE_MINSIZE,
+ * the size doubles with every further class. Larger allocations
+ * are served directly from the heap.
+ */
+#define NOSCFG_MEMCACHE_CLASSES      4
+
+/** Block size in bytes of the smallest size class in the memory caches.
+ * @sa NOSCFG_MEMCACHE_CLASSES
+ */
+#define NOSCFG_MEMCACHE_MINSIZE      16
+
+/** Count of memory blocks that are moved at once between a task cache
+ * and the heap. The scheduler is locked while the blocks are moved.
+ */
+#define NOSCFG_MEMCACHE_BATCH        4
+
+/** Maximum count of free blocks per size class in a task cache.
+ * When this count is exceeded, ::NOSCFG_MEMCACHE_BATCH blocks are
+ * given back to the heap.
+ */
+#define NOSCFG_MEMCACHE_MAXBLOCKS    16
+
+/** Enable the stack cache.
+ * If this definition is set to 1, the stack memory of terminated tasks
+ * is kept in a cache and is reused for new tasks. This makes the
+ * creation of short-living tasks faster. Stacks are allocated in size
+ * classes of ::NOSCFG_STKCACHE_GRANULE bytes. The stack cache is used
+ * by ::nosTaskCreate when ::POSCFG_TASKSTACKTYPE is set to 0. With
+ * ::POSCFG_TASKSTACKTYPE = 1 the port must allocate the stack memory
+ * with the macro NOS_STACK_ALLOC to make use of the cache.
+ */
+#define NOSCFG_FEATURE_STACKCACHE    0
+
+/** Size class granularity of the stack cache in bytes.
+ * Stack sizes are rounded up to a multiple of this value.
+ */
+#define NOSCFG_STKCACHE_GRANULE      128
+
+/** Count of size classes in the stack cache. Stacks that are larger
+ * than ::NOSCFG_STKCACHE_GRANULE * ::NOSCFG_STKCACHE_CLASSES bytes
+ * are not cached.
+ */
+#define NOSCFG_STKCACHE_CLASSES      8
+
+/** Maximum count of stacks that are held in the stack cache.
+ * @sa nosStackCacheFlush
+ */
+#define NOSCFG_STKCACHE_MAXSTACKS    4
+
 /** Include function ::nosMemSet.
  * If this definition is set to 1, the function ::nosMemSet will
  * be included into the nano layer.
@@ -155,6 +226,33 @@ extern void *__heap_end;
  */
 #define NOSCFG_FEATURE_MEMCOPY       1
 
+/** Include function ::nosMemMove.
+ * If this definition is set to 1, the function ::nosMemMove will
+ * be included into the nano layer.
+ */
+#define NOSCFG_FEATURE_MEMMOVE       1
+
+/** Include function ::nosMemCmp.
+ * If this definition is set to 1, the function ::nosMemCmp will
+ * be included into the nano layer.
+ */
+#define NOSCFG_FEATURE_MEMCMP        1
+
+#if DOX!=0
+/** Byte order of the memory. The fast memory copy and compare functions
+ * need to know the byte order of the machine to be able to copy words
+ * between buffers that are not aligned to each other: @n
+ *   0 = unknown byte order, misaligned buffers are copied bytewise @n
+ *   1 = little endian (least significant byte at lowest address) @n
+ *   2 = big endian (most significant byte at lowest address) @n
+ * This define is optional. If it is not set, the byte order is taken
+ * from the compiler when possible.
+ * @note The fast memory functions are only compiled in when
+ *       ::POSCFG_FASTCODE is set to 1 and ::POSCFG_SMALLCODE is set to 0.
+ */
+#define NOSCFG_MEM_BYTEORDER         0
+#endif
+
 /** Include function ::nosMemRealloc.
  * If this definition is set to 1, the function ::nosMemRealloc will
  * be included into the nano layer.
@@ -315,6 +413,75 @@ extern void *__heap_end;
 
 
 
+/*---------------------------------------------------------------------------
+ *  TASK POOLS
+ *-------------------------------------------------------------------------*/
+
+/** @defgroup cfgnospool Task Pools
+ * @ingroup confign
+ * @{
+ */
+
+/** Enable task pool support.
+ * If this definition is set to 1, the task pool functions
+ * (::nosPoolCreate, ::nosPoolSubmit, ::nosJobWait, ...) are
+ * added to the user API.
+ */
+#define NOSCFG_FEATURE_TASKPOOL      1
+
+/** @} */
+
+
+
+/*---------------------------------------------------------------------------
+ *  STREAM BUFFERS
+ *-------------------------------------------------------------------------*/
+
+/** @defgroup cfgnosstream Stream Buffers
+ * @ingroup confign
+ * @{
+ */
+
+/** Enable stream buffer support.
+ * If this definition is set to 1, the stream buffer functions
+ * (::nosStreamCreate, ::nosStreamReserve, ::nosStreamCommit,
+ * ::nosStreamPeek, ::nosStreamConsume, ...) are added to the user API.
+ */
+#define NOSCFG_FEATURE_STREAMBUF     1
+
+/** @} */
+
+
+
+/*---------------------------------------------------------------------------
+ *  STATISTICS PAGE
+ *-------------------------------------------------------------------------*/
+
+/** @defgroup cfgnosstatpage Statistics Page
+ * @ingroup confign
+ * @{
+ */
+
+/** Enable the statistics page.
+ * If this definition is set to 1, the function ::nosStatPageStart is
+ * added to the user API. It starts a task that periodically mirrors
+ * the kernel statistics into a memory page that can be read by another
+ * process. ::NOSCFG_FEATURE_REGQUERY must be enabled.
+ */
+#define NOSCFG_FEATURE_STATPAGE      0
+
+/** Name of the POSIX shared memory object for the statistics page.
+ * When this define is set and ::nosStatPageStart is called without
+ * a page, the port creates the page as a shared memory object with this
+ * name (macro NOS_STATPAGE_MAP in port.h). The Unix port supports this.
+ * The viewer ports/unix/tools/statview.c displays the page.
+ */
+/* #define NOSCFG_STATPAGE_SHMNAME   "/picoos-stats" */
+
+/** @} */
+
+
+
 /*---------------------------------------------------------------------------
  *  CPU USAGE
  *-------------------------------------------------------------------------*/
@@ -69,6 +69,7 @@
  * the operating system can manage. For example:
  * @e char = 8 bit, 8 * 8 = 64 tasks;
  * @e long = 32 bit, 32 * 32 = 1024 tasks.
+ * On 64 bit hosts, @e long @e long (64 bit) allows 64 * 64 = 4096 tasks.
  */
 #define MVAR_t                   char
 
@@ -78,6 +79,7 @@
  * Some compilers support the sizeof(MVAR_t)-macro at this
  * position, but some others don't. For example, set
  * this define to 8 (bits) if ::MVAR_t is defined to @e char.
+ * Possible values are 8, 16, 32 and 64.
  */
 #define MVAR_BITS                8  /* = (sizeof(MVAR_t) * 8) */
 
@@ -136,6 +138,14 @@
  */
 #define POSCFG_TASKSTACKTYPE     0
 
+/** Stack overflow detection support.
+ * Set this define to 1 when ::p_pos_initTask places the stack guard
+ * words with ::c_pos_setStackGuard. The kernel can only be built
+ * with ::POSCFG_FEATURE_STACKCHECK enabled when the port sets this
+ * define to 1.
+ */
+#define POSCFG_PORT_STACKGUARD   0
+
 /** Enable call to function ::p_pos_initArch.
  * When this define is set to 1, the operating system will call
  * the user supplied function ::p_pos_initArch to initialize
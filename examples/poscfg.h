@@ -57,8 +57,12 @@
 
 /** Maximum count of priority levels.
  * This define limits the maximum count of available priority levels.
- * For the round robin scheduler, the maximum count is equal to ::MVAR_BITS.
- * For the standard scheduler, the maximum count cannot exceed ::MVAR_BITS ^ 2.
+ * For the round robin scheduler, the maximum count is ::MVAR_BITS ^ 2.
+ * For the standard scheduler, the maximum count cannot exceed ::MVAR_BITS ^ 3.
+ * Up to ::MVAR_BITS priority levels (round robin) or ::MVAR_BITS ^ 2
+ * levels (standard scheduler) the ready tasks are kept in a two level
+ * bitmap. Beyond that, a three level bitmap is used, so selecting the
+ * next task still takes constant time (one more findbit operation).
  */
 #define POSCFG_MAX_PRIO_LEVEL    8
 
@@ -88,6 +92,20 @@
  */
 #define POSCFG_MAX_TASKS        16
 
+/** Number of processor cores.
+ * Set this define to a value greater than 1 to enable the SMP mode.
+ * In SMP mode each core has its own table of ready tasks and its own
+ * idle task, tasks are distributed over the cores when they become ready
+ * and are pulled by idle or less loaded cores in the timer interrupt.
+ * The port must provide a spinlock in ::POS_SCHED_LOCK, the core
+ * number (::POS_CPUID) and the function ::p_pos_ipiReschedule.
+ * Each additional core must call ::c_pos_coreStart.
+ * Note: ::POSCFG_ROUNDROBIN must be set to 1, ::POSCFG_TASKS_PER_PRIO
+ * must be at least the count of cores and ::POSCFG_MAX_TASKS must
+ * include one idle task per core.
+ */
+#define POSCFG_SMP_CORES        1
+
 /** Maximum count of events.
  * This define sets the maximum count of event data structures which can be
  * allocated. Semaphores, Mutexes, Flags and Message Boxes are using this
@@ -179,6 +197,25 @@
  */
 #define POSCFG_CTXSW_COMBINE    10
 
+/** Adaptive context switch combining.
+ * If this definition is set to 1, the combine threshold is tuned at
+ * runtime. Under light load events switch at once, under heavy load up
+ * to ::POSCFG_CTXSW_COMBINE events are combined. The threshold follows
+ * the count of events per timer tick. The function ::posCtxSwitchStats
+ * shows how many context switches were saved. This define requires
+ * ::POSCFG_SOFT_MTASK = 1 and ::POSCFG_CTXSW_COMBINE > 1.
+ */
+#define POSCFG_CTXSW_ADAPTIVE    0
+
+/** Latency limit of the adaptive context switch combining.
+ * When ::POSCFG_FEATURE_HRTIME is enabled, the time from a deferred
+ * wakeup until the scheduler runs is measured with the cycle counter.
+ * While this time is longer than the limit, the combine threshold is
+ * not raised. The limit is given in microseconds; the default is
+ * half a timer tick.
+ */
+#define POSCFG_CTXSW_LATENCY     (500000UL / HZ)
+
 /** Realtime priority threshold for soft multitasking.
  * With this define some priority levels can be defined to be hard realtime,
  * even if soft multitasking is enabled. All priority levels equal to or
@@ -189,6 +226,17 @@
  */
 #define POSCFG_REALTIME_PRIO     0
 
+/** Priority level of the earliest-deadline-first scheduling class.
+ * Tasks running at this priority level can be given a period and a
+ * relative deadline with the function ::posTaskSetDeadline. Within this
+ * level, the task with the earliest deadline is scheduled first, instead
+ * of scheduling the tasks round robin. Tasks at higher priority levels
+ * still preempt the EDF tasks, so the EDF class can be placed as a band
+ * between fixed priority levels. The default is the highest priority.
+ * Note that this define takes only effect when ::POSCFG_FEATURE_EDF = 1.
+ */
+#define POSCFG_EDF_PRIO          (POSCFG_MAX_PRIO_LEVEL - 1)
+
 /** When this define is set to a non-zero value, some user
  * available space is inserted into each task control block. The user
  * can call the function ::posTaskGetUserspace to get a pointer to the
@@ -277,6 +325,27 @@
  */
 #define POSCFG_SMALLCODE         1
 
+/** Use compiler intrinsics to find the next task to schedule.
+ * If this define is set to 1, the bit scan that selects the next task
+ * is done with the __builtin_ctz functions of GCC compatible compilers,
+ * which usually compile to a single instruction. The generic findbit
+ * function in the file fbit_gen.c is then not used.
+ */
+#define POSCFG_FBIT_BUILTIN      0
+
+/** Link objects by table index instead of by pointer.
+ * If this define is set to 1, tasks, events, timers and message buffers
+ * are linked to each other by their 8- or 16-bit index in the object
+ * tables instead of by a full pointer. With the example configuration
+ * on a 32-bit CPU a task shrinks from 60 to 44 bytes and a timer from
+ * 28 to 20 bytes (64-bit CPU: task 96 to 56, timer 40 to 20 bytes).
+ * Events and message buffers hold only one link, the bytes saved there
+ * are usually lost to the alignment. Every link access costs a few
+ * instructions. This option requires that ::POSCFG_DYNAMIC_MEMORY is
+ * set to 0 or ::POSCFG_DYNAMIC_REFILL is set to 0.
+ */
+#define POSCFG_COMPACT_OBJECTS   0
+
 /** Function argument checking.
  * There are three methods of argument checking:<br>
  *
@@ -326,6 +395,24 @@
  */
 #define POSCFG_FEATURE_SLEEP         1
 
+/** Include functions with absolute timeouts.
+ * If this definition is set to 1, the functions ::posTaskSleepUntil and
+ * ::posTaskSleepPeriodic are added to the user API, and also the
+ * functions ::posSemaWaitUntil, ::posMessageWaitUntil and
+ * ::posFlagWaitUntil when the relative wait functions are enabled.
+ * ::POSCFG_FEATURE_SLEEP and ::POSCFG_FEATURE_JIFFIES must be set to 1.
+ */
+#define POSCFG_FEATURE_SLEEPUNTIL    0
+
+/** Enable earliest-deadline-first scheduling.
+ * If this definition is set to 1, the functions ::posTaskSetDeadline,
+ * ::posTaskWaitPeriod and ::posTaskGetDeadlineMisses are added to the
+ * user API. Tasks running at the priority level ::POSCFG_EDF_PRIO
+ * are then scheduled by their deadlines. This feature requires
+ * ::POSCFG_ROUNDROBIN and ::POSCFG_FEATURE_JIFFIES to be set to 1.
+ */
+#define POSCFG_FEATURE_EDF           0
+
 /** Include function ::posTaskExit.
  * If this definition is set to 1, the function ::posTaskExit will
  * be included into the pico]OS kernel.
@@ -409,6 +496,22 @@
  */
 #define POSCFG_FEATURE_MSGWAIT       1
 
+/** Include function ::posMessageSendUrgent.
+ * If this definition is set to 1, the function ::posMessageSendUrgent
+ * will be included into the pico]OS kernel. Urgent messages are
+ * received before all normal messages that are waiting in the
+ * message box. Note that also ::POSCFG_FEATURE_MSGBOXES must be set to 1.
+ */
+#define POSCFG_FEATURE_MSGURGENT     0
+
+/** Include function ::posMessageWaitMatch.
+ * If this definition is set to 1, the function ::posMessageWaitMatch
+ * will be included into the pico]OS kernel. The function takes the
+ * first message from the message box that is accepted by a filter
+ * function. Note that also ::POSCFG_FEATURE_MSGWAIT must be set to 1.
+ */
+#define POSCFG_FEATURE_MSGMATCH      0
+
 /** Include functions ::posTaskSchedLock and ::posTaskSchedUnlock.
  * If this definition is set to 1, the functions ::posTaskSchedLock
  * and ::posTaskSchedUnlock will be included into the pico]OS kernel.
@@ -421,6 +524,26 @@
  */
 #define POSCFG_FEATURE_JIFFIES       1
 
+/** Include the high resolution time functions.
+ * If this definition is set to 1, the functions ::posGetTimeNs and
+ * ::posGetCycles are added to the user API. The port must provide
+ * a free running cycle counter (::POS_CYCLES, ::POS_CYCLES_HZ).
+ */
+#define POSCFG_FEATURE_HRTIME        0
+
+/** Run the system in virtual time.
+ * If this definition is set to 1, the timer interrupt is not driven by
+ * a hardware timer but by the idle task. When all tasks are blocked,
+ * the time jumps directly to the next task timeout or timer expiry,
+ * so a long period of device time is simulated in a short time. The
+ * time does not advance while tasks are running, and the results are
+ * the same in every run. The port must not start its timer interrupt.
+ * This feature is not available in SMP mode. The idle task hook
+ * (HOOK_IDLETASK) is only executed when no task waits for a timeout,
+ * so the hook of the port may wait for the next interrupt.
+ */
+#define POSCFG_FEATURE_VIRTUALTIME   0
+
 /** Include timer functions.
  * If this definition is set to 1, the timer functions are
  * added to the user API.
@@ -441,6 +564,18 @@
  */
 #define POSCFG_FEATURE_TIMERFIRED    1
 
+/** Include function ::posTimerSetCallback.
+ * If this definition is set to 1, timers can call a function when they
+ * fire, either directly in the timer interrupt or in the timer service
+ * task. Note that also ::POSCFG_FEATURE_TIMER must be set to 1.
+ * The timer service task needs one task structure and one semaphore
+ * (count it in ::POSCFG_MAX_TASKS and ::POSCFG_MAX_EVENTS). It runs at
+ * priority ::POSCFG_TIMERTASK_PRIO (default is the highest priority)
+ * and gets a stack of ::POSCFG_TIMERTASK_STACKSIZE bytes; if this is
+ * zero, it gets the same stack size as the first task.
+ */
+#define POSCFG_FEATURE_TIMERCALLBACK 0
+
 /** Include flags functions.
  * If this definition is set to 1, the flags functions are
  * added to the user API.
@@ -486,6 +621,15 @@
  */
 #define POSCFG_FEATURE_ATOMICVAR     1
 
+/** Select the implementation of the atomic variable functions.
+ * 0 = the functions lock the scheduler (disable interrupts),
+ * 1 = the functions use the __atomic builtins of GCC compatible compilers,
+ * 2 = the port provides compare-and-swap functions (e.g. implemented
+ *     with LDREX / STREX), see ::p_pos_atomicCAS and ::p_pos_atomicPtrCAS.
+ * With 1 and 2 the atomic functions do not touch the interrupt mask.
+ */
+#define POSCFG_ATOMIC_BUILTIN        0
+
 /** Provide a task global error state variable.
  * If this definition is set to 1, the ::errno variable is supported.
  */
@@ -511,6 +655,14 @@
  */
 #define POSCFG_FEATURE_LISTLEN       1
 
+/** Include functions ::posListGetN and ::posListGetAll.
+ * If this definition is set to 1, the function ::posListGetN and the
+ * macro ::posListGetAll will be included into the pico]OS kernel.
+ * They take several list elements in one operation. Note that also
+ * ::POSCFG_FEATURE_LISTS must be set to 1.
+ */
+#define POSCFG_FEATURE_LISTGETN      0
+
 /** Enable the debug help.
  * If this definition is set to 1, pico]OS exports the global
  * variables ::picodeb_tasklist and ::picodeb_eventlist that
@@ -519,6 +671,68 @@
  */
 #define POSCFG_FEATURE_DEBUGHELP     0
 
+/** Enable the stack overflow detection.
+ * If this definition is set to 1, guard words are placed at the end
+ * of each task stack. They are tested at every context switch and by
+ * the idle task. When a guard word was overwritten, the macro
+ * HOOK_STACKOVERFLOW(task) is executed, which calls ::p_pos_assert
+ * by default. Note that the platform port must support this feature
+ * by calling ::c_pos_setStackGuard in ::p_pos_initTask and by setting
+ * ::POSCFG_PORT_STACKGUARD to 1, otherwise the build fails.
+ */
+#define POSCFG_FEATURE_STACKCHECK    0
+
+/** Size of the stack guard in words of type UVAR_t.
+ * This define has only an effect when ::POSCFG_FEATURE_STACKCHECK is 1.
+ */
+#define POSCFG_STACKGUARD_WORDS      2
+
+/** Enable the kernel statistics.
+ * If this definition is set to 1, pico]OS counts context switches,
+ * wakeups, timeouts and the message box depth per task, signals,
+ * blocking waits and timeouts per event object, and failed object
+ * allocations. The counters are read with the functions
+ * ::posTaskGetStats, ::posEventGetStats and ::posSystemGetStats,
+ * or with ::nosRegQueryStats while querying the nano layer registry.
+ * When ::POSCFG_FEATURE_HRTIME is also enabled, the cycles every task
+ * has run are summed up at each context switch.
+ */
+#define POSCFG_FEATURE_STATISTICS    0
+
+/** Enable the mutex contention profiling.
+ * If this definition is set to 1, every mutex keeps a record of how
+ * often it was locked and how often a task had to wait for it, the
+ * total and longest wait and hold times, and the task that held it for
+ * the longest time. The record is read with ::posMutexGetProf, and
+ * ::nosMutexProfDump prints the records of all named mutexes sorted by
+ * the total wait time. ::POSCFG_FEATURE_HRTIME must be set to 1.
+ */
+#define POSCFG_FEATURE_MUTEXPROF     0
+
+/** Enable the lock profiler.
+ * If this definition is set to 1, the hold time of every critical
+ * section is measured with the cycle counter. The statistics
+ * (count, longest time and a histogram) are kept per call site of
+ * ::POS_SCHED_LOCK, ::POS_IRQ_DISABLE_ALL and ::posTaskSchedLock, and
+ * can be read with the function ::posLockProfNext. This costs a static
+ * variable at every call site. ::POSCFG_FEATURE_HRTIME must be set to 1,
+ * and the port must define the lock macros with the suffix _RAW.
+ */
+#define POSCFG_FEATURE_LOCKPROF      0
+
+/** Count of buckets in the hold time histogram of the lock profiler.
+ * The first bucket counts the critical sections that are shorter than
+ * ::POSCFG_LOCKPROF_MINCYCLES cycles, each further bucket doubles the
+ * limit. This define has only an effect when ::POSCFG_FEATURE_LOCKPROF
+ * is set to 1.
+ */
+#define POSCFG_LOCKPROF_BUCKETS      10
+
+/** Upper limit of the first histogram bucket in cycles.
+ * See ::POSCFG_LOCKPROF_BUCKETS.
+ */
+#define POSCFG_LOCKPROF_MINCYCLES    64
+
 /** @} */
 
 
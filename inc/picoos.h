@@ -369,10 +369,10 @@
 #error  POSCFG_LOCK_FLAGSTYPE not defined
 #endif
 #endif
-#ifndef POS_SCHED_LOCK
+#if !defined(POS_SCHED_LOCK) && !defined(POS_SCHED_LOCK_RAW)
 #error  POS_SCHED_LOCK not defined
 #endif
-#ifndef POS_SCHED_UNLOCK
+#if !defined(POS_SCHED_UNLOCK) && !defined(POS_SCHED_UNLOCK_RAW)
 #error  POS_SCHED_UNLOCK not defined
 #endif
 #ifndef HZ
@@ -484,6 +484,9 @@
 #ifndef POSCFG_FEATURE_LISTLEN
 #define POSCFG_FEATURE_LISTLEN  1
 #endif
+#ifndef POSCFG_FEATURE_LISTGETN
+#define POSCFG_FEATURE_LISTGETN  0
+#endif
 #endif
 #ifndef POSCFG_FEATURE_DEBUGHELP
 #define POSCFG_FEATURE_DEBUGHELP  0
@@ -499,6 +502,75 @@
 #ifndef POSCFG_INT_EXIT_QUICK
 #define POSCFG_INT_EXIT_QUICK 0
 #endif
+#ifndef POSCFG_FEATURE_EDF
+#define POSCFG_FEATURE_EDF  0
+#endif
+#ifndef POSCFG_EDF_PRIO
+#define POSCFG_EDF_PRIO  (POSCFG_MAX_PRIO_LEVEL - 1)
+#endif
+#ifndef POSCFG_SMP_CORES
+#define POSCFG_SMP_CORES  1
+#endif
+#ifndef POSCFG_ATOMIC_BUILTIN
+#define POSCFG_ATOMIC_BUILTIN  0
+#endif
+#ifndef POSCFG_FEATURE_TIMERCALLBACK
+#define POSCFG_FEATURE_TIMERCALLBACK  0
+#endif
+#ifndef POSCFG_TIMERTASK_PRIO
+#define POSCFG_TIMERTASK_PRIO  (POSCFG_MAX_PRIO_LEVEL - 1)
+#endif
+#ifndef POSCFG_TIMERTASK_STACKSIZE
+#define POSCFG_TIMERTASK_STACKSIZE  0
+#endif
+#ifndef POSCFG_FEATURE_HRTIME
+#define POSCFG_FEATURE_HRTIME  0
+#endif
+#ifndef POSCFG_FEATURE_SLEEPUNTIL
+#define POSCFG_FEATURE_SLEEPUNTIL  0
+#endif
+#ifndef POSCFG_FEATURE_MSGURGENT
+#define POSCFG_FEATURE_MSGURGENT  0
+#endif
+#ifndef POSCFG_FEATURE_MSGMATCH
+#define POSCFG_FEATURE_MSGMATCH  0
+#endif
+#ifndef POSCFG_CTXSW_ADAPTIVE
+#define POSCFG_CTXSW_ADAPTIVE  0
+#endif
+#ifndef POSCFG_CTXSW_LATENCY
+#define POSCFG_CTXSW_LATENCY  (500000UL / HZ)
+#endif
+#ifndef POSCFG_FEATURE_STACKCHECK
+#define POSCFG_FEATURE_STACKCHECK  0
+#endif
+#ifndef POSCFG_STACKGUARD_WORDS
+#define POSCFG_STACKGUARD_WORDS  2
+#endif
+#ifndef POSCFG_PORT_STACKGUARD
+#define POSCFG_PORT_STACKGUARD  0
+#endif
+#ifndef POSCFG_FEATURE_VIRTUALTIME
+#define POSCFG_FEATURE_VIRTUALTIME  0
+#endif
+#ifndef POSCFG_COMPACT_OBJECTS
+#define POSCFG_COMPACT_OBJECTS  0
+#endif
+#ifndef POSCFG_FEATURE_STATISTICS
+#define POSCFG_FEATURE_STATISTICS  0
+#endif
+#ifndef POSCFG_FEATURE_MUTEXPROF
+#define POSCFG_FEATURE_MUTEXPROF  0
+#endif
+#ifndef POSCFG_FEATURE_LOCKPROF
+#define POSCFG_FEATURE_LOCKPROF  0
+#endif
+#ifndef POSCFG_LOCKPROF_BUCKETS
+#define POSCFG_LOCKPROF_BUCKETS  10
+#endif
+#ifndef POSCFG_LOCKPROF_MINCYCLES
+#define POSCFG_LOCKPROF_MINCYCLES  64
+#endif
 
 /* parameter range checking */
 #if (POSCFG_DYNAMIC_MEMORY != 0) && (POSCFG_DYNAMIC_REFILL != 0)
@@ -506,18 +578,23 @@
 #else
 #define SYS_POSTALLOCATE    0
 #endif
-#if (MVAR_BITS != 8) && (MVAR_BITS != 16) && (MVAR_BITS != 32)
-#error MVAR_BITS must be 8, 16 or 32
+#if (MVAR_BITS != 8) && (MVAR_BITS != 16) && (MVAR_BITS != 32) && \
+    (MVAR_BITS != 64)
+#error MVAR_BITS must be 8, 16, 32 or 64
 #endif
 #if POSCFG_MAX_PRIO_LEVEL == 0
 #error POSCFG_MAX_PRIO_LEVEL must not be zero
 #endif
-#if (POSCFG_ROUNDROBIN != 0) && (POSCFG_MAX_PRIO_LEVEL > MVAR_BITS)
-#error POSCFG_MAX_PRIO_LEVEL must not exceed MVAR_BITS
-#endif 
-#if (POSCFG_ROUNDROBIN == 0) && (POSCFG_MAX_PRIO_LEVEL > (MVAR_BITS*MVAR_BITS))
+#if (POSCFG_ROUNDROBIN != 0) && (POSCFG_MAX_PRIO_LEVEL > (MVAR_BITS*MVAR_BITS))
 #error POSCFG_MAX_PRIO_LEVEL must not exceed (MVAR_BITS * MVAR_BITS)
 #endif 
+#if (POSCFG_ROUNDROBIN == 0) && \
+    (POSCFG_MAX_PRIO_LEVEL > (MVAR_BITS*MVAR_BITS*MVAR_BITS))
+#error POSCFG_MAX_PRIO_LEVEL must not exceed (MVAR_BITS ^ 3)
+#endif 
+#if (MVAR_BITS == 8) && (POSCFG_MAX_PRIO_LEVEL > 128)
+#error POSCFG_MAX_PRIO_LEVEL must not exceed 128 (priorities are of type VAR_t)
+#endif
 #if (POSCFG_MAX_TASKS < 2) && (SYS_POSTALLOCATE == 0)
 #error POSCFG_MAX_TASKS is less than 2
 #endif
@@ -542,6 +619,46 @@
 #if (POSCFG_REALTIME_PRIO >= POSCFG_MAX_PRIO_LEVEL) && (POSCFG_ROUNDROBIN != 0)
 #error POSCFG_REALTIME_PRIO must be less than POSCFG_MAX_PRIO_LEVEL
 #endif
+#if POSCFG_FEATURE_EDF != 0
+#if POSCFG_ROUNDROBIN == 0
+#error POSCFG_FEATURE_EDF requires POSCFG_ROUNDROBIN to be enabled
+#endif
+#if POSCFG_FEATURE_JIFFIES == 0
+#error POSCFG_FEATURE_EDF requires POSCFG_FEATURE_JIFFIES to be enabled
+#endif
+#if POSCFG_EDF_PRIO >= POSCFG_MAX_PRIO_LEVEL
+#error POSCFG_EDF_PRIO must be less than POSCFG_MAX_PRIO_LEVEL
+#endif
+#endif
+#if POSCFG_SMP_CORES > 1
+#if POSCFG_SMP_CORES > MVAR_BITS
+#error POSCFG_SMP_CORES must not exceed MVAR_BITS
+#endif
+#if POSCFG_ROUNDROBIN == 0
+#error POSCFG_SMP_CORES > 1 requires POSCFG_ROUNDROBIN to be enabled
+#endif
+#if POSCFG_TASKS_PER_PRIO < POSCFG_SMP_CORES
+#error POSCFG_TASKS_PER_PRIO must be at least POSCFG_SMP_CORES
+#endif
+#if (POSCFG_MAX_TASKS <= POSCFG_SMP_CORES) && (SYS_POSTALLOCATE == 0)
+#error POSCFG_MAX_TASKS must be greater than POSCFG_SMP_CORES
+#endif
+#if POSCFG_ISR_INTERRUPTABLE == 0
+#error POSCFG_SMP_CORES > 1 requires POSCFG_ISR_INTERRUPTABLE to be set to 1
+#endif
+#if POSCFG_TASKSTACKTYPE == 0
+#error POSCFG_SMP_CORES > 1 requires POSCFG_TASKSTACKTYPE 1 or 2
+#endif
+#if POSCFG_INT_EXIT_QUICK != 0
+#error POSCFG_INT_EXIT_QUICK is not supported when POSCFG_SMP_CORES > 1
+#endif
+#endif
+#if POSCFG_ATOMIC_BUILTIN > 2
+#error POSCFG_ATOMIC_BUILTIN must be 0, 1 or 2
+#endif
+#if (POSCFG_ATOMIC_BUILTIN == 1) && !defined(__GNUC__)
+#error POSCFG_ATOMIC_BUILTIN = 1 requires a GCC compatible compiler
+#endif
 #if POSCFG_FEATURE_MSGBOXES != 0
 #if (POSCFG_MAX_MESSAGES < 2) && (SYS_POSTALLOCATE == 0)
 #error POSCFG_MAX_MESSAGES must be at least 2
@@ -555,6 +672,22 @@
 #error POSCFG_MAX_TIMER must be at least 1
 #endif
 #endif
+#if POSCFG_FEATURE_SLEEPUNTIL != 0
+#if (POSCFG_FEATURE_SLEEP == 0) || (POSCFG_FEATURE_JIFFIES == 0)
+#error POSCFG_FEATURE_SLEEPUNTIL requires POSCFG_FEATURE_SLEEP and POSCFG_FEATURE_JIFFIES
+#endif
+#endif
+#if (POSCFG_FEATURE_HRTIME != 0) && !defined(POS_CYCLES_HZ)
+#error POSCFG_FEATURE_HRTIME requires the port to define POS_CYCLES_HZ
+#endif
+#if POSCFG_FEATURE_TIMERCALLBACK != 0
+#if POSCFG_FEATURE_TIMER == 0
+#error POSCFG_FEATURE_TIMERCALLBACK requires POSCFG_FEATURE_TIMER to be enabled
+#endif
+#if POSCFG_TIMERTASK_PRIO >= POSCFG_MAX_PRIO_LEVEL
+#error POSCFG_TIMERTASK_PRIO must be less than POSCFG_MAX_PRIO_LEVEL
+#endif
+#endif
 #if (POSCFG_TASKSTACKTYPE < 0) || (POSCFG_TASKSTACKTYPE > 2)
 #error POSCFG_TASKSTACKTYPE must be 0, 1 or 2
 #endif
@@ -591,6 +724,8 @@
 #if POSCFG_FEATURE_MUTEXES == 0
 #undef POSCFG_FEATURE_MUTEXDESTROY
 #define POSCFG_FEATURE_MUTEXDESTROY  0
+#undef POSCFG_FEATURE_MUTEXPROF
+#define POSCFG_FEATURE_MUTEXPROF  0
 #else
 #if (POSCFG_FEATURE_MUTEXDESTROY != 0) && (POSCFG_FEATURE_SEMADESTROY == 0)
 #undef POSCFG_FEATURE_SEMADESTROY
@@ -602,6 +737,50 @@
 #else
 #define SYS_MSGBOXEVENTS  0
 #endif
+#if (POSCFG_FEATURE_MSGBOXES == 0) && \
+    ((POSCFG_FEATURE_MSGURGENT != 0) || (POSCFG_FEATURE_MSGMATCH != 0))
+#error POSCFG_FEATURE_MSGURGENT and POSCFG_FEATURE_MSGMATCH require POSCFG_FEATURE_MSGBOXES
+#endif
+#if (POSCFG_FEATURE_MSGMATCH != 0) && (POSCFG_FEATURE_MSGWAIT == 0)
+#error POSCFG_FEATURE_MSGMATCH requires POSCFG_FEATURE_MSGWAIT
+#endif
+#if (POSCFG_CTXSW_ADAPTIVE != 0) && \
+    ((POSCFG_SOFT_MTASK == 0) || (POSCFG_CTXSW_COMBINE < 2))
+#error POSCFG_CTXSW_ADAPTIVE requires POSCFG_SOFT_MTASK and POSCFG_CTXSW_COMBINE > 1
+#endif
+#if (POSCFG_FEATURE_STACKCHECK != 0) && (POSCFG_STACKGUARD_WORDS < 1)
+#error POSCFG_STACKGUARD_WORDS must be at least 1
+#endif
+#if (POSCFG_FEATURE_STACKCHECK != 0) && (POSCFG_PORT_STACKGUARD == 0)
+#error POSCFG_FEATURE_STACKCHECK is not supported by this port (POSCFG_PORT_STACKGUARD)
+#endif
+#if (POSCFG_FEATURE_VIRTUALTIME != 0) && (POSCFG_SMP_CORES > 1)
+#error POSCFG_FEATURE_VIRTUALTIME is not supported in SMP mode
+#endif
+#if POSCFG_COMPACT_OBJECTS != 0
+#if SYS_POSTALLOCATE != 0
+#error POSCFG_COMPACT_OBJECTS requires a fixed count of timers and message buffers
+#endif
+#if (POSCFG_MAX_TIMER > 65535) || (POSCFG_MAX_MESSAGES > 65535) || \
+    (POSCFG_MAX_TASKS > 65535) || \
+    ((POSCFG_MAX_EVENTS + SYS_MSGBOXEVENTS) > 65535)
+#error POSCFG_COMPACT_OBJECTS supports not more than 65535 objects per type
+#endif
+#endif
+#if (POSCFG_FEATURE_MUTEXPROF != 0) && (POSCFG_FEATURE_HRTIME == 0)
+#error POSCFG_FEATURE_MUTEXPROF requires POSCFG_FEATURE_HRTIME to be enabled
+#endif
+#if POSCFG_FEATURE_LOCKPROF != 0
+#if POSCFG_FEATURE_HRTIME == 0
+#error POSCFG_FEATURE_LOCKPROF requires POSCFG_FEATURE_HRTIME to be enabled
+#endif
+#if !defined(POS_SCHED_LOCK_RAW) || !defined(POS_SCHED_UNLOCK_RAW)
+#error POSCFG_FEATURE_LOCKPROF requires the port to define POS_SCHED_LOCK_RAW
+#endif
+#if POSCFG_LOCKPROF_BUCKETS < 2
+#error POSCFG_LOCKPROF_BUCKETS must be at least 2
+#endif
+#endif
 #if (POSCFG_FEATURE_MSGBOXES != 0) && (POSCFG_FEATURE_GETTASK == 0)
 #undef POSCFG_FEATURE_GETTASK
 #define POSCFG_FEATURE_GETTASK 1
@@ -661,6 +840,17 @@
 #define SYS_TASKTABSIZE_X  POSCFG_TASKS_PER_PRIO
 #define SYS_TASKTABSIZE_Y  POSCFG_MAX_PRIO_LEVEL
 #endif
+#if SYS_TASKTABSIZE_Y > MVAR_BITS
+#define SYS_TASKTABSIZE_Z  ((SYS_TASKTABSIZE_Y+MVAR_BITS-1)/MVAR_BITS)
+#else
+#define SYS_TASKTABSIZE_Z  1
+#endif
+
+#if POSCFG_SMP_CORES > 1
+#define SYS_SMP  1
+#else
+#define SYS_SMP  0
+#endif
 
 #define SYS_TASKSTATE (POSCFG_FEATURE_TASKUNUSED | POSCFG_FEATURE_MSGBOXES)
 
@@ -811,6 +1001,30 @@ typedef INT_t             SJIF_t;
 typedef UINT_t            JIF_t;
 #endif
 
+#if (DOX!=0) || (POSCFG_FEATURE_HRTIME != 0)
+#ifndef MCYC_t
+#define MCYC_t long
+#endif
+/** @brief  Cycle counter type.
+ * Unsigned type of the free running counter that is returned by
+ * ::posGetCycles. ::MCYC_t is a define that can be set in the port
+ * configuration file, it defaults to @e long.
+ * @sa posGetCycles, POSTIME_t
+ */
+typedef unsigned MCYC_t   POSCYCLES_t;
+
+#ifndef MTIME_t
+#define MTIME_t long long
+#endif
+/** @brief  High resolution time type.
+ * Unsigned type that holds the time in nanoseconds returned by
+ * ::posGetTimeNs. It should have 64 bits. ::MTIME_t is a define that
+ * can be set in the port configuration file, it defaults to @e long long.
+ * @sa posGetTimeNs, POSCYCLES_t
+ */
+typedef unsigned MTIME_t  POSTIME_t;
+#endif
+
 /** @brief  Generic function pointer.
  * @param arg  optional argument, can be NULL if not used.
  */
@@ -855,11 +1069,154 @@ typedef struct POSFLAG *POSFLAG_t;
  */
 typedef struct POSTIMER *POSTIMER_t;
 
+#if (DOX!=0) || (POSCFG_FEATURE_TIMERCALLBACK != 0)
+/** @brief  Timer callback function pointer.
+ * @param tmr  handle to the timer that has fired.
+ * @param arg  the argument that was passed to ::posTimerSetCallback.
+ * @sa posTimerSetCallback
+ */
+typedef void (*POSTIMERFUNC_t)(POSTIMER_t tmr, void *arg);
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_MSGMATCH != 0)
+/** @brief  Message filter function pointer.
+ * @param buf  pointer to the message that shall be tested.
+ * @param arg  the argument that was passed to ::posMessageWaitMatch.
+ * @return  nonzero when the message matches.
+ * @sa posMessageWaitMatch
+ */
+typedef VAR_t (*POSMSGMATCH_t)(void *buf, void *arg);
+#endif
+
+#if (DOX!=0) || (POSCFG_CTXSW_ADAPTIVE != 0)
+/** Context switch statistics.
+ * This structure is filled by the function ::posCtxSwitchStats.
+ * The event rate is measured by counting all signal operations on
+ * semaphores, mutexes, flags and message boxes.
+ */
+typedef struct {
+  UINT_t  events;    /*!< count of signalled events */
+  UINT_t  deferred;  /*!< count of tasks that were made ready without
+                          an immediate context switch, every deferred
+                          task saved at least one switch */
+  UINT_t  delayed;   /*!< count of timer ticks that had to switch to
+                          a task that was woken up before */
+  UVAR_t  threshold; /*!< current combine threshold */
+#if (DOX!=0) || (POSCFG_FEATURE_HRTIME != 0)
+  POSCYCLES_t latency;    /*!< longest time from a deferred wakeup until
+                               the scheduler ran, in the last timer tick.
+                               The time is measured in cycles of
+                               ::POS_CYCLES (see ::POS_CYCLES_HZ). */
+  POSCYCLES_t maxlatency; /*!< longest time from a deferred wakeup until
+                               the scheduler ran, since the start */
+#endif
+} POSCTXSTATS_t;
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_STATISTICS != 0)
+/** Task statistics.
+ * This structure is filled by the function ::posTaskGetStats.
+ * All counters are cleared when the task is created.
+ */
+typedef struct {
+  UINT_t  switches;  /*!< count of context switches to this task */
+  UINT_t  wakeups;   /*!< count of wakeups by a signalled event */
+  UINT_t  timeouts;  /*!< count of waits that ended with a timeout */
+  UINT_t  msgcount;  /*!< current count of messages in the message box */
+  UINT_t  msgmax;    /*!< highest count of messages in the message box */
+#if (DOX!=0) || (POSCFG_FEATURE_HRTIME != 0)
+  POSTIME_t runcycles; /*!< cycles (see ::posGetCycles) the task has run,
+                            only available with ::POSCFG_FEATURE_HRTIME */
+#endif
+  UVAR_t  state;     /*!< state of the task when the statistics were
+                          read, see ::POSTASKRUN_RUNNING */
+} POSTASKSTATS_t;
+
+/** Task state in POSTASKSTATS_t: The task is running on a core. */
+#define POSTASKRUN_RUNNING   1
+/** Task state in POSTASKSTATS_t: The task is ready to run. */
+#define POSTASKRUN_READY     2
+/** Task state in POSTASKSTATS_t: The task sleeps or waits for an event. */
+#define POSTASKRUN_BLOCKED   3
+/** Task state in POSTASKSTATS_t: The task waits for a message. */
+#define POSTASKRUN_WAITMSG   4
+
+/** Event statistics.
+ * This structure is filled by the function ::posEventGetStats.
+ * All counters are cleared when the event object is created.
+ */
+typedef struct {
+  UINT_t  signals;   /*!< count of signal operations */
+  UINT_t  contended; /*!< count of waits that had to block the task */
+  UINT_t  timeouts;  /*!< count of waits that ended with a timeout */
+} POSEVENTSTATS_t;
+
+/** System statistics.
+ * This structure is filled by the function ::posSystemGetStats.
+ */
+typedef struct {
+  UINT_t  switches;  /*!< total count of context switches */
+  UINT_t  allocfail; /*!< count of object allocations that failed or,
+                          for message buffers, had to wait because
+                          the pool was exhausted */
+} POSSYSSTATS_t;
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_LOCKPROF != 0)
+/** @defgroup lockprof Critical Section Types
+ * @ingroup userapip
+ * Types of the critical sections measured by the lock profiler,
+ * see ::POSLOCKSTATS_t.
+ * @{
+ */
+#define POSLOCK_SCHED    0  /*!< section locked by ::POS_SCHED_LOCK */
+#define POSLOCK_IRQALL   1  /*!< section locked by ::POS_IRQ_DISABLE_ALL */
+#define POSLOCK_INHIBIT  2  /*!< section locked by ::posTaskSchedLock */
+/** @} */
+
+/** Critical section statistics.
+ * The lock profiler keeps one set of statistics per call site of a
+ * lock macro or of the function ::posTaskSchedLock. The hold time of
+ * a section is measured with the cycle counter (see ::POS_CYCLES).
+ * Bucket 0 of the histogram counts sections shorter than
+ * ::POSCFG_LOCKPROF_MINCYCLES, the upper limit of each following
+ * bucket is twice the limit of the previous one. The last bucket
+ * counts all longer sections.
+ * @sa posLockProfNext
+ */
+typedef struct {
+  const char  *file;  /*!< source file of the call site */
+  UINT_t       line;  /*!< source line of the call site */
+  UVAR_t       type;  /*!< type of the section, POSLOCK_xxx */
+  UINT_t       count; /*!< count of completed sections */
+  POSCYCLES_t  max;   /*!< longest hold time in cycles */
+  UINT_t       hist[POSCFG_LOCKPROF_BUCKETS]; /*!< hold time histogram */
+} POSLOCKSTATS_t;
+
+/** Call site of a critical section.
+ * The lock macros place a static variable of this type at every
+ * call site. The site is added to the list of the lock profiler
+ * when its first section was completed.
+ */
+typedef struct POSLOCKSITE_s {
+  POSLOCKSTATS_t         stats;
+  struct POSLOCKSITE_s  *next;
+  UVAR_t                 listed;
+} POSLOCKSITE_t;
+
+#define POS_LOCKSITE_INIT(type)  { { __FILE__, __LINE__, type } }
+#endif
+
 /** @brief  Atomic variable.
- * @sa posAtomicGet, posAtomicSet, posAtomicAdd, posAtomicSub
+ * @sa posAtomicGet, posAtomicSet, posAtomicAdd, posAtomicSub, posAtomicCAS
  */
 typedef volatile INT_t  POSATOMIC_t;
 
+/** @brief  Atomic pointer variable.
+ * @sa posAtomicPtrGet, posAtomicPtrSet, posAtomicPtrCAS
+ */
+typedef void * volatile  POSATOMICPTR_t;
+
 #if (DOX!=0) || (POSCFG_FEATURE_LISTS != 0)
 struct POSLIST;
 struct POSLISTHEAD {
@@ -912,6 +1269,26 @@ typedef struct POSLISTHEAD POSLISTHEAD_t;
  */
 typedef struct POSTASK  *POSTASK_t; /* forward declaration */
 
+#if (DOX!=0) || (POSCFG_FEATURE_MUTEXPROF != 0)
+/** Mutex contention record.
+ * This structure is filled by the function ::posMutexGetProf.
+ * All times are measured with the cycle counter (see ::POS_CYCLES).
+ * The wait time of a task starts when it blocks in ::posMutexLock and
+ * ends when it runs again with the mutex locked. The hold time is
+ * measured from the first lock to the last unlock of the owner.
+ */
+typedef struct {
+  UINT_t       locks;     /*!< count of times the mutex was acquired */
+  UINT_t       contended; /*!< count of locks that had to block */
+  POSTIME_t    waittotal; /*!< sum of all wait times in cycles */
+  POSCYCLES_t  waitmax;   /*!< longest wait time in cycles */
+  POSTIME_t    holdtotal; /*!< sum of all hold times in cycles */
+  POSCYCLES_t  holdmax;   /*!< longest hold time in cycles */
+  POSTASK_t    holder;    /*!< task that owns the mutex now, or NULL */
+  POSTASK_t    maxholder; /*!< task that held the mutex the longest time */
+} POSMUTEXPROF_t;
+#endif
+
 
 
 /*---------------------------------------------------------------------------
@@ -921,12 +1298,36 @@ typedef struct POSTASK  *POSTASK_t; /* forward declaration */
 #ifndef POSCFG_FBIT_USE_LUTABLE
 #define POSCFG_FBIT_USE_LUTABLE  0
 #endif
+#ifndef POSCFG_FBIT_BUILTIN
+#define POSCFG_FBIT_BUILTIN  0
+#endif
+#if POSCFG_FBIT_BUILTIN != 0
+#if !defined(__GNUC__)
+#error POSCFG_FBIT_BUILTIN requires a GCC compatible compiler
+#endif
+#undef POSCFG_FBIT_USE_LUTABLE
+#define POSCFG_FBIT_USE_LUTABLE 0
+#endif
 #if (POSCFG_FBIT_USE_LUTABLE > 1) && (POSCFG_ROUNDROBIN == 0)
 #undef POSCFG_FBIT_USE_LUTABLE
 #define POSCFG_FBIT_USE_LUTABLE 1
 #endif
 #ifndef FINDBIT
-#if POSCFG_FBIT_USE_LUTABLE == 1
+#if POSCFG_FBIT_BUILTIN != 0
+/* count trailing zeros and rotate right (the round robin offset) */
+#if MVAR_BITS == 64
+#define POS_FBIT_CTZ(x)  __builtin_ctzll((unsigned long long)(x))
+#elif MVAR_BITS == 32
+#define POS_FBIT_CTZ(x)  __builtin_ctzl((unsigned long)(x))
+#else
+#define POS_FBIT_CTZ(x)  __builtin_ctz((unsigned int)(x))
+#endif
+#define POS_FBIT_ROTR(x, o) \
+  ((UVAR_t)(((UVAR_t)(x) >> (o)) | \
+            ((UVAR_t)(x) << ((MVAR_BITS - (o)) & (MVAR_BITS - 1)))))
+#define FINDBIT(x, o) \
+  ((UVAR_t)((POS_FBIT_CTZ(POS_FBIT_ROTR(x, o)) + (o)) & (MVAR_BITS - 1)))
+#elif POSCFG_FBIT_USE_LUTABLE == 1
 #if POSCFG_ROUNDROBIN == 0
 #ifndef _FBIT_GEN_C
 extern VAR_t const p_pos_fbittbl[256];
@@ -950,6 +1351,7 @@ extern VAR_t const p_pos_fbittbl_rr[8][256];
  *  GLOBAL VARIABLES
  *-------------------------------------------------------------------------*/
 
+#if (DOX!=0) || (SYS_SMP == 0)
 /** @brief  Global task variable.
  * This variable points to the environment structure of the currently
  * active task.
@@ -981,6 +1383,39 @@ POSEXTERN volatile UVAR_t    posInInterrupt_g;
 #else
 POSEXTERN volatile UVAR_t    posInInterrupt_g = 1;
 #endif
+#endif /* (DOX!=0) || (SYS_SMP == 0) */
+
+#if (DOX!=0) || (SYS_SMP != 0)
+/** @brief  Per-core task variables.
+ * In SMP mode (::POSCFG_SMP_CORES > 1) every core has its own current
+ * task, next task and interrupt nesting counter. The names
+ * ::posCurrentTask_g, ::posNextTask_g and ::posInInterrupt_g are then
+ * macros that select the entry of the calling core (see ::POS_CPUID).
+ * Since a preempted task may be resumed on another core, the macros
+ * ::posCurrentTask_g and ::posInInterrupt_g can only be read. The
+ * context switch functions of a port must write the current task
+ * to posCoreCurrentTask_g[POS_CPUID].
+ */
+POSEXTERN volatile POSTASK_t posCoreCurrentTask_g[POSCFG_SMP_CORES];
+POSEXTERN volatile POSTASK_t posCoreNextTask_g[POSCFG_SMP_CORES];
+POSEXTERN volatile UVAR_t    posCoreInInterrupt_g[POSCFG_SMP_CORES];
+
+/** @brief  Kernel spinlock.
+ * In SMP mode the macro ::POS_SCHED_LOCK must disable the interrupts
+ * of the calling core and then acquire this spinlock with an atomic
+ * test-and-set operation. ::POS_SCHED_UNLOCK releases the spinlock and
+ * restores the interrupt state. Note that a context switch is always
+ * done with the lock acquired, and the lock is released by the task
+ * that is switched to, possibly on another core.
+ */
+POSEXTERN volatile UVAR_t    posKernelLock_g;
+
+#if DOX==0
+#define posCurrentTask_g  c_pos_smpCurrentTask()
+#define posNextTask_g     posCoreNextTask_g[POS_CPUID]
+#define posInInterrupt_g  c_pos_smpInInterrupt()
+#endif
+#endif /* (DOX!=0) || (SYS_SMP != 0) */
 
 /** @brief  Global flag variable.
  * This variable is nonzero when the operating system is initialized
@@ -1080,7 +1515,9 @@ POSEXTERN VAR_t* _errno_p(void);
  * It is possible to implement the findbit mechanism as look up table.
  * For this purpose you can define the macro @b FINDBIT. Please see the
  * header file picoos.h (search for the word ::POSCFG_FBIT_USE_LUTABLE)
- * and the source file fbit_gen.c for details.@n
+ * and the source file fbit_gen.c for details. With GCC compatible
+ * compilers, the define ::POSCFG_FBIT_BUILTIN can be set to 1 to
+ * implement findbit with the __builtin_ctz compiler intrinsic.@n
  *
  * @n<h3>Assembler Functions</h3>
  * Unfortunately, not the whole operating system can be written in C.
@@ -1477,11 +1914,235 @@ POSEXTERN void POSCALL c_pos_intExitQuick(void);      /* picoos.c */
  *          timer interrupt is not triggered when the OS is not yet
  *          running.@n
  *          To avoid this race condintions, it is better to initialize
- *          the timer interrupt in the function ::p_pos_startFirstContext.
+ *          the timer interrupt in the function ::p_pos_startFirstContext.@n
+ *          When ::POSCFG_FEATURE_VIRTUALTIME is set to 1, this function
+ *          is called by the idle task, and the port must not start
+ *          its timer interrupt.
  * @sa      c_pos_intEnter, c_pos_intExit
  */
 POSEXTERN void POSCALL c_pos_timerInterrupt(void);      /* picoos.c */
 
+#if (DOX!=0) || (POSCFG_FEATURE_STACKCHECK != 0)
+/**
+ * Stack check function.
+ * The port calls this function from ::p_pos_initTask to place the
+ * guard words of the new task. The guard words are tested at every
+ * context switch away from the task, and the idle task tests the
+ * stacks of all tasks one after another. When a guard word was
+ * overwritten, the macro HOOK_STACKOVERFLOW(task) is executed once
+ * for the task. The default macro calls ::p_pos_assert; a port or
+ * the configuration can define its own macro. It is executed with
+ * the scheduler locked and must not call operating system functions.
+ * @param   task   handle to the task that is initialized.
+ * @param   guard  pointer to the end of the stack memory where the
+ *                 stack would overflow (the lowest address when
+ *                 the stack grows down). There must be space for
+ *                 ::POSCFG_STACKGUARD_WORDS words of type UVAR_t,
+ *                 the pointer must be aligned to UVAR_t.
+ * @note    ::POSCFG_FEATURE_STACKCHECK must be defined to 1
+ *          to have this function compiled in.
+ */
+POSEXTERN void POSCALL c_pos_setStackGuard(POSTASK_t task,
+                                           void *guard);  /* picoos.c */
+#endif
+
+#if (DOX!=0) || (SYS_SMP != 0)
+#ifndef POS_CPUID
+/** Core number of the calling core.
+ * In SMP mode this macro must return the number of the core
+ * the code is running on, in the range 0 .. ::POSCFG_SMP_CORES - 1.
+ * If the port does not define this macro in port.h, the function
+ * ::p_pos_cpuId is called. Note that a task may migrate to another
+ * core at any time, so the compiler must not cache the value
+ * (e.g. read it through a volatile access).
+ */
+#define POS_CPUID  p_pos_cpuId()
+#endif
+
+/**
+ * SMP function.
+ * Returns the number of the core the caller is running on.
+ * @note    This function is not part of the pico]OS. It must be
+ *          provided by the user, since it is architecture specific.@n
+ *          It is only needed when ::POSCFG_SMP_CORES is greater than 1
+ *          and the port does not define the macro ::POS_CPUID.
+ * @sa      POS_CPUID
+ */
+POSFROMEXT UVAR_t POSCALL p_pos_cpuId(void);              /* arch_c.c */
+
+/**
+ * SMP function.
+ * Sends an inter-processor interrupt to another core. The interrupt
+ * service routine on the target core must call ::c_pos_intEnter and
+ * ::c_pos_intExit, so that the target core runs its scheduler.
+ * @param   core  number of the core to interrupt.
+ * @note    This function is not part of the pico]OS. It must be
+ *          provided by the user, since it is architecture specific.@n
+ *          It is only needed when ::POSCFG_SMP_CORES is greater than 1.
+ *          The function is called with the kernel lock acquired,
+ *          so it must only post the interrupt and must not wait.
+ * @sa      c_pos_coreStart
+ */
+POSFROMEXT void POSCALL p_pos_ipiReschedule(UVAR_t core); /* arch_c.c */
+
+/**
+ * SMP function.
+ * Starts multitasking on a secondary core. ::posInit is executed on
+ * core 0; the port then calls this function once on every other core,
+ * for example from ::p_pos_startFirstContext. The function waits until
+ * pico]OS is running, selects the first task for the core and calls
+ * ::p_pos_startFirstContext on that core. It does not return.@n
+ * Every core should call ::c_pos_timerInterrupt from its own timer
+ * interrupt. Only core 0 advances the system time; the other cores
+ * use the interrupt for round robin scheduling and load balancing.
+ * @note    ::POSCFG_SMP_CORES must be greater than 1
+ *          to have this function compiled in.
+ * @sa      p_pos_ipiReschedule, posTaskSetAffinity
+ */
+POSEXTERN void POSCALL c_pos_coreStart(void);           /* picoos.c */
+
+/**
+ * SMP function.
+ * Returns the current task of the calling core. This function
+ * implements the macro ::posCurrentTask_g in SMP mode. The read is
+ * repeated when the caller was moved to another core meanwhile.
+ * @sa      c_pos_smpInInterrupt
+ */
+POSEXTERN POSTASK_t POSCALL c_pos_smpCurrentTask(void);  /* picoos.c */
+
+/**
+ * SMP function.
+ * Returns the interrupt nesting counter of the calling core. This
+ * function implements the macro ::posInInterrupt_g in SMP mode.
+ * @sa      c_pos_smpCurrentTask
+ */
+POSEXTERN UVAR_t POSCALL c_pos_smpInInterrupt(void);     /* picoos.c */
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_HRTIME != 0)
+#ifndef POS_CYCLES
+/** Read the cycle counter.
+ * This macro returns the value of a free running counter of type
+ * ::POSCYCLES_t, for example the DWT cycle counter of a Cortex-M
+ * or the value of clock_gettime(CLOCK_MONOTONIC) in nanoseconds on a
+ * host operating system. If the port does not define this macro in
+ * port.h, the function ::p_pos_cycles is called. The counter frequency
+ * must be set with the define ::POS_CYCLES_HZ in port.h, and the counter
+ * must not wrap around more than once per timer tick. In SMP mode the
+ * counters of all cores must be synchronized.
+ */
+#define POS_CYCLES()  p_pos_cycles()
+#endif
+#if DOX!=0
+/** Frequency of the cycle counter in Hz. This define must be set in
+ * port.h when ::POSCFG_FEATURE_HRTIME is enabled. It can also be an
+ * expression, e.g. the name of a variable that holds the CPU clock.
+ * @sa POS_CYCLES
+ */
+#define POS_CYCLES_HZ  (counter frequency)
+#endif
+
+/**
+ * High resolution time function.
+ * Returns the value of a free running counter, see ::POS_CYCLES.
+ * @note    This function is not part of the pico]OS. It must be
+ *          provided by the user, since it is architecture specific.@n
+ *          It is only needed when ::POSCFG_FEATURE_HRTIME is set to 1
+ *          and the port does not define the macro ::POS_CYCLES.
+ * @sa      posGetCycles, posGetTimeNs
+ */
+POSFROMEXT POSCYCLES_t POSCALL p_pos_cycles(void);        /* arch_c.c */
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_LOCKPROF != 0)
+/**
+ * Lock profiler function.
+ * This function is called by the macro ::POS_SCHED_LOCK after the
+ * port has locked the scheduler. It starts the time measurement of
+ * the critical section. Nested sections are counted to the site of
+ * the outermost lock.
+ * @param   site  static call site variable created by the macro.
+ * @note    ::POSCFG_FEATURE_LOCKPROF must be defined to 1
+ *          to have this function compiled in.
+ * @sa      c_pos_lockProfLeave
+ */
+POSEXTERN void POSCALL c_pos_lockProfEnter(POSLOCKSITE_t *site); /* picoos.c */
+
+/**
+ * Lock profiler function.
+ * This function is called by the macro ::POS_SCHED_UNLOCK before the
+ * port unlocks the scheduler. It stops the time measurement and adds
+ * the hold time to the statistics of the call site.
+ * @note    ::POSCFG_FEATURE_LOCKPROF must be defined to 1
+ *          to have this function compiled in.
+ * @sa      c_pos_lockProfEnter
+ */
+POSEXTERN void POSCALL c_pos_lockProfLeave(void);     /* picoos.c */
+#endif
+
+#ifdef POS_SCHED_LOCK_RAW
+/* The port defines the lock macros with the suffix _RAW,
+ * so the lock profiler can be inserted here. */
+#if POSCFG_FEATURE_LOCKPROF != 0
+#define POS_SCHED_LOCK \
+  do { static POSLOCKSITE_t pos_lsite_ = POS_LOCKSITE_INIT(POSLOCK_SCHED); \
+       POS_SCHED_LOCK_RAW; c_pos_lockProfEnter(&pos_lsite_); } while(0)
+#define POS_SCHED_UNLOCK \
+  do { c_pos_lockProfLeave(); POS_SCHED_UNLOCK_RAW; } while(0)
+#ifdef POS_IRQ_DISABLE_ALL_RAW
+#define POS_IRQ_DISABLE_ALL \
+  do { static POSLOCKSITE_t pos_lsite_ = POS_LOCKSITE_INIT(POSLOCK_IRQALL); \
+       POS_IRQ_DISABLE_ALL_RAW; c_pos_lockProfEnter(&pos_lsite_); } while(0)
+#define POS_IRQ_ENABLE_ALL \
+  do { c_pos_lockProfLeave(); POS_IRQ_ENABLE_ALL_RAW; } while(0)
+#endif
+#else
+#define POS_SCHED_LOCK      POS_SCHED_LOCK_RAW
+#define POS_SCHED_UNLOCK    POS_SCHED_UNLOCK_RAW
+#ifdef POS_IRQ_DISABLE_ALL_RAW
+#define POS_IRQ_DISABLE_ALL POS_IRQ_DISABLE_ALL_RAW
+#define POS_IRQ_ENABLE_ALL  POS_IRQ_ENABLE_ALL_RAW
+#endif
+#endif
+#endif
+
+#if (DOX!=0) || (POSCFG_ATOMIC_BUILTIN == 2)
+/**
+ * Atomic variable function.
+ * Compares the atomic variable with @p oldval and, if they are equal,
+ * stores @p newval into the variable. The compare and the store must
+ * be executed as one atomic operation, e.g. with the LDREX / STREX
+ * instructions, without disabling interrupts.
+ * @param   var     pointer to the atomic variable.
+ * @param   oldval  expected value of the variable.
+ * @param   newval  new value of the variable.
+ * @return  the value of the variable before the operation.
+ * @note    This function is not part of the pico]OS. It must be
+ *          provided by the user, since it is architecture specific.@n
+ *          It is only needed when ::POSCFG_ATOMIC_BUILTIN is set to 2.
+ *          The port must also guarantee that a single read or write
+ *          of an INT_t or a pointer variable is atomic.
+ * @sa      p_pos_atomicPtrCAS, posAtomicCAS
+ */
+POSFROMEXT INT_t POSCALL p_pos_atomicCAS(POSATOMIC_t *var, INT_t oldval,
+                                         INT_t newval);     /* arch_c.c */
+
+/**
+ * Atomic variable function.
+ * Same as ::p_pos_atomicCAS, but for pointer variables.
+ * @param   var     pointer to the atomic pointer variable.
+ * @param   oldptr  expected value of the variable.
+ * @param   newptr  new value of the variable.
+ * @return  the value of the variable before the operation.
+ * @note    This function is not part of the pico]OS. It must be
+ *          provided by the user, since it is architecture specific.@n
+ *          It is only needed when ::POSCFG_ATOMIC_BUILTIN is set to 2.
+ * @sa      p_pos_atomicCAS, posAtomicPtrCAS
+ */
+POSFROMEXT void* POSCALL p_pos_atomicPtrCAS(POSATOMICPTR_t *var, void *oldptr,
+                                            void *newptr);  /* arch_c.c */
+#endif
+
 /** @} */
 
 
@@ -1525,6 +2186,128 @@ POSEXTERN void POSCALL posTaskYield(void);
 POSEXTERN void POSCALL posTaskSleep(UINT_t ticks);
 #endif
 
+#if (DOX!=0) || (POSCFG_FEATURE_SLEEPUNTIL != 0)
+/**
+ * Task function.
+ * Delay task execution until the ::jiffies counter reaches the
+ * given value. Other than with ::posTaskSleep, the wakeup time does
+ * not depend on the time the task needs to call this function,
+ * so periodic loops do not drift.
+ * @param   wakeup  absolute wakeup time in timer ticks. If this time
+ *                  has already passed, the function returns immediately.
+ *                  The time must not be more than half of the ::jiffies
+ *                  range in the future (see ::POS_TIMEAFTER).
+ * @note    ::POSCFG_FEATURE_SLEEPUNTIL must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posTaskSleepPeriodic, posTaskSleep, jiffies
+ */
+POSEXTERN void POSCALL posTaskSleepUntil(JIF_t wakeup);
+
+/**
+ * Task function.
+ * Helper function for periodic tasks. The function advances the
+ * release time by one period and sleeps until this time. Example
+ * of a task that runs exactly every millisecond:
+ * @code
+ *   JIF_t next = jiffies;
+ *   for (;;) {
+ *     posTaskSleepPeriodic(&next, MS(1));
+ *     control_loop();
+ *   }
+ * @endcode
+ * If the task has been running so long that the next release time
+ * has already passed, the missed release times are skipped, and the
+ * task sleeps until the next release time that is in the future.
+ * The phase of the period is kept.
+ * @param   wakeup  pointer to the release time. Must be initialized
+ *                  by the caller before the first call, e.g. with
+ *                  the current value of ::jiffies.
+ * @param   period  period in timer ticks. Must not be zero.
+ * @return  the count of release times that were skipped.
+ *          Zero means that the task has met its period.
+ * @note    ::POSCFG_FEATURE_SLEEPUNTIL must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posTaskSleepUntil, jiffies
+ */
+POSEXTERN UINT_t POSCALL posTaskSleepPeriodic(JIF_t *wakeup, UINT_t period);
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_EDF != 0)
+/**
+ * Task function.
+ * Puts a task into the earliest-deadline-first (EDF) scheduling class.
+ * The task must run at the priority level ::POSCFG_EDF_PRIO. Inside
+ * this level, the ready task with the earliest absolute deadline is
+ * always scheduled first; tasks without a deadline are scheduled round
+ * robin when no deadline task is ready. The first period starts
+ * with the call to this function.
+ * @param   taskhandle  handle to the task.
+ * @param   period      task period in timer ticks. If zero, the task
+ *                      leaves the EDF class.
+ * @param   deadline    relative deadline in timer ticks, counted from
+ *                      the start of each period. Must not be larger
+ *                      than the period. Zero means that the deadline
+ *                      equals the period.
+ * @return  zero on success. -E_ARG is returned when the task does not
+ *          run at priority ::POSCFG_EDF_PRIO or the deadline is too large.
+ * @note    ::POSCFG_FEATURE_EDF must be defined to 1
+ *          to have this function compiled in.@n
+ *          The deadline-miss counter of the task is reset.
+ * @sa      posTaskWaitPeriod, posTaskGetDeadlineMisses
+ */
+POSEXTERN VAR_t POSCALL posTaskSetDeadline(POSTASK_t taskhandle,
+                                           UINT_t period, UINT_t deadline);
+
+/**
+ * Task function.
+ * Must be called by an EDF task when it has completed the work of
+ * the current period. The function checks the deadline of the current
+ * period, moves the deadline to the next period and sleeps until the
+ * next period starts. If the task is late by more than its relative
+ * deadline, the periods are resynchronized to the current time.
+ * @return  zero when the deadline was met, 1 when the deadline was
+ *          missed (the deadline-miss counter was incremented).
+ *          -E_FAIL is returned when the task has no deadline set.
+ * @note    ::POSCFG_FEATURE_EDF must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posTaskSetDeadline, posTaskGetDeadlineMisses
+ */
+POSEXTERN VAR_t POSCALL posTaskWaitPeriod(void);
+
+/**
+ * Task function.
+ * Returns the count of missed deadlines of an EDF task.
+ * @param   taskhandle  handle to the task.
+ * @return  count of deadlines the task has missed since
+ *          ::posTaskSetDeadline was called.
+ * @note    ::POSCFG_FEATURE_EDF must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posTaskSetDeadline, posTaskWaitPeriod
+ */
+POSEXTERN UINT_t POSCALL posTaskGetDeadlineMisses(POSTASK_t taskhandle);
+#endif
+
+#if (DOX!=0) || (SYS_SMP != 0)
+/**
+ * Task function.
+ * Sets the cores a task is allowed to run on. New tasks may run on
+ * all cores. When a task becomes ready, it is placed on the allowed
+ * core that currently runs the task with the lowest priority.
+ * If the calling task excludes its own core, it is moved to an
+ * allowed core immediately. A task that is running on another core
+ * is moved the next time that core runs its scheduler.
+ * @param   taskhandle  handle to the task.
+ * @param   coremask    bit mask of allowed cores, bit 0 is core 0.
+ * @return  zero on success. -E_ARG is returned when the mask
+ *          contains no existing core.
+ * @note    ::POSCFG_SMP_CORES must be greater than 1
+ *          to have this function compiled in.
+ * @sa      c_pos_coreStart
+ */
+POSEXTERN VAR_t POSCALL posTaskSetAffinity(POSTASK_t taskhandle,
+                                           UVAR_t coremask);
+#endif
+
 #if (DOX!=0) || (POSCFG_TASKSTACKTYPE == 0)
 /**
  * Task function.
@@ -1740,6 +2523,109 @@ POSEXTERN void POSCALL posTaskSchedLock(void);
  * @sa      posTaskSchedLock
  */
 POSEXTERN void POSCALL posTaskSchedUnlock(void);
+
+#if POSCFG_FEATURE_LOCKPROF != 0
+/* The lock profiler needs the call site of posTaskSchedLock. */
+POSEXTERN void POSCALL c_pos_taskSchedLock(POSLOCKSITE_t *site);
+#define posTaskSchedLock() \
+  do { static POSLOCKSITE_t pos_lsite_ = POS_LOCKSITE_INIT(POSLOCK_INHIBIT); \
+       c_pos_taskSchedLock(&pos_lsite_); } while(0)
+#endif
+#endif
+
+#if (DOX!=0) || (POSCFG_CTXSW_ADAPTIVE != 0)
+/**
+ * Task function.
+ * Returns the statistics of the adaptive context switch combining.
+ * The counters are never reset, so the caller should evaluate the
+ * differences between two calls.
+ * @param   stats  pointer to a structure that shall be filled
+ *                 with the current statistics.
+ * @return  zero on success. A negative value is returned on error.
+ * @note    ::POSCFG_CTXSW_ADAPTIVE must be defined to 1
+ *          to have this function compiled in.
+ * @sa      POSCTXSTATS_t
+ */
+POSEXTERN VAR_t POSCALL posCtxSwitchStats(POSCTXSTATS_t *stats);
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_LOCKPROF != 0)
+/**
+ * Lock profiler function.
+ * Iterates over the call sites of all critical sections that were
+ * completed at least once, and copies the statistics of a site.
+ * Start with @p site set to NULL to get the first site, then pass
+ * the returned value to get the next site. The sites are not sorted,
+ * the caller can look for the site with the longest hold time.
+ * @param   site   the previous call site, or NULL to get the first.
+ * @param   stats  pointer to a structure that is filled with the
+ *                 statistics of the returned site.
+ * @return  the next call site, or NULL when there are no more sites.
+ * @note    ::POSCFG_FEATURE_LOCKPROF must be defined to 1
+ *          to have this function compiled in.@n
+ *          Only call sites in source files compiled with the lock
+ *          profiler enabled are measured, and the port must define
+ *          the lock macros with the suffix _RAW (e.g.
+ *          POS_SCHED_LOCK_RAW).@n
+ *          The time from a context switch to the end of the critical
+ *          section in the next task is not measured.
+ * @sa      posLockProfReset, POSLOCKSTATS_t
+ */
+POSEXTERN POSLOCKSITE_t* POSCALL posLockProfNext(POSLOCKSITE_t *site,
+                                                 POSLOCKSTATS_t *stats);
+
+/**
+ * Lock profiler function.
+ * Clears the statistics of all call sites.
+ * @note    ::POSCFG_FEATURE_LOCKPROF must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posLockProfNext
+ */
+POSEXTERN void POSCALL posLockProfReset(void);
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_STATISTICS != 0)
+/**
+ * Statistics function.
+ * Returns the statistics counters and the current state of a task.
+ * The counters are never reset, so the caller should evaluate the
+ * differences between two calls.
+ * @param   taskhandle  handle to the task.
+ * @param   stats       pointer to a structure that shall be filled
+ *                      with the current statistics.
+ * @return  zero on success. A negative value is returned on error.
+ * @note    ::POSCFG_FEATURE_STATISTICS must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posEventGetStats, posSystemGetStats, POSTASKSTATS_t
+ */
+POSEXTERN VAR_t POSCALL posTaskGetStats(POSTASK_t taskhandle,
+                                        POSTASKSTATS_t *stats);
+
+/**
+ * Statistics function.
+ * Returns the statistics counters of an event object.
+ * @param   event   handle to a semaphore, mutex or flag object.
+ * @param   stats   pointer to a structure that shall be filled
+ *                  with the current statistics.
+ * @return  zero on success. A negative value is returned on error.
+ * @note    ::POSCFG_FEATURE_STATISTICS must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posTaskGetStats, posSystemGetStats, POSEVENTSTATS_t
+ */
+POSEXTERN VAR_t POSCALL posEventGetStats(void *event,
+                                         POSEVENTSTATS_t *stats);
+
+/**
+ * Statistics function.
+ * Returns the system wide statistics counters.
+ * @param   stats   pointer to a structure that shall be filled
+ *                  with the current statistics.
+ * @return  zero on success. A negative value is returned on error.
+ * @note    ::POSCFG_FEATURE_STATISTICS must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posTaskGetStats, posEventGetStats, POSSYSSTATS_t
+ */
+POSEXTERN VAR_t POSCALL posSystemGetStats(POSSYSSTATS_t *stats);
 #endif
 
 #if (DOX!=0) || (POSCFG_TASKCB_USERSPACE > 0)
@@ -1892,6 +2778,24 @@ POSEXTERN VAR_t POSCALL posSemaSignal(POSSEMA_t sema);
 POSEXTERN VAR_t POSCALL posSemaWait(POSSEMA_t sema, UINT_t timeoutticks);
 #endif
 
+#if (DOX!=0) || ((POSCFG_FEATURE_SEMAWAIT != 0) && \
+                 (POSCFG_FEATURE_SLEEPUNTIL != 0))
+/**
+ * Semaphore function.
+ * Same as ::posSemaWait, but with an absolute timeout.
+ * @param   sema      handle to the semaphore object.
+ * @param   deadline  the function times out when the ::jiffies counter
+ *                    reaches this value. If the time has already
+ *                    passed, the function does not block.
+ * @return  zero on success. A positive value (1 or TRUE) is returned
+ *          when the timeout was reached.
+ * @note    ::POSCFG_FEATURE_SEMAWAIT and ::POSCFG_FEATURE_SLEEPUNTIL
+ *          must be defined to 1 to have this function compiled in.
+ * @sa      posSemaWait, posTaskSleepUntil
+ */
+POSEXTERN VAR_t POSCALL posSemaWaitUntil(POSSEMA_t sema, JIF_t deadline);
+#endif
+
 #endif /* SYS_FEATURE_EVENTS */
 /** @} */
 
@@ -1980,6 +2884,37 @@ POSEXTERN VAR_t POSCALL posMutexLock(POSMUTEX_t mutex);
  */
 POSEXTERN VAR_t POSCALL posMutexUnlock(POSMUTEX_t mutex);
 
+#if (DOX!=0) || (POSCFG_FEATURE_MUTEXPROF != 0)
+/**
+ * Mutex function.
+ * Returns the contention record of a mutex. The record tells how often
+ * the mutex was locked, how often a task had to wait for it, how long
+ * the tasks have waited and how long the mutex was held.
+ * @param   mutex  handle to the mutex object.
+ * @param   prof   pointer to a structure that shall be filled
+ *                 with the contention record.
+ * @return  zero on success. A negative value is returned on error.
+ * @note    ::POSCFG_FEATURE_MUTEXPROF must be defined to 1
+ *          to have this function compiled in.@n
+ *          The nano layer function ::nosMutexProfDump prints the records
+ *          of all named mutexes, sorted by the total wait time.
+ * @sa      posMutexProfReset, POSMUTEXPROF_t
+ */
+POSEXTERN VAR_t POSCALL posMutexGetProf(POSMUTEX_t mutex,
+                                        POSMUTEXPROF_t *prof);
+
+/**
+ * Mutex function.
+ * Clears the contention record of a mutex.
+ * @param   mutex  handle to the mutex object.
+ * @return  zero on success. A negative value is returned on error.
+ * @note    ::POSCFG_FEATURE_MUTEXPROF must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posMutexGetProf
+ */
+POSEXTERN VAR_t POSCALL posMutexProfReset(POSMUTEX_t mutex);
+#endif
+
 #endif /* POSCFG_FEATURE_MUTEXES */
 /** @} */
 
@@ -2058,6 +2993,25 @@ POSEXTERN void POSCALL posMessageFree(void *buf);
  */
 POSEXTERN VAR_t POSCALL posMessageSend(void *buf, POSTASK_t taskhandle);
 
+#if (DOX!=0) || (POSCFG_FEATURE_MSGURGENT != 0)
+/**
+ * Message box function.
+ * Sends an urgent message to a task. Urgent messages are
+ * received before all normal messages that are already waiting
+ * in the message box of the task. Several urgent messages are
+ * received in the order they were sent.
+ * @param   buf  pointer to the message to send
+ *               (see ::posMessageSend).
+ * @param   taskhandle  handle to the task to send the message to.
+ * @return  zero on success. When an error condition exist, a
+ *          negative value is returned and the message buffer is freed.
+ * @note    ::POSCFG_FEATURE_MSGURGENT must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posMessageSend, posMessageGet
+ */
+POSEXTERN VAR_t POSCALL posMessageSendUrgent(void *buf, POSTASK_t taskhandle);
+#endif
+
 /**
  * Message box function. Gets a new message from the message box.
  * If no message is available, the task blocks until a new message
@@ -2123,6 +3077,51 @@ POSEXTERN VAR_t POSCALL posMessageAvailable(void);
 POSEXTERN void* POSCALL posMessageWait(UINT_t timeoutticks);
 #endif
 
+#if (DOX!=0) || ((POSCFG_FEATURE_MSGWAIT != 0) && \
+                 (POSCFG_FEATURE_SLEEPUNTIL != 0))
+/**
+ * Message box function.
+ * Same as ::posMessageWait, but with an absolute timeout.
+ * @param   deadline  the function times out when the ::jiffies counter
+ *                    reaches this value. If the time has already
+ *                    passed, the function does not block.
+ * @return  pointer to the received message, or NULL on timeout.
+ * @note    ::POSCFG_FEATURE_MSGWAIT and ::POSCFG_FEATURE_SLEEPUNTIL
+ *          must be defined to 1 to have this function compiled in.
+ * @sa      posMessageWait, posTaskSleepUntil
+ */
+POSEXTERN void* POSCALL posMessageWaitUntil(JIF_t deadline);
+#endif
+
+#if (DOX!=0) || (POSCFG_FEATURE_MSGMATCH != 0)
+/**
+ * Message box function.
+ * Gets the first message from the message box that is accepted
+ * by a filter function. All other messages stay in the message box
+ * in their order. If no matching message is available, the task
+ * blocks until a matching message is received or the timeout
+ * has been reached.
+ * @param   match  filter function. It is called with the
+ *          scheduler locked, so it must be short and must not
+ *          call any operating system function. Note that the
+ *          function may be called several times for the same message.
+ * @param   arg    optional argument that is passed to the
+ *                 filter function.
+ * @param   timeoutticks  timeout in timer ticks
+ *          (see ::HZ define and ::MS macro).
+ *          If this parameter is set to zero, the function immediately
+ *          returns. If this parameter is set to INFINITE, the
+ *          function will never time out.
+ * @return  pointer to the received message, or NULL when no
+ *          matching message was received within the specified time.
+ * @note    ::POSCFG_FEATURE_MSGMATCH must be defined to 1
+ *          to have this function compiled in.
+ * @sa      posMessageWait, posMessageFree, posMessageSendUrgent
+ */
+POSEXTERN void* POSCALL posMessageWaitMatch(POSMSGMATCH_t match, void *arg,
+                                            UINT_t timeoutticks);
+#endif
+
 #endif  /* POSCFG_FEATURE_MSGBOXES */
 /** @} */
 
@@ -2218,6 +3217,25 @@ POSEXTERN VAR_t POSCALL posFlagGet(POSFLAG_t flg, UVAR_t mode);
 POSEXTERN VAR_t POSCALL posFlagWait(POSFLAG_t flg, UINT_t timeoutticks);
 #endif
 
+#if (DOX!=0) || ((POSCFG_FEATURE_FLAGWAIT != 0) && \
+                 (POSCFG_FEATURE_SLEEPUNTIL != 0))
+/**
+ * Flag function.
+ * Same as ::posFlagWait, but with an absolute timeout.
+ * @param   flg       handle to the flag object.
+ * @param   deadline  the function times out when the ::jiffies counter
+ *                    reaches this value. If the time has already
+ *                    passed, the function does not block.
+ * @return  a mask of all set flags (positive value).
+ *          If zero is returned, the timeout was reached.
+ *          A negative value denotes an error.
+ * @note    ::POSCFG_FEATURE_FLAGWAIT and ::POSCFG_FEATURE_SLEEPUNTIL
+ *          must be defined to 1 to have this function compiled in.
+ * @sa      posFlagWait, posTaskSleepUntil
+ */
+POSEXTERN VAR_t POSCALL posFlagWaitUntil(POSFLAG_t flg, JIF_t deadline);
+#endif
+
 #define POSFLAG_MODE_GETSINGLE   0
 #define POSFLAG_MODE_GETMASK     1
 
@@ -2282,6 +3300,38 @@ POSEXTERN  JIF_t POSCALL posGetJiffies(void);
 
 #endif  /* POSCFG_FEATURE_JIFFIES */
 
+#if (DOX!=0) || (POSCFG_FEATURE_HRTIME != 0)
+
+/**
+ * Timer function.
+ * Returns the current value of the free running cycle counter of the
+ * port (see ::POS_CYCLES). This is the cheapest way to get a precise
+ * timestamp, e.g. to measure the execution time of a piece of code.
+ * The counter runs with ::POS_CYCLES_HZ and wraps around at the end
+ * of its range, so only differences of two values should be used.
+ * @return  the current value of the cycle counter.
+ * @note    ::POSCFG_FEATURE_HRTIME must be defined to 1 
+ *          to have this function compiled in.
+ * @sa      posGetTimeNs
+ */
+POSEXTERN POSCYCLES_t POSCALL posGetCycles(void);
+
+/**
+ * Timer function.
+ * Returns a monotonic time in nanoseconds since the system was started.
+ * The time is calculated from the count of timer ticks and the cycle
+ * counter value since the last tick, so the resolution is much better
+ * than one tick. The function does not lock the scheduler, it repeats
+ * the reading when the timer interrupt has updated the time meanwhile.
+ * @return  the time in nanoseconds.
+ * @note    ::POSCFG_FEATURE_HRTIME must be defined to 1 
+ *          to have this function compiled in.
+ * @sa      posGetCycles, jiffies
+ */
+POSEXTERN POSTIME_t POSCALL posGetTimeNs(void);
+
+#endif  /* POSCFG_FEATURE_HRTIME */
+
 #if (DOX!=0) || (POSCFG_FEATURE_TIMER != 0)
 
 /**
@@ -2367,6 +3417,54 @@ POSEXTERN void POSCALL posTimerDestroy(POSTIMER_t tmr);
  */
 POSEXTERN VAR_t POSCALL posTimerFired(POSTIMER_t tmr);
 #endif
+#if (DOX!=0) || (POSCFG_FEATURE_TIMERCALLBACK != 0)
+
+/** Timer callback context: The callback function is executed
+ * directly by the timer interrupt (::c_pos_timerInterrupt).
+ * @sa posTimerSetCallback
+ */
+#define POSTIMER_TICKCTX   1
+
+/** Timer callback context: The callback function is executed
+ * by the timer service task.
+ * @sa posTimerSetCallback
+ */
+#define POSTIMER_TASKCTX   2
+
+/**
+ * Timer function.
+ * Sets up a timer object that calls a function when it fires, instead
+ * of signaling a semaphore. This saves one task (and its stack) per
+ * periodic job. @n
+ * With ::POSTIMER_TICKCTX the function is executed in the timer
+ * interrupt. It must be short, and it may only call functions that are
+ * allowed in interrupt context (e.g. ::posSemaSignal, ::posFlagSet).
+ * With ::POSTIMER_TASKCTX the function is executed by the timer service
+ * task at priority ::POSCFG_TIMERTASK_PRIO. All task context callbacks
+ * share the stack of this task and are executed one after another,
+ * so they should not block for a long time.
+ * @param   tmr          handle to the timer object.
+ * @param   func         function that shall be called when the timer fires.
+ * @param   arg          argument that is passed to the function.
+ * @param   context      ::POSTIMER_TICKCTX or ::POSTIMER_TASKCTX.
+ * @param   waitticks    number of initial wait ticks.
+ * @param   periodticks  reload value for auto reload mode, or zero
+ *                       for one shot mode (see ::posTimerSet).
+ * @return  zero on success.
+ * @note    ::POSCFG_FEATURE_TIMERCALLBACK must be defined to 1
+ *          to have this function compiled in. ::POSTIMER_TASKCTX is
+ *          not available when ::POSCFG_TASKSTACKTYPE is 0.@n
+ *          A task context callback that has already been queued when the
+ *          timer fired is removed again by ::posTimerStop. A function
+ *          that is just executing is not interrupted.
+ * @sa      posTimerCreate, posTimerStart, posTimerSet
+ */
+POSEXTERN VAR_t POSCALL posTimerSetCallback(POSTIMER_t tmr,
+                                            POSTIMERFUNC_t func, void *arg,
+                                            UVAR_t context,
+                                            UINT_t waitticks,
+                                            UINT_t periodticks);
+#endif
 
 #endif  /* POSCFG_FEATURE_TIMER */
 /** @} */
@@ -2473,8 +3571,16 @@ POSEXTERN VAR_t POSCALL posSoftIntDelHandler(UVAR_t intno);
  * interrupted by a second task that also modifies the variable. Thus the
  * modification the first task has done would be lost. Atomic variables
  * prevent this possible race condition. @n@n
- * pico]OS supports four functions to operate on atomic variables:
- * ::posAtomicSet, ::posAtomicGet, ::posAtomicAdd and ::posAtomicSub.
+ * pico]OS supports these functions to operate on atomic variables:
+ * ::posAtomicSet, ::posAtomicGet, ::posAtomicAdd, ::posAtomicSub,
+ * ::posAtomicOr, ::posAtomicAnd and ::posAtomicCAS. Pointers can be
+ * accessed atomically with ::posAtomicPtrSet, ::posAtomicPtrGet and
+ * ::posAtomicPtrCAS. @n@n
+ * By default the functions lock the scheduler, that means they disable
+ * interrupts for a short time. When ::POSCFG_ATOMIC_BUILTIN is set to
+ * 1 or 2, the functions are implemented with compare-and-swap
+ * instructions and do not touch the interrupt mask. Then they can
+ * also be used to build lock-free data structures.
  * @{
  */
 /**
@@ -2524,6 +3630,92 @@ POSEXTERN INT_t POSCALL posAtomicAdd(POSATOMIC_t *var, INT_t value);
  */
 POSEXTERN INT_t POSCALL posAtomicSub(POSATOMIC_t *var, INT_t value);
 
+/**
+ * Atomic Variable Function.
+ * Sets bits in the atomic variable (bitwise OR).
+ * @param   var    pointer to the atomic variable.
+ * @param   value  bits that shall be set in the atomic variable.
+ * @return  the content of the atomic variable before it was modified.
+ * @note    ::POSCFG_FEATURE_ATOMICVAR must be defined to 1 
+ *          to have atomic variable support compiled in.
+ * @sa      posAtomicAnd, posAtomicCAS
+ */
+POSEXTERN INT_t POSCALL posAtomicOr(POSATOMIC_t *var, INT_t value);
+
+/**
+ * Atomic Variable Function.
+ * Clears bits in the atomic variable (bitwise AND).
+ * @param   var    pointer to the atomic variable.
+ * @param   value  mask that is ANDed with the atomic variable.
+ * @return  the content of the atomic variable before it was modified.
+ * @note    ::POSCFG_FEATURE_ATOMICVAR must be defined to 1 
+ *          to have atomic variable support compiled in.
+ * @sa      posAtomicOr, posAtomicCAS
+ */
+POSEXTERN INT_t POSCALL posAtomicAnd(POSATOMIC_t *var, INT_t value);
+
+/**
+ * Atomic Variable Function.
+ * Compare and swap: If the atomic variable contains the value @p oldval,
+ * it is set to @p newval. Otherwise the variable is not changed.
+ * Example of a lock-free update:
+ * @code
+ *   do {
+ *     old = posAtomicGet(&var);
+ *   } while (posAtomicCAS(&var, old, f(old)) != old);
+ * @endcode
+ * @param   var     pointer to the atomic variable.
+ * @param   oldval  value the atomic variable is expected to have.
+ * @param   newval  value that shall be stored into the variable.
+ * @return  the content of the atomic variable before the operation.
+ *          The variable was changed when the returned value
+ *          equals to @p oldval.
+ * @note    ::POSCFG_FEATURE_ATOMICVAR must be defined to 1 
+ *          to have atomic variable support compiled in.
+ * @sa      posAtomicGet, posAtomicPtrCAS
+ */
+POSEXTERN INT_t POSCALL posAtomicCAS(POSATOMIC_t *var, INT_t oldval,
+                                     INT_t newval);
+
+/**
+ * Atomic Variable Function.
+ * Sets an atomic pointer variable to the specified value.
+ * @param   var    pointer to the atomic pointer variable.
+ * @param   ptr    the new value of the pointer variable.
+ * @note    ::POSCFG_FEATURE_ATOMICVAR must be defined to 1 
+ *          to have atomic variable support compiled in.
+ * @sa      posAtomicPtrGet, posAtomicPtrCAS
+ */
+POSEXTERN void POSCALL posAtomicPtrSet(POSATOMICPTR_t *var, void *ptr);
+
+/**
+ * Atomic Variable Function.
+ * Returns the current value of an atomic pointer variable.
+ * @param   var    pointer to the atomic pointer variable.
+ * @return  the value of the pointer variable.
+ * @note    ::POSCFG_FEATURE_ATOMICVAR must be defined to 1 
+ *          to have atomic variable support compiled in.
+ * @sa      posAtomicPtrSet, posAtomicPtrCAS
+ */
+POSEXTERN void* POSCALL posAtomicPtrGet(POSATOMICPTR_t *var);
+
+/**
+ * Atomic Variable Function.
+ * Compare and swap for pointers: If the atomic pointer variable contains
+ * the value @p oldptr, it is set to @p newptr.
+ * @param   var     pointer to the atomic pointer variable.
+ * @param   oldptr  value the pointer variable is expected to have.
+ * @param   newptr  value that shall be stored into the variable.
+ * @return  the content of the pointer variable before the operation.
+ *          The variable was changed when the returned value
+ *          equals to @p oldptr.
+ * @note    ::POSCFG_FEATURE_ATOMICVAR must be defined to 1 
+ *          to have atomic variable support compiled in.
+ * @sa      posAtomicPtrGet, posAtomicCAS
+ */
+POSEXTERN void* POSCALL posAtomicPtrCAS(POSATOMICPTR_t *var, void *oldptr,
+                                        void *newptr);
+
 #endif /* POSCFG_FEATURE_ATOMICVAR */
 /** @} */
 
@@ -2561,7 +3753,11 @@ POSEXTERN INT_t POSCALL posAtomicSub(POSATOMIC_t *var, INT_t value);
  * @note    ::POSCFG_FEATURE_LISTS must be defined to 1 
  *          to have list support compiled in. @n
  *          Note that list heads must be initialized before elements
- *          can be added to the list.
+ *          can be added to the list. @n
+ *          This function can be called from an interrupt service routine.
+ *          A task that waits for the list is woken up only when the first
+ *          element arrives in the empty list; the task switch is deferred
+ *          until the interrupt exits.
  * @sa      posListGet, posListLen, posListRemove, posListJoin, posListInit
  */
 POSEXTERN void POSCALL posListAdd(POSLISTHEAD_t *listhead, UVAR_t pos,
@@ -2601,6 +3797,47 @@ POSEXTERN void POSCALL posListAdd(POSLISTHEAD_t *listhead, UVAR_t pos,
 POSEXTERN POSLIST_t* POSCALL posListGet(POSLISTHEAD_t *listhead, UVAR_t pos,
                                         UINT_t timeout);
 
+#if (DOX!=0) || (POSCFG_FEATURE_LISTGETN != 0)
+/**
+ * List Function.
+ * Takes several elements from the head of a list in one operation.
+ * The elements are appended to the tail of the destination list
+ * in their order.
+ * @param   listhead  pointer to the head of the list.
+ * @param   dest      pointer to the head of the destination list.
+ *                    This list should be private to the calling task.
+ * @param   count     maximum count of elements to take.
+ * @param   timeout   If the list is empty, the function waits for
+ *                    the first element like ::posListGet does.
+ *                    If timeout is set to zero, the function does not
+ *                    wait (poll mode).
+ * @return  the count of elements that were moved to the destination list.
+ *          Zero is returned when the list is empty (timeout == 0) or
+ *          the timeout has expired (timeout != 0).
+ * @note    ::POSCFG_FEATURE_LISTGETN must be defined to 1
+ *          to have this function compiled in. @n
+ *          The same restrictions for waiting tasks apply as for
+ *          ::posListGet.
+ * @sa      posListGetAll, posListGet, posListAdd
+ */
+POSEXTERN UINT_t POSCALL posListGetN(POSLISTHEAD_t *listhead,
+                                     POSLISTHEAD_t *dest,
+                                     UINT_t count, UINT_t timeout);
+
+/**
+ * List Macro.
+ * Takes all elements from a list in one operation.
+ * See ::posListGetN for details.
+ * @param   listhead  pointer to the head of the list.
+ * @param   dest      pointer to the head of the destination list.
+ * @param   timeout   timeout when the list is empty (see ::posListGet).
+ * @return  the count of elements that were moved to the destination list.
+ * @sa      posListGetN
+ */
+#define posListGetAll(listhead, dest, timeout) \
+          posListGetN(listhead, dest, (UINT_t)~0, timeout)
+#endif
+
 /**
  * List Function.
  * Removes an element from a list.
@@ -3151,6 +4388,34 @@ POSEXTERN UVAR_t posShift1lTab_g[8];
 #define NOS_TASKDATA
 #endif
 
+#if DOX==0
+/* Links from a task to other tasks, events and message buffers.
+ * When POSCFG_COMPACT_OBJECTS is set, the links are indices into the
+ * object tables, and the index 0 is the NULL link.
+ */
+#if POSCFG_COMPACT_OBJECTS != 0
+#if POSCFG_MAX_TASKS < 256
+typedef unsigned char   POSTASKLINK_t;
+#else
+typedef unsigned short  POSTASKLINK_t;
+#endif
+#if (POSCFG_MAX_EVENTS + SYS_MSGBOXEVENTS) < 256
+typedef unsigned char   POSEVENTLINK_t;
+#else
+typedef unsigned short  POSEVENTLINK_t;
+#endif
+#if POSCFG_MAX_MESSAGES < 256
+typedef unsigned char   POSMSGLINK_t;
+#else
+typedef unsigned short  POSMSGLINK_t;
+#endif
+#else
+typedef struct POSTASK  *POSTASKLINK_t;
+typedef void            *POSEVENTLINK_t;
+typedef void            *POSMSGLINK_t;
+#endif
+#endif /* !DOX */
+
 #if POSCFG_TASKEXIT_HOOK != 0
 typedef enum {
  texh_exitcalled,
@@ -3173,15 +4438,15 @@ struct POSTASK {
 #if POSCFG_ARGCHECK > 1
     UVAR_t      magic;
 #endif
-#if SYS_TASKDOUBLELINK != 0
-    struct POSTASK  *prev;
-#endif
-    struct POSTASK  *next;
     UVAR_t      bit_x;
 #if SYS_TASKTABSIZE_Y > 1
     UVAR_t      bit_y;
     UVAR_t      idx_y;
 #endif
+#if SYS_TASKTABSIZE_Z > 1
+    UVAR_t      bit_z;
+    UVAR_t      idx_z;
+#endif
 #ifndef POS_DEBUGHELP
     UINT_t      ticks;
 #endif
@@ -3191,17 +4456,49 @@ struct POSTASK {
 #if POSCFG_FEATURE_ERRNO != 0
     VAR_t       error;
 #endif
+#if POSCFG_FEATURE_EDF != 0
+    UVAR_t      edfqueued;
+    JIF_t       edfrelease;
+    JIF_t       edfdeadline;
+    UINT_t      edfperiod;
+    UINT_t      edfreldl;
+    UINT_t      edfmisses;
+#endif
+#if SYS_SMP != 0
+    UVAR_t      core;
+    UVAR_t      affinity;
+#endif
+#if POSCFG_FEATURE_STACKCHECK != 0
+    UVAR_t      *stkguard;
+#endif
+#if POSCFG_FEATURE_STATISTICS != 0
+    POSTASKSTATS_t  stats;
+#endif
 #if POSCFG_FEATURE_MSGBOXES != 0
     UVAR_t      msgwait;
-    POSSEMA_t   msgsem;
-    void        *firstmsg;
-    void        *lastmsg;
 #endif
 #ifdef POS_DEBUGHELP
     struct PICOTASK  deb;
+#endif
+    /* the links are kept together, so compact links are not padded */
+#if SYS_TASKDOUBLELINK != 0
+    POSTASKLINK_t   prev;
+#endif
+    POSTASKLINK_t   next;
+#if POSCFG_FEATURE_EDF != 0
+    POSTASKLINK_t   edfnext;
+    POSTASKLINK_t   edfprev;
+#endif
+#if POSCFG_FEATURE_MSGBOXES != 0
+    POSEVENTLINK_t  msgsem;
+    POSMSGLINK_t    firstmsg;
+    POSMSGLINK_t    lastmsg;
+#if POSCFG_FEATURE_MSGURGENT != 0
+    POSMSGLINK_t    lasturgent;
+#endif
 #endif
 #if SYS_TASKEVENTLINK != 0
-    void        *event;
+    POSEVENTLINK_t  event;
 #endif
 #endif /* !DOX */
 };
@@ -65,11 +65,14 @@
 #ifndef NOSCFG_FEATURE_REGISTRY
 #define NOSCFG_FEATURE_REGISTRY  0
 #endif
+#ifndef NOSCFG_FEATURE_MEMCACHE
+#define NOSCFG_FEATURE_MEMCACHE  0
+#endif
 
 #if POSCFG_TASKSTACKTYPE==0
 #define NOS_NEEDTASKEXITHOOK
 #else
-#if NOSCFG_FEATURE_REGISTRY!=0
+#if (NOSCFG_FEATURE_REGISTRY!=0) || (NOSCFG_FEATURE_MEMCACHE!=0)
 #define NOS_NEEDTASKEXITHOOK
 #endif
 #endif
@@ -83,7 +86,11 @@
 #define POSCFG_TASKEXIT_HOOK  1
 
 /* set additional task data for the nano layer */
+#if NOSCFG_FEATURE_MEMCACHE!=0
+#define NOS_TASKDATA  void *nosstkroot; void *nosmemcache;
+#else
 #define NOS_TASKDATA  void *nosstkroot;
+#endif
 
 #endif /* NOS_NEEDTASKEXITHOOK */
 
@@ -226,12 +233,95 @@
 #error NOSCFG_FEATURE_TIMER enabled, but pico]OS timer functions disabled
 #endif
 
+#ifndef NOSCFG_FEATURE_TASKPOOL
+#define NOSCFG_FEATURE_TASKPOOL  0
+#endif
+#ifndef NOSCFG_FEATURE_STREAMBUF
+#define NOSCFG_FEATURE_STREAMBUF  0
+#endif
+
+#ifndef NOSCFG_FEATURE_STATPAGE
+#define NOSCFG_FEATURE_STATPAGE  0
+#endif
+#if NOSCFG_FEATURE_STATPAGE != 0
+#if (NOSCFG_FEATURE_REGISTRY == 0) || (NOSCFG_FEATURE_REGQUERY == 0)
+#error NOSCFG_FEATURE_STATPAGE requires NOSCFG_FEATURE_REGQUERY
+#endif
+#if NOSCFG_FEATURE_TASKCREATE == 0
+#error NOSCFG_FEATURE_STATPAGE requires NOSCFG_FEATURE_TASKCREATE
+#endif
+#endif
+
 #ifndef NOSCFG_MEM_OVWR_STANDARD
 #define NOSCFG_MEM_OVWR_STANDARD  1
 #endif
 #ifndef NOSCFG_FEATURE_REALLOC
 #define NOSCFG_FEATURE_REALLOC    0
 #endif
+#ifndef NOSCFG_FEATURE_MEMSTATS
+#define NOSCFG_FEATURE_MEMSTATS   0
+#endif
+#ifndef NOSCFG_FEATURE_MEMMOVE
+#define NOSCFG_FEATURE_MEMMOVE    0
+#endif
+#ifndef NOSCFG_FEATURE_MEMCMP
+#define NOSCFG_FEATURE_MEMCMP     0
+#endif
+#if NOSCFG_FEATURE_MEMCACHE != 0
+#if NOSCFG_FEATURE_MEMALLOC == 0
+#error NOSCFG_FEATURE_MEMCACHE enabled, but NOSCFG_FEATURE_MEMALLOC disabled
+#endif
+#ifndef NOSCFG_MEMCACHE_CLASSES
+#define NOSCFG_MEMCACHE_CLASSES   4
+#endif
+#ifndef NOSCFG_MEMCACHE_MINSIZE
+#define NOSCFG_MEMCACHE_MINSIZE   16
+#endif
+#ifndef NOSCFG_MEMCACHE_BATCH
+#define NOSCFG_MEMCACHE_BATCH     4
+#endif
+#ifndef NOSCFG_MEMCACHE_MAXBLOCKS
+#define NOSCFG_MEMCACHE_MAXBLOCKS 16
+#endif
+#if NOSCFG_MEMCACHE_MAXBLOCKS < NOSCFG_MEMCACHE_BATCH
+#error NOSCFG_MEMCACHE_MAXBLOCKS must not be smaller than NOSCFG_MEMCACHE_BATCH
+#endif
+#endif
+#ifndef NOSCFG_FEATURE_STACKCACHE
+#define NOSCFG_FEATURE_STACKCACHE 0
+#endif
+#if NOSCFG_FEATURE_STACKCACHE != 0
+#if NOSCFG_FEATURE_MEMALLOC == 0
+#error NOSCFG_FEATURE_STACKCACHE enabled, but NOSCFG_FEATURE_MEMALLOC disabled
+#endif
+#if POSCFG_TASKSTACKTYPE == 2
+#error NOSCFG_FEATURE_STACKCACHE can not be used with POSCFG_TASKSTACKTYPE 2
+#endif
+#ifndef NOSCFG_STKCACHE_GRANULE
+#define NOSCFG_STKCACHE_GRANULE   128
+#endif
+#ifndef NOSCFG_STKCACHE_CLASSES
+#define NOSCFG_STKCACHE_CLASSES   8
+#endif
+#ifndef NOSCFG_STKCACHE_MAXSTACKS
+#define NOSCFG_STKCACHE_MAXSTACKS 4
+#endif
+#endif
+#ifndef NOSCFG_MEM_BYTEORDER
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__)
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define NOSCFG_MEM_BYTEORDER      1
+#endif
+#endif
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__)
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define NOSCFG_MEM_BYTEORDER      2
+#endif
+#endif
+#ifndef NOSCFG_MEM_BYTEORDER
+#define NOSCFG_MEM_BYTEORDER      0
+#endif
+#endif
 
 
 
@@ -285,8 +375,13 @@ typedef void (*NOSBHFUNC_t)(void* arg, UVAR_t bh);
  * @return  The function returns the pointer to the new memory block
  *          on success. NULL is returned when the function failed
  *          to allocate a block with the wished size.
- * @note    ::NOSCFG_FEATURE_MEMALLOC must be defined to 1 
+ * @note    ::NOSCFG_FEATURE_MEMALLOC must be defined to 1
  *          to have this function compiled in.
+ * @note    When ::NOSCFG_FEATURE_MEMCACHE is enabled, small blocks are
+ *          taken from a private cache of the calling task. The task
+ *          scheduler is then only locked when the cache needs to be
+ *          refilled from the heap. Blocks that are held in a task
+ *          cache are counted as allocated by ::nosMemStats.
  * @sa      nosMemRealloc, nosMemFree, NOSCFG_MEM_MANAGER_TYPE
  */
 NANOEXT void* POSCALL nosMemAlloc(UINT_t size);
@@ -322,6 +417,72 @@ NANOEXT void POSCALL nosMemFree(void *p);
 NANOEXT void POSCALL *nosMemRealloc(void *memblock, UINT_t size);
 #endif
 
+#if DOX!=0 || NOSCFG_FEATURE_MEMSTATS != 0
+
+/** Heap statistics.
+ * This structure is filled by the function ::nosMemStats.
+ * The fields marked with (*) are only available when the internal nano
+ * layer memory allocator is used (::NOSCFG_MEM_MANAGER_TYPE = 1),
+ * otherwise they are set to zero. All byte counts include the
+ * management overhead of the memory blocks.
+ */
+typedef struct {
+  UINT_t  heapSize;      /*!< (*) total size of the heap in bytes */
+  UINT_t  freeBytes;     /*!< (*) count of free bytes on the heap */
+  UINT_t  usedBytes;     /*!< (*) count of allocated bytes */
+  UINT_t  maxUsedBytes;  /*!< (*) high-water mark of allocated bytes */
+  UINT_t  largestFree;   /*!< (*) size of the largest free block */
+  UINT_t  freeBlocks;    /*!< (*) count of free blocks (fragments) */
+  UINT_t  usedBlocks;    /*!< count of currently allocated blocks */
+  UINT_t  maxUsedBlocks; /*!< high-water mark of allocated blocks */
+  UINT_t  allocCount;    /*!< count of successful allocations */
+  UINT_t  freeCount;     /*!< count of freed memory blocks */
+  UINT_t  failCount;     /*!< count of failed allocations */
+} NOSMEMSTATS_t;
+
+/** Name of the user registry key that holds the heap statistics.
+ * When the user registry is enabled (::NOSCFG_FEATURE_USERREG = 1),
+ * the nano layer stores a pointer to its ::NOSMEMSTATS_t structure
+ * in the registry (KEYVALUE_t.voidptr). The counters in this structure
+ * are updated with every heap operation, only the field largestFree is
+ * updated when ::nosMemStats is called.
+ * @note ::NOS_MAX_REGKEYLEN must be at least 8 to store this key.
+ */
+#define NOS_MEMSTATS_REGKEY  "memstats"
+
+/**
+ * Get heap statistics.
+ * This function returns the current state of the heap. It can be used
+ * at runtime to observe the heap usage and the heap fragmentation.
+ * @param   stats  pointer to a structure that shall be filled
+ *                 with the current heap statistics.
+ * @return  Zero on success. A negative value is returned on error.
+ * @note    ::NOSCFG_FEATURE_MEMALLOC and ::NOSCFG_FEATURE_MEMSTATS
+ *          must be defined to 1 to have this function compiled in.@n
+ *          To determine the largest free block, this function must
+ *          walk through the list of free memory blocks. The task
+ *          scheduler is locked while this is done.
+ * @sa      nosMemAlloc, nosMemFree, NOS_MEMSTATS_REGKEY
+ */
+NANOEXT VAR_t POSCALL nosMemStats(NOSMEMSTATS_t *stats);
+
+#endif /* NOSCFG_FEATURE_MEMSTATS */
+
+#if DOX!=0 || NOSCFG_FEATURE_STACKCACHE != 0
+/**
+ * Flush the stack cache.
+ * The stack cache keeps the stack memory of terminated tasks to speed
+ * up the creation of new tasks. This function gives all stacks that
+ * are currently held in the cache back to the heap.
+ * @note    ::NOSCFG_FEATURE_MEMALLOC and ::NOSCFG_FEATURE_STACKCACHE
+ *          must be defined to 1 to have this function compiled in.@n
+ *          The cache is also flushed automatically when a new stack
+ *          can not be allocated because the heap is exhausted.
+ * @sa      nosTaskCreate, NOSCFG_STKCACHE_MAXSTACKS
+ */
+NANOEXT void POSCALL nosStackCacheFlush(void);
+#endif
+
 /* overwrite standard memory allocation functions */
 #ifndef NANOINTERNAL
 #if NOSCFG_MEM_OVWR_STANDARD != 0
@@ -352,6 +513,17 @@ void    nos_free(void *mp);
 #define NOS_MEM_ALLOC(x)   NOSCFG_MEM_USER_MALLOC(x)
 #define NOS_MEM_FREE(x)    NOSCFG_MEM_USER_FREE(x)
 #endif
+/* task stack memory, used by the nano layer and by platform ports;
+   the scheduler must be locked when these macros are used */
+#if (NOSCFG_FEATURE_STACKCACHE != 0) || (NOSCFG_FEATURE_MEMSTATS != 0)
+void*   POSCALL nos_stackAlloc(UINT_t size);
+void    POSCALL nos_stackFree(void *stk);
+#define NOS_STACK_ALLOC(x) nos_stackAlloc(x)
+#define NOS_STACK_FREE(x)  nos_stackFree(x)
+#else
+#define NOS_STACK_ALLOC(x) NOS_MEM_ALLOC(x)
+#define NOS_STACK_FREE(x)  NOS_MEM_FREE(x)
+#endif
 #endif /* NANOINTERNAL */
 
 #endif /* NOSCFG_FEATURE_MEMALLOC */
@@ -391,7 +563,7 @@ NANOEXT void POSCALL nosMemSet(void *buf, char val, UINT_t count);
  * @param   count  number of bytes to copy
  * @note    ::NOSCFG_FEATURE_MEMCOPY must be defined to 1 
  *          to have this function compiled in.
- * @sa      nosMemAlloc, nosMemSet
+ * @sa      nosMemAlloc, nosMemSet, nosMemMove
  */
 NANOEXT void POSCALL nosMemCopy(void *dst, void *src, UINT_t count);
 
@@ -403,6 +575,58 @@ NANOEXT void POSCALL nosMemCopy(void *dst, void *src, UINT_t count);
 #endif
 
 #endif /* NOSCFG_FEATURE_MEMCOPY */
+
+#if DOX!=0 || NOSCFG_FEATURE_MEMMOVE != 0
+
+/**
+ * Move a block of memory.
+ * This function works like the memmove function from the
+ * C runtime library. Source and destination memory blocks may overlap.
+ * @param   dst  pointer to the destination memory block
+ * @param   src  pointer to the source memory block
+ * @param   count  number of bytes to move
+ * @note    ::NOSCFG_FEATURE_MEMMOVE must be defined to 1 
+ *          to have this function compiled in.
+ * @sa      nosMemCopy, nosMemCmp
+ */
+NANOEXT void POSCALL nosMemMove(void *dst, const void *src, UINT_t count);
+
+#if NOSCFG_MEM_OVWR_STANDARD != 0
+#ifdef memmove
+#undef memmove
+#endif
+#define memmove  nosMemMove
+#endif
+
+#endif /* NOSCFG_FEATURE_MEMMOVE */
+
+#if DOX!=0 || NOSCFG_FEATURE_MEMCMP != 0
+
+/**
+ * Compare two blocks of memory.
+ * This function works like the memcmp function from the
+ * C runtime library.
+ * @param   buf1  pointer to the first memory block
+ * @param   buf2  pointer to the second memory block
+ * @param   count  number of bytes to compare
+ * @return  zero when both blocks are equal. A negative value is returned
+ *          when the first differing byte in buf1 is less than the
+ *          byte in buf2, otherwise a positive value is returned.
+ * @note    ::NOSCFG_FEATURE_MEMCMP must be defined to 1 
+ *          to have this function compiled in.
+ * @sa      nosMemCopy, nosMemMove
+ */
+NANOEXT VAR_t POSCALL nosMemCmp(const void *buf1, const void *buf2,
+                                UINT_t count);
+
+#if NOSCFG_MEM_OVWR_STANDARD != 0
+#ifdef memcmp
+#undef memcmp
+#endif
+#define memcmp  nosMemCmp
+#endif
+
+#endif /* NOSCFG_FEATURE_MEMCMP */
 #undef NANOEXT
 /** @} */
 
@@ -798,6 +1022,282 @@ NANOEXT void POSCALL nosBottomHalfStart(UVAR_t number);
 
 
 
+/*---------------------------------------------------------------------------
+ *  TASK POOLS
+ *-------------------------------------------------------------------------*/
+
+/** @defgroup taskpool Task Pools
+ * @ingroup userapin
+ *
+ * <b> Note: This API is part of the nano layer </b>
+ *
+ * A task pool is a set of worker tasks that are created once and then
+ * execute jobs that are submitted to the pool. This avoids the cost of
+ * creating and destroying a task for every small piece of work. Jobs
+ * are executed in the order they were submitted. When a job is
+ * submitted, the caller gets a job handle. The handle can be used to
+ * wait for the completion of the job and to get the result of the job
+ * function. If the result is not needed, the handle must be released
+ * with ::nosJobRelease.
+ * @{
+ */
+
+#ifdef _N_POOL_C
+#define NANOEXT
+#else
+#define NANOEXT extern
+#endif
+
+#if DOX!=0 || NOSCFG_FEATURE_TASKPOOL != 0
+
+/** Handle to a task pool. */
+typedef struct nospool *NOSPOOL_t;
+
+/** Handle to a job that was submitted to a task pool. */
+typedef struct nosjob  *NOSJOB_t;
+
+/** Job function pointer.
+ * @param   arg   Optional argument that was passed to ::nosPoolSubmit.
+ * @return  Result of the job. It is returned by ::nosJobWait.
+ */
+typedef void* (*NOSJOBFUNC_t)(void *arg);
+
+/**
+ * Task pool function. Creates a new task pool.
+ * @param   workers     count of worker tasks to create.
+ * @param   priority    priority of the worker tasks.
+ * @param   stacksize   stack size of the worker tasks. If set to zero,
+ *                      a default stack size is assumed
+ *                      (see define ::NOSCFG_DEFAULT_STACKSIZE).
+ * @return  handle to the new task pool. NULL is returned when the
+ *          pool could not be created. If not all worker tasks can be
+ *          created, the already created workers are terminated again.
+ * @note    ::NOSCFG_FEATURE_TASKPOOL must be defined to 1
+ *          to have task pool support compiled in.
+ * @sa      nosPoolSubmit, nosPoolJoin
+ */
+NANOEXT NOSPOOL_t POSCALL nosPoolCreate(UVAR_t workers, VAR_t priority,
+                                        UINT_t stacksize);
+
+/**
+ * Task pool function. Submits a job to a task pool.
+ * The job is executed by the next free worker task of the pool.
+ * @param   pool    handle to the task pool.
+ * @param   func    pointer to the job function.
+ * @param   arg     optional argument passed to the job function.
+ * @return  handle to the job. NULL is returned when the job could not
+ *          be submitted (out of memory, or the pool is being joined).
+ * @note    ::NOSCFG_FEATURE_TASKPOOL must be defined to 1
+ *          to have task pool support compiled in. @n
+ *          The returned handle must be given back either by
+ *          ::nosJobWait or by ::nosJobRelease.
+ * @sa      nosJobWait, nosJobRelease, nosPoolCreate
+ */
+NANOEXT NOSJOB_t POSCALL nosPoolSubmit(NOSPOOL_t pool, NOSJOBFUNC_t func,
+                                       void *arg);
+
+/**
+ * Task pool function. Waits for the completion of a job.
+ * When the job is completed, the job handle is freed and
+ * the result of the job function is returned.
+ * @param   job           handle to the job.
+ * @param   timeoutticks  timeout in timer ticks
+ *                        (see ::HZ define and ::MS macro).
+ *                        If this parameter is set to zero, the function
+ *                        immediately returns. If this parameter is set to
+ *                        INFINITE, the function will never time out.
+ * @param   result        pointer to a variable that is filled with the
+ *                        result of the job function. Can be NULL.
+ * @return  zero on success. A positive value (1 or TRUE) is returned
+ *          when the timeout was reached, the job handle is still valid
+ *          then. A negative value is returned on error. -E_FORB is
+ *          returned when another task is already waiting for the job.
+ * @note    ::NOSCFG_FEATURE_TASKPOOL must be defined to 1
+ *          to have task pool support compiled in. @n
+ *          Only one task at a time may wait for a job. @n
+ *          ::POSCFG_FEATURE_SEMAWAIT must be defined to 1
+ *          to be able to wait with a timeout other than 0 and INFINITE.
+ * @sa      nosPoolSubmit, nosJobRelease
+ */
+NANOEXT VAR_t POSCALL nosJobWait(NOSJOB_t job, UINT_t timeoutticks,
+                                 void **result);
+
+/**
+ * Task pool function. Releases a job handle.
+ * Call this function when the result of a job is not needed. The job
+ * is still executed, but it is freed automatically when it is done.
+ * If another task is waiting for the job, that task frees the job.
+ * @param   job   handle to the job.
+ * @note    ::NOSCFG_FEATURE_TASKPOOL must be defined to 1
+ *          to have task pool support compiled in.
+ * @sa      nosPoolSubmit, nosJobWait
+ */
+NANOEXT void POSCALL nosJobRelease(NOSJOB_t job);
+
+/**
+ * Task pool function. Joins and destroys a task pool.
+ * No new jobs are accepted by the pool after this function was called.
+ * The function waits until all jobs that are already submitted are
+ * executed and all worker tasks have terminated. Then the pool is freed.
+ * @param   pool    handle to the task pool.
+ * @return  zero on success. A negative value is returned on error.
+ * @note    ::NOSCFG_FEATURE_TASKPOOL must be defined to 1
+ *          to have task pool support compiled in. @n
+ *          This function must not be called by a worker of the pool.
+ * @sa      nosPoolCreate
+ */
+NANOEXT VAR_t POSCALL nosPoolJoin(NOSPOOL_t pool);
+
+#endif /* NOSCFG_FEATURE_TASKPOOL */
+#undef NANOEXT
+/** @} */
+
+
+
+/*---------------------------------------------------------------------------
+ *  STREAM BUFFERS
+ *-------------------------------------------------------------------------*/
+
+/** @defgroup streambuf Stream Buffers
+ * @ingroup userapin
+ *
+ * <b> Note: This API is part of the nano layer </b>
+ *
+ * A stream buffer passes variable-length byte data from one task to
+ * another without copying it. The buffer is a ring of contiguous
+ * memory. The writer reserves space in the ring with ::nosStreamReserve,
+ * fills it in place and publishes the data with ::nosStreamCommit.
+ * The reader gets a pointer to the oldest data with ::nosStreamPeek,
+ * processes the data in place and frees the space with
+ * ::nosStreamConsume. Reserved space is never split at the end of the
+ * ring, so a packet that was committed in one piece is also peeked
+ * in one piece. Both sides can wait with a timeout: the writer for
+ * free space and the reader for new data. @n
+ * A stream buffer has one writer task and one reader task at a time.
+ * @{
+ */
+
+#ifdef _N_STRBUF_C
+#define NANOEXT
+#else
+#define NANOEXT extern
+#endif
+
+#if DOX!=0 || NOSCFG_FEATURE_STREAMBUF != 0
+
+/** Handle to a stream buffer. */
+typedef struct nosstream *NOSSTREAM_t;
+
+/**
+ * Stream buffer function. Creates a new stream buffer.
+ * The ring memory is allocated from the nano layer heap together
+ * with the buffer object.
+ * @param   size    size of the ring in bytes. This is also the largest
+ *                  space that can be reserved at once.
+ * @return  handle to the new stream buffer. NULL is returned when the
+ *          buffer could not be created.
+ * @note    ::NOSCFG_FEATURE_STREAMBUF must be defined to 1
+ *          to have stream buffer support compiled in.
+ * @sa      nosStreamDestroy, nosStreamReserve, nosStreamPeek
+ */
+NANOEXT NOSSTREAM_t POSCALL nosStreamCreate(UINT_t size);
+
+/**
+ * Stream buffer function. Destroys a stream buffer.
+ * @param   s   handle to the stream buffer.
+ * @note    ::NOSCFG_FEATURE_STREAMBUF must be defined to 1
+ *          to have stream buffer support compiled in. @n
+ *          No task may wait on the buffer or use a pointer
+ *          into the buffer when it is destroyed.
+ * @sa      nosStreamCreate
+ */
+NANOEXT void POSCALL nosStreamDestroy(NOSSTREAM_t s);
+
+/**
+ * Stream buffer function. Reserves contiguous space in the ring.
+ * The writer fills the space in place and publishes it with
+ * ::nosStreamCommit. Only one reservation can be open at a time.
+ * @param   s             handle to the stream buffer.
+ * @param   size          count of bytes to reserve.
+ * @param   buf           pointer to a variable that is filled with
+ *                        the start address of the reserved space.
+ * @param   timeoutticks  timeout in timer ticks
+ *                        (see ::HZ define and ::MS macro).
+ *                        If this parameter is set to zero, the function
+ *                        immediately returns. If this parameter is set to
+ *                        INFINITE, the function will never time out.
+ * @return  zero on success. A positive value (1 or TRUE) is returned
+ *          when the timeout was reached. A negative value is returned
+ *          on error (-E_ARG if size is larger than the ring, -E_FAIL
+ *          if a reservation is already open).
+ * @note    ::NOSCFG_FEATURE_STREAMBUF must be defined to 1
+ *          to have stream buffer support compiled in. @n
+ *          ::POSCFG_FEATURE_SEMAWAIT must be defined to 1
+ *          to be able to wait with a timeout other than 0 and INFINITE.
+ * @sa      nosStreamCommit, nosStreamPeek
+ */
+NANOEXT VAR_t POSCALL nosStreamReserve(NOSSTREAM_t s, UINT_t size,
+                                       void **buf, UINT_t timeoutticks);
+
+/**
+ * Stream buffer function. Publishes data that was written
+ * into the space reserved with ::nosStreamReserve.
+ * @param   s       handle to the stream buffer.
+ * @param   size    count of bytes written. This can be less than the
+ *                  reserved size, the rest of the space is given back.
+ *                  Zero cancels the reservation.
+ * @return  zero on success. A negative value is returned on error.
+ * @note    ::NOSCFG_FEATURE_STREAMBUF must be defined to 1
+ *          to have stream buffer support compiled in.
+ * @sa      nosStreamReserve
+ */
+NANOEXT VAR_t POSCALL nosStreamCommit(NOSSTREAM_t s, UINT_t size);
+
+/**
+ * Stream buffer function. Returns a pointer to the oldest data in
+ * the ring. The data stays in the ring until it is freed
+ * with ::nosStreamConsume.
+ * @param   s             handle to the stream buffer.
+ * @param   buf           pointer to a variable that is filled with
+ *                        the start address of the data.
+ * @param   size          pointer to a variable that is filled with the
+ *                        count of contiguous bytes available at buf.
+ * @param   timeoutticks  timeout in timer ticks
+ *                        (see ::HZ define and ::MS macro).
+ *                        If this parameter is set to zero, the function
+ *                        immediately returns. If this parameter is set to
+ *                        INFINITE, the function will never time out.
+ * @return  zero on success. A positive value (1 or TRUE) is returned
+ *          when the timeout was reached. A negative value is returned
+ *          on error.
+ * @note    ::NOSCFG_FEATURE_STREAMBUF must be defined to 1
+ *          to have stream buffer support compiled in. @n
+ *          ::POSCFG_FEATURE_SEMAWAIT must be defined to 1
+ *          to be able to wait with a timeout other than 0 and INFINITE.
+ * @sa      nosStreamConsume, nosStreamCommit
+ */
+NANOEXT VAR_t POSCALL nosStreamPeek(NOSSTREAM_t s, void **buf,
+                                    UINT_t *size, UINT_t timeoutticks);
+
+/**
+ * Stream buffer function. Frees data at the read position
+ * of the ring, so the writer can reuse the space.
+ * @param   s       handle to the stream buffer.
+ * @param   size    count of bytes to free. This must not be larger than
+ *                  the size returned by ::nosStreamPeek.
+ * @return  zero on success. A negative value is returned on error.
+ * @note    ::NOSCFG_FEATURE_STREAMBUF must be defined to 1
+ *          to have stream buffer support compiled in.
+ * @sa      nosStreamPeek
+ */
+NANOEXT VAR_t POSCALL nosStreamConsume(NOSSTREAM_t s, UINT_t size);
+
+#endif /* NOSCFG_FEATURE_STREAMBUF */
+#undef NANOEXT
+/** @} */
+
+
+
 /*---------------------------------------------------------------------------
  *  REGISTRY
  *-------------------------------------------------------------------------*/
@@ -1014,6 +1514,54 @@ NANOEXT VAR_t POSCALL nosRegQueryElem(NOSREGQHANDLE_t qh,
  * @sa nosRegQueryBegin, nosRegQueryElem
  */
 NANOEXT void POSCALL nosRegQueryEnd(NOSREGQHANDLE_t qh);
+
+#if DOX!=0 || POSCFG_FEATURE_STATISTICS != 0
+/** Object statistics, filled by ::nosRegQueryStats. The member that is
+    valid depends on the type of the registry query. */
+typedef union {
+  POSTASKSTATS_t   task;   /*!< statistics of a task (REGTYPE_TASK) */
+  POSEVENTSTATS_t  event;  /*!< statistics of a semaphore, mutex or
+                                flag event */
+} NOSOBJSTATS_t;
+
+/**
+ * Registry function. Returns the statistics counters of the object
+ * that was returned by the last call to ::nosRegQueryElem.
+ * @param   qh          Handle to the current query 
+ *                      (returnvalue of ::nosRegQueryBegin).
+ * @param   stats       Pointer to a (user provided) statistics union.
+ *                      For task queries the member task is filled,
+ *                      for semaphore, mutex and flag queries the
+ *                      member event is filled.
+ * @return  Zero on success (E_OK). A negative value denotes an error.
+ *          -E_NOTFOUND is returned when the object was deleted
+ *          meanwhile or when there are no statistics for the
+ *          object type (timers and user keys).
+ * @note    ::NOSCFG_FEATURE_REGISTRY, ::NOSCFG_FEATURE_REGQUERY and
+ *          ::POSCFG_FEATURE_STATISTICS must be defined to 1 to enable
+ *          this function.
+ * @sa nosRegQueryElem, posTaskGetStats, posEventGetStats
+ */
+NANOEXT VAR_t POSCALL nosRegQueryStats(NOSREGQHANDLE_t qh,
+                                       NOSOBJSTATS_t *stats);
+#endif
+#endif
+
+#if DOX!=0 || ((NOSCFG_FEATURE_MUTEXES != 0) && \
+     (POSCFG_FEATURE_MUTEXPROF != 0) && (NOSCFG_FEATURE_PRINTF != 0))
+/**
+ * Registry function. Prints the contention records of all mutexes
+ * that are registered by ::nosMutexCreate, sorted by the total wait
+ * time. The mutexes that limit the throughput most are printed first.
+ * For each mutex, the count of locks and blocking locks, the total and
+ * the longest wait and hold times in microseconds, and the name of the
+ * task that held the mutex for the longest time are printed.
+ * @note    ::NOSCFG_FEATURE_REGISTRY, ::NOSCFG_FEATURE_PRINTF and
+ *          ::POSCFG_FEATURE_MUTEXPROF must be defined to 1 to enable
+ *          this function.
+ * @sa posMutexGetProf, posMutexProfReset
+ */
+NANOEXT void POSCALL nosMutexProfDump(void);
 #endif
 
 #endif /* NOSCFG_FEATURE_REGISTRY */
@@ -1022,6 +1570,77 @@ NANOEXT void POSCALL nosRegQueryEnd(NOSREGQHANDLE_t qh);
 
 
 
+/*---------------------------------------------------------------------------
+ *  STATISTICS PAGE
+ *-------------------------------------------------------------------------*/
+
+/** @defgroup statpage Statistics Page
+ * @ingroup userapin
+ *
+ * <b> Note: This API is part of the nano layer </b>
+ *
+ * The statistics page is a memory region that is periodically filled
+ * with the kernel statistics by a task of low priority: task names,
+ * states and priorities, context switches, CPU time and message box
+ * depths of every task that was created with ::nosTaskCreate, and the
+ * heap usage. The page is meant to be read by another process (for
+ * example a viewer on the host, when pico]OS runs as a Linux process),
+ * so the running system can be observed without stopping it and
+ * without calling any pico]OS function. The layout of the page is
+ * defined in the file pos_stpage.h, which does not depend on the
+ * pico]OS configuration. @n
+ * The counters are collected into a private copy of the page first.
+ * Only this copy is then written to the page, guarded by the sequence
+ * counter NOSSTATPAGE_t.seq. A reader never blocks the writer.
+ * @{
+ */
+
+#ifdef _N_STPAGE_C
+#define NANOEXT
+#else
+#define NANOEXT extern
+#endif
+
+#if DOX!=0 || NOSCFG_FEATURE_STATPAGE != 0
+
+#include <pos_stpage.h>
+
+/**
+ * Statistics page function. Starts the task that updates the
+ * statistics page. The task has the registry name "statpage".
+ * @param   page          pointer to the memory of the page. If this
+ *                        parameter is NULL and ::NOSCFG_STATPAGE_SHMNAME
+ *                        is defined, the port creates a POSIX shared
+ *                        memory object with this name (the port defines
+ *                        the macro NOS_STATPAGE_MAP for this).
+ * @param   size          size of the page in bytes. The count of task
+ *                        records is derived from it
+ *                        (see ::NOSSTATPAGE_SIZE).
+ * @param   priority      priority of the update task. A low priority
+ *                        should be used, so the observation does not
+ *                        disturb the tasks that are observed.
+ * @param   periodticks   update period in timer ticks
+ *                        (see ::HZ define and ::MS macro).
+ * @return  zero on success. A negative value is returned on error.
+ *          -E_FORB is returned when the page task is already running.
+ * @note    ::NOSCFG_FEATURE_STATPAGE must be defined to 1
+ *          to have statistics page support compiled in. @n
+ *          ::POSCFG_FEATURE_STATISTICS should be enabled, otherwise
+ *          only the task names and the heap usage are available.
+ *          The CPU time of the tasks requires ::POSCFG_FEATURE_HRTIME.
+ *          The byte counts of the heap are only available with the
+ *          internal memory allocator (::NOSCFG_MEM_MANAGER_TYPE = 1).
+ * @sa      NOSSTATPAGE_t, NOSSTATTASK_t
+ */
+NANOEXT VAR_t POSCALL nosStatPageStart(void *page, UINT_t size,
+                                       VAR_t priority, UINT_t periodticks);
+
+#endif /* NOSCFG_FEATURE_STATPAGE */
+#undef NANOEXT
+/** @} */
+
+
+
 /*---------------------------------------------------------------------------
  *  CPU USAGE
  *-------------------------------------------------------------------------*/
@@ -1099,7 +1718,12 @@ typedef  POSTASK_t  NOSTASK_t;
  *          task could not be created.
  * @note    ::NOSCFG_FEATURE_TASKCREATE must be defined to 1
  *          to have this function compiled in.
- * @sa      nosTaskExit
+ * @note    When ::NOSCFG_FEATURE_STACKCACHE is enabled, the stack memory
+ *          is taken from the stack cache if a stack of the same size
+ *          class is available there. With ::POSCFG_TASKSTACKTYPE = 1
+ *          the port must allocate the stack memory with the nano layer
+ *          macro NOS_STACK_ALLOC to make use of the cache.
+ * @sa      nosTaskExit, nosStackCacheFlush
  */
 NANOEXT NOSTASK_t POSCALL nosTaskCreate(POSTASKFUNC_t funcptr,
                                         void *funcarg,
@@ -0,0 +1,129 @@
+/*
+ *  Copyright (c) 2004-2012, Dennis Kuschel.
+ *  All rights reserved. 
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. The name of the author may not be used to endorse or promote
+ *      products derived from this software without specific prior written
+ *      permission. 
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ *  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ *  INDIRECT,  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ *  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ *  OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @file    pos_stpage.h
+ * @brief   pico]OS nano layer, layout of the statistics page
+ * @author  Dennis Kuschel
+ *
+ * This file is originally from the pico]OS realtime operating system
+ * (http://picoos.sourceforge.net).
+ *
+ * This file does not depend on the pico]OS configuration. It is also
+ * included by programs that read the statistics page from outside of
+ * the pico]OS process (see ports/unix/tools/statview.c).
+ */
+
+#ifndef _POS_STPAGE_H
+#define _POS_STPAGE_H
+
+
+/** @addtogroup statpage
+ * @{
+ */
+
+/** Magic number in the header of a valid statistics page. */
+#define NOSSTATPAGE_MAGIC     0x50745350UL
+
+/** Version of the page layout. Readers must check this number. */
+#define NOSSTATPAGE_VERSION   2
+
+/** Maximum length of a task name in the page, including the 0. */
+#define NOSSTATPAGE_NAMELEN   16
+
+/** Value of a field that is not available in the configuration. */
+#define NOSSTATPAGE_NA        (~0UL)
+
+/** Task state in the page: The task is running on a core. */
+#define NOSSTATTASK_RUNNING   1
+/** Task state in the page: The task is ready to run. */
+#define NOSSTATTASK_READY     2
+/** Task state in the page: The task sleeps or waits for an event. */
+#define NOSSTATTASK_BLOCKED   3
+/** Task state in the page: The task waits for a message. */
+#define NOSSTATTASK_WAITMSG   4
+
+/** Task record in the statistics page. */
+typedef struct {
+  unsigned long  handle;    /*!< task handle, identifies the task */
+  long           priority;  /*!< priority of the task, or -1 */
+  unsigned long  state;     /*!< task state (::NOSSTATTASK_RUNNING ...),
+                                 only available with
+                                 POSCFG_FEATURE_STATISTICS */
+  unsigned long  switches;  /*!< count of context switches to the task */
+  unsigned long  wakeups;   /*!< count of wakeups by a signalled event */
+  unsigned long  timeouts;  /*!< count of waits that ended by timeout */
+  unsigned long  msgcount;  /*!< messages waiting in the message box */
+  unsigned long  msgmax;    /*!< highest count of waiting messages */
+  unsigned long long cputime; /*!< time the task has run in microseconds,
+                                 only available with POSCFG_FEATURE_HRTIME,
+                                 else NOSSTATPAGE_NA */
+  char           name[NOSSTATPAGE_NAMELEN]; /*!< registry name */
+} NOSSTATTASK_t;
+
+/** Statistics page.
+ * The page is written by the statistics page task of the nano layer.
+ * A reader must not lock anything, it uses the sequence counter instead:
+ * The counter is odd while the page is written. A reader copies the
+ * page when the counter is even and accepts the copy when the counter
+ * has not changed meanwhile. All counters that are not available in
+ * the configuration are set to ::NOSSTATPAGE_NA.
+ */
+typedef struct {
+  volatile unsigned long seq; /*!< sequence counter, odd while writing */
+  unsigned long  magic;     /*!< ::NOSSTATPAGE_MAGIC */
+  unsigned long  version;   /*!< ::NOSSTATPAGE_VERSION */
+  unsigned long  pagesize;  /*!< size of the page in bytes */
+  unsigned long  maxtasks;  /*!< count of task records in the page */
+  unsigned long  updates;   /*!< count of page updates */
+  unsigned long  hz;        /*!< timer ticks per second */
+  unsigned long  jiffies;   /*!< timer ticks since system start */
+  unsigned long  cpuusage;  /*!< CPU usage in percent */
+  unsigned long  switches;  /*!< total count of context switches */
+  unsigned long  allocfail; /*!< count of failed object allocations */
+  unsigned long  heapsize;  /*!< total size of the heap */
+  unsigned long  heapused;  /*!< allocated bytes on the heap */
+  unsigned long  heapmaxused; /*!< high-water mark of allocated bytes */
+  unsigned long  heaplargest; /*!< largest free block on the heap */
+  unsigned long  heapblocks;  /*!< count of allocated blocks */
+  unsigned long  heapfail;  /*!< count of failed allocations */
+  unsigned long  tasks;     /*!< count of valid task records */
+  NOSSTATTASK_t  task[1];   /*!< task records, maxtasks entries */
+} NOSSTATPAGE_t;
+
+/** Size of a statistics page with space for a number of task records. */
+#define NOSSTATPAGE_SIZE(maxtasks) \
+  (sizeof(NOSSTATPAGE_t) + ((maxtasks) - 1) * sizeof(NOSSTATTASK_t))
+
+/** @} */
+
+#endif /* _POS_STPAGE_H */
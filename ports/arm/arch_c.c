@@ -79,19 +79,22 @@ VAR_t p_pos_initTask(POSTASK_t task,
                       
   unsigned int   z;
 
-  task->stackstart = NOS_MEM_ALLOC(stacksize);
+  task->stackstart = NOS_STACK_ALLOC(stacksize);
   if (task->stackstart == NULL)
     return -1;
 
   z = (unsigned int)task->stackstart + stacksize - 4;
   constructStackFrame(task, (void*)z, funcptr, funcarg);
+#if POSCFG_FEATURE_STACKCHECK != 0
+  c_pos_setStackGuard(task, task->stackstart);
+#endif
   return 0;
 }
 
 
 void  p_pos_freeStack(POSTASK_t task)
 {
-  NOS_MEM_FREE(task->stackstart);
+  NOS_STACK_FREE(task->stackstart);
 }
 
 
@@ -106,6 +109,9 @@ VAR_t p_pos_initTask(POSTASK_t task,
 
   z = (unsigned int)task->stack + FIXED_STACK_SIZE - 4;
   constructStackFrame(task, (void*)z, funcptr, funcarg);
+#if POSCFG_FEATURE_STACKCHECK != 0
+  c_pos_setStackGuard(task, task->stack);
+#endif
   return 0;
 }
 
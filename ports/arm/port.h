@@ -137,6 +137,17 @@
  */
 #define POSCFG_TASKSTACKTYPE     1
 
+/** Stack overflow detection support.
+ * ::p_pos_initTask places the stack guard words with
+ * ::c_pos_setStackGuard when the stack memory is allocated by the
+ * port (type 1 and 2). The kernel can only be built with
+ * ::POSCFG_FEATURE_STACKCHECK enabled when the port sets this
+ * define to 1.
+ */
+#if POSCFG_TASKSTACKTYPE != 0
+#define POSCFG_PORT_STACKGUARD   1
+#endif
+
 /** Enable call to function ::p_pos_initArch.
  * When this define is set to 1, the operating system will call
  * the user supplied function ::p_pos_initArch to initialize
@@ -208,7 +208,7 @@ VAR_t p_pos_initTask(POSTASK_t task, UINT_t stacksize, POSTASKFUNC_t funcptr, vo
 
   unsigned int z;
 
-  task->stack = NOS_MEM_ALLOC(stacksize);
+  task->stack = NOS_STACK_ALLOC(stacksize);
   if (task->stack == NULL)
   return -1;
 
@@ -218,12 +218,15 @@ VAR_t p_pos_initTask(POSTASK_t task, UINT_t stacksize, POSTASKFUNC_t funcptr, vo
 
   z = (unsigned int) task->stack + stacksize - 2;
   constructStackFrame(task, (void*) z, funcptr, funcarg);
+#if POSCFG_FEATURE_STACKCHECK != 0
+  c_pos_setStackGuard(task, task->stack);
+#endif
   return 0;
 }
 
 void p_pos_freeStack(POSTASK_t task)
 {
-  NOS_MEM_FREE(task->stack);
+  NOS_STACK_FREE(task->stack);
 }
 
 #elif (POSCFG_TASKSTACKTYPE == 2)
@@ -243,6 +246,9 @@ VAR_t p_pos_initTask(POSTASK_t task,
 #endif
   z = (unsigned int)task->stack + PORTCFG_FIXED_STACK_SIZE - 2;
   constructStackFrame(task, (void*)z, funcptr, funcarg);
+#if POSCFG_FEATURE_STACKCHECK != 0
+  c_pos_setStackGuard(task, task->stack);
+#endif
   return 0;
 }
 
@@ -267,6 +273,16 @@ void p_pos_initArch(void)
 
   //  portInitBoard();
 
+#if POSCFG_FEATURE_HRTIME != 0
+#if __CORTEX_M >= 3
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#else
+#error "POSCFG_FEATURE_HRTIME needs the DWT cycle counter (Cortex-M3 or higher)"
+#endif
+#endif
+
   SysTick_Config(SystemCoreClock / HZ);
 
   NVIC_SetPriority(SVCall_IRQn, PORT_SVCALL_PRI);
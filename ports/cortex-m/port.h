@@ -143,6 +143,14 @@
 #define POSCFG_TASKSTACKTYPE     2
 #endif
 
+/** Stack overflow detection support.
+ * This define is set to 1 because ::p_pos_initTask places the stack
+ * guard words with ::c_pos_setStackGuard. The kernel can only be built
+ * with ::POSCFG_FEATURE_STACKCHECK enabled when the port sets this
+ * define to 1.
+ */
+#define POSCFG_PORT_STACKGUARD   1
+
 /** Enable call to function ::p_pos_initArch.
  * When this define is set to 1, the operating system will call
  * the user supplied function ::p_pos_initArch to initialize
@@ -245,16 +253,19 @@
  * can contain a subroutine call or a piece of assembler
  * code that stores the processor state and disables
  * the interrupts. See ::POSCFG_LOCK_FLAGSTYPE for more details.
+ * The macros are defined with the suffix _RAW, pico]OS derives
+ * ::POS_SCHED_LOCK from them and adds the lock profiler
+ * when ::POSCFG_FEATURE_LOCKPROF is enabled.
  */
 
 #if __CORTEX_M >= 3
 
-#define POS_SCHED_LOCK          { flags = __get_BASEPRI(); __set_BASEPRI(portCmsisPrio2HW(PORT_SVCALL_PRI + 1)); }
-#define POS_IRQ_DISABLE_ALL     { flags = __get_PRIMASK(); __disable_irq(); }
+#define POS_SCHED_LOCK_RAW      { flags = __get_BASEPRI(); __set_BASEPRI(portCmsisPrio2HW(PORT_SVCALL_PRI + 1)); }
+#define POS_IRQ_DISABLE_ALL_RAW { flags = __get_PRIMASK(); __disable_irq(); }
 
 #else
 
-#define POS_SCHED_LOCK          { flags = __get_PRIMASK(); __disable_irq(); }
+#define POS_SCHED_LOCK_RAW      { flags = __get_PRIMASK(); __disable_irq(); }
 
 #endif
 
@@ -265,12 +276,12 @@
 
 #if __CORTEX_M >= 3
 
-#define POS_SCHED_UNLOCK        { __set_BASEPRI(flags); }
-#define POS_IRQ_ENABLE_ALL      { if (!flags) __enable_irq(); }
+#define POS_SCHED_UNLOCK_RAW    { __set_BASEPRI(flags); }
+#define POS_IRQ_ENABLE_ALL_RAW  { if (!flags) __enable_irq(); }
 
 #else
 
-#define POS_SCHED_UNLOCK        { if (!flags) __enable_irq(); }
+#define POS_SCHED_UNLOCK_RAW    { if (!flags) __enable_irq(); }
 
 #endif
 
@@ -278,6 +289,29 @@
 
 
 
+/*---------------------------------------------------------------------------
+ *  HIGH RESOLUTION TIME
+ *-------------------------------------------------------------------------*/
+
+#if __CORTEX_M >= 3
+
+/** Cycle counter type. The DWT cycle counter has 32 bits.
+ */
+#define MCYC_t                  int
+
+/** Read the cycle counter. The DWT cycle counter is enabled
+ * by ::p_pos_initArch when ::POSCFG_FEATURE_HRTIME is set to 1.
+ */
+#define POS_CYCLES()            (DWT->CYCCNT)
+
+/** Frequency of the cycle counter, equal to the CPU clock.
+ */
+#define POS_CYCLES_HZ           SystemCoreClock
+
+#endif
+
+
+
 /*---------------------------------------------------------------------------
  *  FINDBIT - DEFINITIONS FOR GENERIC FILE fbit_gen.c
  *-------------------------------------------------------------------------*/
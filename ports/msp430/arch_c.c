@@ -152,7 +152,7 @@ VAR_t p_pos_initTask(POSTASK_t task, UINT_t stacksize, POSTASKFUNC_t funcptr, vo
 
   unsigned int z;
 
-  task->stack = NOS_MEM_ALLOC(stacksize);
+  task->stack = NOS_STACK_ALLOC(stacksize);
   if (task->stack == NULL)
     return -1;
 
@@ -162,12 +162,15 @@ VAR_t p_pos_initTask(POSTASK_t task, UINT_t stacksize, POSTASKFUNC_t funcptr, vo
 
   z = (unsigned int) task->stack + stacksize - 2;
   constructStackFrame(task, (void*) z, funcptr, funcarg);
+#if POSCFG_FEATURE_STACKCHECK != 0
+  c_pos_setStackGuard(task, task->stack);
+#endif
   return 0;
 }
 
 void p_pos_freeStack(POSTASK_t task)
 {
-  NOS_MEM_FREE(task->stack);
+  NOS_STACK_FREE(task->stack);
 }
 
 #elif (POSCFG_TASKSTACKTYPE == 2)
@@ -187,6 +190,9 @@ VAR_t p_pos_initTask(POSTASK_t task,
 #endif
   z = (unsigned int)task->stack + PORTCFG_FIXED_STACK_SIZE - 2;
   constructStackFrame(task, (void*)z, funcptr, funcarg);
+#if POSCFG_FEATURE_STACKCHECK != 0
+  c_pos_setStackGuard(task, task->stack);
+#endif
   return 0;
 }
 
@@ -143,6 +143,14 @@
 #define POSCFG_TASKSTACKTYPE    2
 #endif
 
+/** Stack overflow detection support.
+ * This define is set to 1 because ::p_pos_initTask places the stack
+ * guard words with ::c_pos_setStackGuard. The kernel can only be built
+ * with ::POSCFG_FEATURE_STACKCHECK enabled when the port sets this
+ * define to 1.
+ */
+#define POSCFG_PORT_STACKGUARD  1
+
 /** Enable call to function ::p_pos_initArch.
  * When this define is set to 1, the operating system will call
  * the user supplied function ::p_pos_initArch to initialize
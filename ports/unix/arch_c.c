@@ -0,0 +1,472 @@
+/*
+ *  Copyright (c) 2004-2012, Dennis Kuschel.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. The name of the author may not be used to endorse or promote
+ *      products derived from this software without specific prior written
+ *      permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ *  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ *  INDIRECT,  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ *  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ *  OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @file    arch_c.c
+ * @brief   pico]OS Unix / Linux host port
+ * @author  Dennis Kuschel
+ *
+ * This file is originally from the pico]OS realtime operating system
+ * (http://picoos.sourceforge.net).
+ *
+ * CVS-ID $Id: arch_c.c,v 1.1 2012/06/02 10:12:40 dkuschel Exp $
+ */
+
+/*  Note on the implementation:
+ *
+ *  Every task has its own ucontext and stack, a context switch is done
+ *  with swapcontext(). The interrupts of the port are Unix signals:
+ *  A timer thread sends SIGALRM to every core with the rate HZ, and
+ *  in SMP mode SIGUSR2 is the inter-processor interrupt. Disabling
+ *  interrupts means blocking these signals in the calling thread.
+ *
+ *  When POSCFG_SMP_CORES is greater than 1, every core is a POSIX
+ *  thread. The main thread is core 0, it calls posInit and starts the
+ *  other cores. Tasks may migrate between the threads, so the kernel
+ *  lock is additionally protected by a spinlock.
+ *
+ *  Tasks should not call the buffered stdio functions of the host
+ *  C library, because a task may be preempted or migrated while it
+ *  holds a stdio lock. Use the nano layer console output instead,
+ *  p_putchar writes directly to the file descriptor 1.
+ */
+
+#define _GNU_SOURCE
+#include <ucontext.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#define NANOINTERNAL
+#include <picoos.h>
+
+
+#define SIG_TIMER   SIGALRM
+#define SIG_IPI     SIGUSR2
+
+/* writable current task variable of the calling core */
+#if SYS_SMP != 0
+#define CURRENTTASK  posCoreCurrentTask_g[POS_CPUID]
+#else
+#define CURRENTTASK  posCurrentTask_g
+#endif
+
+#if POSCFG_ENABLE_NANO
+#define PORT_STACK_ALLOC(x)  NOS_STACK_ALLOC(x)
+#define PORT_STACK_FREE(x)   NOS_STACK_FREE(x)
+#else
+#define PORT_STACK_ALLOC(x)  malloc((size_t)(x))
+#define PORT_STACK_FREE(x)   free(x)
+#endif
+
+/* Memory block of a task: the context, followed by the stack.
+ * The link is used to queue the block for freeing when the task exits.
+ */
+typedef struct TASKMEM {
+  struct TASKMEM  *next;
+  POSTASKFUNC_t   func;
+  void            *arg;
+  ucontext_t      ctx;
+} TASKMEM_t;
+
+#define TASKMEM(task)  ((TASKMEM_t*)((task)->portmem))
+
+/* size of the TASKMEM_t header, rounded up to keep the stack aligned */
+#define TASKMEM_SIZE   ((sizeof(TASKMEM_t) + 15) & ~(size_t)15)
+
+/* minimum stack size of a task */
+#define MIN_STACKSIZE  16384
+
+
+static sigset_t       intsigs_g;
+static TASKMEM_t     *zombies_g;
+static volatile int   started_g;
+static pthread_t      core_g[POSCFG_SMP_CORES];
+#if SYS_SMP != 0
+static pthread_key_t  corekey_g;
+#endif
+
+
+/* local functions */
+static void a_interrupt(int sig);
+static void a_taskEntry(void);
+#if POSCFG_FEATURE_VIRTUALTIME == 0
+static void* a_timerThread(void *arg);
+#endif
+#if SYS_SMP != 0
+static void* a_coreThread(void *arg);
+#endif
+
+
+
+/*---------------------------------------------------------------------------
+ *  ASSERTIONS
+ *-------------------------------------------------------------------------*/
+
+void p_pos_assert(const char* text, const char *file, int line)
+{
+  fprintf(stderr, "\n\n-----------\nPOS ASSERTION FAILED:\n"
+                  "  %s\n  file %s, line %i\n-----------\n\n",
+          text, file, line);
+  fflush(stderr);
+  abort();
+}
+
+
+
+/*---------------------------------------------------------------------------
+ *  INTERRUPT LOCKING
+ *-------------------------------------------------------------------------*/
+
+void p_pos_globalLock(sigset_t *flags)
+{
+  pthread_sigmask(SIG_BLOCK, &intsigs_g, flags);
+#if SYS_SMP != 0
+  while (__sync_lock_test_and_set(&posKernelLock_g, 1) != 0)
+  {
+    while (posKernelLock_g != 0)
+      sched_yield();
+  }
+#endif
+}
+
+
+void p_pos_globalUnlock(sigset_t *flags)
+{
+#if SYS_SMP != 0
+  __sync_lock_release(&posKernelLock_g);
+#endif
+  pthread_sigmask(SIG_SETMASK, flags, NULL);
+}
+
+
+
+/*---------------------------------------------------------------------------
+ *  INTERRUPTS
+ *-------------------------------------------------------------------------*/
+
+static void a_interrupt(int sig)
+{
+#if (POSCFG_ENABLE_NANO != 0) && (NOSCFG_FEATURE_CONIN != 0)
+  struct pollfd pfd;
+  char c;
+#endif
+
+  c_pos_intEnter();
+  if (sig == SIG_TIMER)
+  {
+#if (POSCFG_ENABLE_NANO != 0) && (NOSCFG_FEATURE_CONIN != 0)
+    if (pthread_equal(pthread_self(), core_g[0]))
+    {
+      pfd.fd = 0;
+      pfd.events = POLLIN;
+      while ((poll(&pfd, 1, 0) > 0) && ((pfd.revents & POLLIN) != 0) &&
+             (read(0, &c, 1) == 1))
+      {
+        c_nos_keyinput((UVAR_t)(unsigned char) c);
+      }
+    }
+#endif
+    c_pos_timerInterrupt();
+  }
+  c_pos_intExit();
+}
+
+
+#if POSCFG_FEATURE_VIRTUALTIME == 0
+
+/* The timer thread sends the timer interrupt to all cores.
+ * It sleeps until absolute points in time, so the tick does not drift.
+ * In virtual time mode the idle task drives the timer instead.
+ */
+static void* a_timerThread(void *arg)
+{
+  struct timespec t;
+  UVAR_t c;
+
+  (void) arg;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  for (;;)
+  {
+    t.tv_nsec += 1000000000L / HZ;
+    while (t.tv_nsec >= 1000000000L)
+    {
+      t.tv_nsec -= 1000000000L;
+      t.tv_sec++;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) != 0);
+    for (c = 0; c < POSCFG_SMP_CORES; ++c)
+      pthread_kill(core_g[c], SIG_TIMER);
+  }
+  return NULL;
+}
+
+#endif /* POSCFG_FEATURE_VIRTUALTIME */
+
+
+#if POSCFG_FEATURE_HRTIME != 0
+
+POSCYCLES_t p_pos_cycles(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return ((POSCYCLES_t) t.tv_sec * 1000000000UL) + (POSCYCLES_t) t.tv_nsec;
+}
+
+#endif
+
+
+
+/*---------------------------------------------------------------------------
+ *  SMP SUPPORT
+ *-------------------------------------------------------------------------*/
+
+#if SYS_SMP != 0
+
+UVAR_t p_pos_cpuId(void)
+{
+  return (UVAR_t)(MPTR_t) pthread_getspecific(corekey_g);
+}
+
+
+void p_pos_ipiReschedule(UVAR_t core)
+{
+  pthread_kill(core_g[core], SIG_IPI);
+}
+
+
+static void* a_coreThread(void *arg)
+{
+  pthread_setspecific(corekey_g, arg);
+  c_pos_coreStart();
+  return NULL;
+}
+
+#endif /* SYS_SMP */
+
+
+
+/*---------------------------------------------------------------------------
+ *  INIT AND TASK CONTEXT FUNCTIONS
+ *-------------------------------------------------------------------------*/
+
+void p_pos_initArch(void)
+{
+  struct sigaction sa;
+
+  sigemptyset(&intsigs_g);
+  sigaddset(&intsigs_g, SIG_TIMER);
+  sigaddset(&intsigs_g, SIG_IPI);
+
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = a_interrupt;
+  sa.sa_mask    = intsigs_g;
+  sa.sa_flags   = SA_RESTART;
+  sigaction(SIG_TIMER, &sa, NULL);
+  sigaction(SIG_IPI, &sa, NULL);
+
+#if SYS_SMP != 0
+  pthread_key_create(&corekey_g, NULL);
+  pthread_setspecific(corekey_g, NULL);
+#endif
+  core_g[0] = pthread_self();
+}
+
+
+/* First function of every task. The task is entered with the
+ * kernel lock held, like a task that returns from a context switch.
+ */
+static void a_taskEntry(void)
+{
+  TASKMEM_t *tm = TASKMEM(posCurrentTask_g);
+  sigset_t flags;
+
+  pthread_sigmask(SIG_SETMASK, NULL, &flags);
+  sigdelset(&flags, SIG_TIMER);
+  sigdelset(&flags, SIG_IPI);
+  POS_SCHED_UNLOCK;
+
+  (tm->func)(tm->arg);
+  posTaskExit();
+}
+
+
+VAR_t p_pos_initTask(POSTASK_t task, UINT_t stacksize,
+                     POSTASKFUNC_t funcptr, void *funcarg)
+{
+  TASKMEM_t *tm;
+
+  /* Free the memory of exited tasks. The kernel lock is held, so all
+     exited tasks have already switched away from their stacks. */
+  while (zombies_g != NULL)
+  {
+    tm = zombies_g;
+    zombies_g = tm->next;
+    PORT_STACK_FREE(tm);
+  }
+
+  if (stacksize < MIN_STACKSIZE)
+    stacksize = MIN_STACKSIZE;
+  tm = (TASKMEM_t*) PORT_STACK_ALLOC(TASKMEM_SIZE + stacksize);
+  if (tm == NULL)
+    return -1;
+
+  tm->func = funcptr;
+  tm->arg  = funcarg;
+  getcontext(&tm->ctx);
+  tm->ctx.uc_stack.ss_sp   = (char*)tm + TASKMEM_SIZE;
+  tm->ctx.uc_stack.ss_size = stacksize;
+  tm->ctx.uc_link = NULL;
+  tm->ctx.uc_sigmask = intsigs_g;
+  makecontext(&tm->ctx, a_taskEntry, 0);
+  task->portmem = tm;
+#if POSCFG_FEATURE_STACKCHECK != 0
+  c_pos_setStackGuard(task, (char*)tm + TASKMEM_SIZE);
+#endif
+  return 0;
+}
+
+
+void p_pos_freeStack(POSTASK_t task)
+{
+  /* The task still runs on this stack until it has switched away,
+     so the memory is freed later by p_pos_initTask. */
+  TASKMEM(task)->next = zombies_g;
+  zombies_g = TASKMEM(task);
+}
+
+
+void p_pos_softContextSwitch(void)
+{
+  POSTASK_t oldtask = CURRENTTASK;
+  POSTASK_t newtask = posNextTask_g;
+
+  CURRENTTASK = newtask;
+  swapcontext(&TASKMEM(oldtask)->ctx, &TASKMEM(newtask)->ctx);
+}
+
+
+void p_pos_intContextSwitch(void)
+{
+  p_pos_softContextSwitch();
+}
+
+
+void p_pos_startFirstContext(void)
+{
+#if POSCFG_FEATURE_VIRTUALTIME == 0
+  pthread_t t;
+#endif
+#if SYS_SMP != 0
+  UVAR_t c;
+#endif
+
+  if (!started_g)
+  {
+    /* Called on core 0 by posInit. The signals are blocked,
+       and the new threads inherit the signal mask. */
+    started_g = 1;
+#if SYS_SMP != 0
+    for (c = 1; c < POSCFG_SMP_CORES; ++c)
+    {
+      if (pthread_create(&core_g[c], NULL, a_coreThread,
+                         (void*)(MPTR_t) c) != 0)
+      {
+        p_pos_assert("p_pos_startFirstContext: create core thread",
+                     __FILE__, __LINE__);
+      }
+    }
+#endif
+#if POSCFG_FEATURE_VIRTUALTIME == 0
+    if (pthread_create(&t, NULL, a_timerThread, NULL) != 0)
+    {
+      p_pos_assert("p_pos_startFirstContext: create timer thread",
+                   __FILE__, __LINE__);
+    }
+#endif
+  }
+  setcontext(&TASKMEM(posCurrentTask_g)->ctx);
+}
+
+
+void p_pos_idleTaskHook(void)
+{
+  /* wait for the next interrupt */
+  pause();
+}
+
+
+
+/*---------------------------------------------------------------------------
+ *  NANO LAYER INTERFACE FUNCTIONS
+ *-------------------------------------------------------------------------*/
+
+#if POSCFG_ENABLE_NANO
+
+UVAR_t p_putchar(char c)
+{
+  return (write(1, &c, 1) == 1) ? 1 : 0;
+}
+
+/*-------------------------------------------------------------------------*/
+
+#if (NOSCFG_FEATURE_STATPAGE != 0) && defined(NOSCFG_STATPAGE_SHMNAME)
+
+void* p_nos_statPageMap(const char *name, unsigned long size)
+{
+  void *page;
+  int fd;
+
+  fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+  if (fd < 0)
+    return NULL;
+  if (ftruncate(fd, (off_t) size) != 0)
+  {
+    close(fd);
+    return NULL;
+  }
+  page = mmap(NULL, (size_t) size, PROT_READ | PROT_WRITE,
+              MAP_SHARED, fd, 0);
+  close(fd);
+  return (page == MAP_FAILED) ? NULL : page;
+}
+
+#endif /* NOSCFG_FEATURE_STATPAGE */
+
+#endif /* POSCFG_ENABLE_NANO */
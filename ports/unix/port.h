@@ -0,0 +1,265 @@
+/*
+ *  Copyright (c) 2004-2012, Dennis Kuschel.
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. The name of the author may not be used to endorse or promote
+ *      products derived from this software without specific prior written
+ *      permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ *  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ *  INDIRECT,  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ *  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ *  OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @file    port.h
+ * @brief   port configuration file for the Unix / Linux host port
+ * @author  Dennis Kuschel
+ *
+ * This file is originally from the pico]OS realtime operating system
+ * (http://picoos.sourceforge.net).
+ *
+ * CVS-ID $Id: port.h,v 1.1 2012/06/02 10:12:40 dkuschel Exp $
+ */
+
+
+#ifndef _PORT_H
+#define _PORT_H
+
+#include <signal.h>
+
+
+/*---------------------------------------------------------------------------
+ *-------------------------------------------------------------------------*/
+
+/** @defgroup arch Architecture / CPU Specific Settings
+ * @ingroup configp
+ * @{
+ */
+
+/** Machine variable type. See the x86w32 port for a detailed description.
+ * On 64 bit hosts the machine variable has the width of a pointer.
+ */
+#ifdef __LP64__
+#define MVAR_t                   long
+#else
+#define MVAR_t                   int
+#endif
+
+/** Machine variable width.
+ */
+#ifdef __LP64__
+#define MVAR_BITS                64  /* = (sizeof(MVAR_t) * 8) */
+#else
+#define MVAR_BITS                32  /* = (sizeof(MVAR_t) * 8) */
+#endif
+
+/** Integer variable type used for memory pointers.
+ * @e long has the width of a pointer on all ILP32 and LP64 hosts.
+ */
+#define MPTR_t                   long
+
+/** Required memory alignment on the target CPU.
+ */
+#define POSCFG_ALIGNMENT         8
+
+/** Interruptable interrupt service routines.
+ * The signal handlers of this port run with the kernel lock released,
+ * and SMP mode requires this define to be set to 1.
+ */
+#define POSCFG_ISR_INTERRUPTABLE 1
+
+/** Set the mechanism of stack memory handling.
+ * The stack memory is allocated by the port (type 1).
+ */
+#define POSCFG_TASKSTACKTYPE     1
+
+/** Stack overflow detection support.
+ * This define is set to 1 because ::p_pos_initTask places the stack
+ * guard words with ::c_pos_setStackGuard. The kernel can only be built
+ * with ::POSCFG_FEATURE_STACKCHECK enabled when the port sets this
+ * define to 1.
+ */
+#define POSCFG_PORT_STACKGUARD   1
+
+/** Enable call to function ::p_pos_initArch.
+ */
+#define POSCFG_CALLINITARCH      1
+
+/** Enable dynamic memory.
+ */
+#define POSCFG_DYNAMIC_MEMORY    0
+
+/** Dynamic memory management.
+ */
+#define POSCFG_DYNAMIC_REFILL    0
+
+/** Define optional memory allocation function.
+ */
+#define POS_MEM_ALLOC(bytes)     nosMemAlloc(bytes)
+
+/** @} */
+
+
+
+/*---------------------------------------------------------------------------
+ *-------------------------------------------------------------------------*/
+
+/** @defgroup lock Disable / Enable Interrupts
+ * @ingroup configp
+ * The interrupts of this port are the Unix signals SIGALRM (timer)
+ * and SIGUSR2 (inter-processor interrupt in SMP mode). The scheduler
+ * is locked by blocking these signals in the calling thread. In SMP
+ * mode the calling thread also acquires the spinlock ::posKernelLock_g.
+ * The flags variable holds the signal mask of the thread before
+ * the lock was taken.
+ * @{
+ */
+
+/** Enable local flags variable.
+ */
+#define POSCFG_LOCK_USEFLAGS     1
+
+/** Define variable type for the processor flags.
+ */
+#define POSCFG_LOCK_FLAGSTYPE    sigset_t
+
+/** Scheduler locking.
+ */
+extern void p_pos_globalLock(sigset_t *flags);
+#define POS_SCHED_LOCK           p_pos_globalLock(&flags)
+
+/** Scheduler unlocking.
+ */
+extern void p_pos_globalUnlock(sigset_t *flags);
+#define POS_SCHED_UNLOCK         p_pos_globalUnlock(&flags)
+
+/** @} */
+
+
+
+/*---------------------------------------------------------------------------
+ *-------------------------------------------------------------------------*/
+
+/** @defgroup findbit Generic Findbit
+ * @ingroup configp
+ * @{
+ */
+
+/** Generic finbit configuration, look-up table support.
+ */
+#define POSCFG_FBIT_USE_LUTABLE      0
+
+/** Generic finbit configuration, machine bit-shift ability.
+ */
+#define POSCFG_FBIT_BITSHIFT         1
+
+/** @} */
+
+
+
+/*---------------------------------------------------------------------------
+ *-------------------------------------------------------------------------*/
+
+/** @defgroup hrtime High Resolution Time
+ * @ingroup configp
+ * The cycle counter of this port is the monotonic clock of the host,
+ * counted in nanoseconds.
+ * @{
+ */
+
+/** Cycle counter type, 64 bits to not wrap around.
+ */
+#define MCYC_t                   long long
+
+/** Frequency of the cycle counter.
+ */
+#define POS_CYCLES_HZ            1000000000L
+
+/** @} */
+
+
+
+/*---------------------------------------------------------------------------
+ *  PORT DEPENDENT NANO LAYER CONFIGURATION
+ *-------------------------------------------------------------------------*/
+
+/** @defgroup portnlcfg Nano Layer Port
+ * @ingroup configp
+ * This section is used to configure port dependent
+ * settings for the nano layer. (file port.h)
+ * @{
+ */
+
+/** Set the direction the stack grows.
+ */
+#define NOSCFG_STACK_GROWS_UP        0
+
+/** Set the default stack size.
+ * The host C library needs much more stack than an embedded target.
+ */
+#define NOSCFG_DEFAULT_STACKSIZE     65536
+
+/** Enable generic console output handshake.
+ */
+#define NOSCFG_CONOUT_HANDSHAKE      0
+
+/** Set the size of the console output FIFO.
+ */
+#define NOSCFG_CONOUT_FIFOSIZE       256
+
+/** @} */
+
+
+
+/*---------------------------------------------------------------------------
+ *  USER DEFINED CONTENT OF TASK ENVIRONMENT
+ *-------------------------------------------------------------------------*/
+
+/* The memory block of a task holds the ucontext of the task,
+ * followed by the stack.
+ */
+#define POS_USERTASKDATA \
+   void *portmem;
+
+
+/*---------------------------------------------------------------------------
+ *  SOME SPECIAL FUNCTIONS
+ *-------------------------------------------------------------------------*/
+
+/* we support assertions */
+#define HAVE_PLATFORM_ASSERT
+extern void p_pos_assert(const char* text, const char *file, int line);
+
+/* Idle task hook function (waits for the next signal)
+ */
+extern void p_pos_idleTaskHook(void);
+#define HOOK_IDLETASK   p_pos_idleTaskHook();
+
+/* The statistics page of the nano layer is created as a POSIX shared
+ * memory object (see NOSCFG_STATPAGE_SHMNAME). Returns NULL on error.
+ */
+extern void* p_nos_statPageMap(const char *name, unsigned long size);
+#define NOS_STATPAGE_MAP(name, size)  p_nos_statPageMap(name, size)
+
+
+#endif /* _PORT_H */
@@ -0,0 +1,21 @@
+/*
+ *  pico]OS nano layer configuration of the SMP test for the
+ *  Unix / Linux port (make NANO=1).
+ *
+ *  The test uses the default configuration of the port, but with the
+ *  internal memory manager of the nano layer. The heap is then only
+ *  protected by posTaskSchedLock, like on an embedded target.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#ifndef _TEST_NOSCFG_H
+#define _TEST_NOSCFG_H
+
+#include "../default/noscfg.h"
+
+#undef  NOSCFG_MEM_MANAGER_TYPE
+#define NOSCFG_MEM_MANAGER_TYPE      1
+
+#endif /* _TEST_NOSCFG_H */
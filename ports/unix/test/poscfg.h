@@ -0,0 +1,27 @@
+/*
+ *  pico]OS configuration of the SMP test for the Unix / Linux port.
+ *
+ *  The test uses the default configuration of the port and only
+ *  changes the settings that are needed for SMP mode.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#ifndef _TEST_POSCFG_H
+#define _TEST_POSCFG_H
+
+#include "../default/poscfg.h"
+
+/* four cores, each core is a POSIX thread */
+#undef  POSCFG_SMP_CORES
+#define POSCFG_SMP_CORES       4
+
+/* the test tasks, plus one idle task per core */
+#undef  POSCFG_MAX_TASKS
+#define POSCFG_MAX_TASKS       32
+
+#undef  HZ
+#define HZ                     100
+
+#endif /* _TEST_POSCFG_H */
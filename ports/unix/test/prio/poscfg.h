@@ -0,0 +1,27 @@
+/*
+ *  pico]OS configuration of the priority test for the Unix / Linux port.
+ *
+ *  The test uses the default configuration of the port with 256
+ *  priority levels. With round robin scheduling every priority is a
+ *  row of the task tables, so the kernel needs the three level
+ *  bitmaps (more rows than MVAR_BITS).
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#ifndef _TEST_POSCFG_H
+#define _TEST_POSCFG_H
+
+#include "../../default/poscfg.h"
+
+#undef  POSCFG_MAX_PRIO_LEVEL
+#define POSCFG_MAX_PRIO_LEVEL  256
+
+#undef  POSCFG_MAX_TASKS
+#define POSCFG_MAX_TASKS       32
+
+#undef  HZ
+#define HZ                     100
+
+#endif /* _TEST_POSCFG_H */
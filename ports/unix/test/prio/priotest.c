@@ -0,0 +1,232 @@
+/*
+ *  Priority test for the pico]OS Unix / Linux port.
+ *
+ *  The test runs with 256 priority levels, so the task tables of the
+ *  kernel use three level bitmaps (see SYS_TASKTABSIZE_Z). The tasks
+ *  of every check are spread over several rows of the bitmaps:
+ *
+ *  1. Tasks that are created in random order must run in the order
+ *     of their priorities.
+ *  2. posTaskYield must switch to the next lower priority that has
+ *     a ready task, even if it is in another row.
+ *  3. A task whose priority is raised into another row must run
+ *     before the tasks it passed.
+ *  4. A semaphore must wake up the waiting task with the highest
+ *     priority first.
+ *
+ *  The program prints the results and exits with status 0 when all
+ *  checks passed, or with status 1 when a check failed.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <picoos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+#if SYS_TASKTABSIZE_Z < 2
+#error This test requires more priority rows than MVAR_BITS
+#endif
+
+
+#define FIRSTPRIO     (POSCFG_MAX_PRIO_LEVEL - 1)
+#define MAXLOG        32
+#define COUNT(a)      (sizeof(a) / sizeof((a)[0]))
+
+
+static const VAR_t  order_g[] = {
+  3, 200, 64, 127, 63, 128, 191, 192, 65, 254, 1, 100
+};
+static const VAR_t  waiters_g[] = {
+  66, 2, 250, 130, 194, 64, 63
+};
+
+static VAR_t        log_g[MAXLOG];
+static int          logged_g;
+static POSSEMA_t    sema_g;
+static int          failed_g;
+
+
+
+static void report(const char *fmt, ...)
+{
+  char buf[200];
+  va_list args;
+  int len;
+
+  va_start(args, fmt);
+  len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (len > (int)sizeof(buf) - 1)
+    len = (int)sizeof(buf) - 1;
+  if (len > 0)
+    (void) write(1, buf, (size_t) len);
+}
+
+
+static void check(int ok, const char *what)
+{
+  int i;
+
+  report("%-44s %s\n", what, ok ? "ok" : "FAILED");
+  if (!ok)
+  {
+    report("  order:");
+    for (i = 0; i < logged_g; ++i)
+      report(" %d", (int) log_g[i]);
+    report("\n");
+    failed_g = 1;
+  }
+}
+
+
+static void logprio(VAR_t prio)
+{
+  posTaskSchedLock();
+  if (logged_g < MAXLOG)
+    log_g[logged_g++] = prio;
+  posTaskSchedUnlock();
+}
+
+
+/* returns 1 when the log contains count priorities in descending order */
+static int descending(int count)
+{
+  int i;
+
+  if (logged_g != count)
+    return 0;
+  for (i = 1; i < count; ++i)
+  {
+    if (log_g[i] >= log_g[i - 1])
+      return 0;
+  }
+  return 1;
+}
+
+
+/* returns 1 when the log equals the given sequence */
+static int sequence(const VAR_t *seq, int count)
+{
+  int i;
+
+  if (logged_g != count)
+    return 0;
+  for (i = 0; i < count; ++i)
+  {
+    if (log_g[i] != seq[i])
+      return 0;
+  }
+  return 1;
+}
+
+
+static void createtask(POSTASKFUNC_t func, VAR_t prio)
+{
+  if (posTaskCreate(func, (void*)(MPTR_t) prio, prio, 0) == NULL)
+  {
+    report("failed to create a task with priority %d\n", (int) prio);
+    exit(1);
+  }
+}
+
+
+
+static void logTask(void *arg)
+{
+  logprio((VAR_t)(MPTR_t) arg);
+}
+
+
+static void yieldTask(void *arg)
+{
+  logprio((VAR_t)(MPTR_t) arg);
+  posTaskYield();
+  logprio((VAR_t)(MPTR_t) arg);
+}
+
+
+static void waitTask(void *arg)
+{
+  posSemaGet(sema_g);
+  logprio((VAR_t)(MPTR_t) arg);
+}
+
+
+
+static void firstTask(void *arg)
+{
+  static const VAR_t yieldseq[] = { 200, 100, 200, 10 };
+  static const VAR_t raiseseq[] = { 250, 70, 5 };
+  POSTASK_t t;
+  int i;
+
+  (void) arg;
+  report("pico]OS priority test, %u levels, %u rows of %u bits\n",
+         (unsigned) POSCFG_MAX_PRIO_LEVEL, (unsigned) SYS_TASKTABSIZE_Z,
+         (unsigned) MVAR_BITS);
+
+  /* test 1: the tasks run when this task sleeps */
+  logged_g = 0;
+  for (i = 0; i < (int) COUNT(order_g); ++i)
+    createtask(logTask, order_g[i]);
+  posTaskSleep(HZ / 10);
+  check(descending((int) COUNT(order_g)), "tasks run in priority order");
+
+  /* test 2: the task with priority 200 yields to priority 100 */
+  logged_g = 0;
+  createtask(logTask, 10);
+  createtask(logTask, 100);
+  createtask(yieldTask, 200);
+  posTaskSleep(HZ / 10);
+  check(sequence(yieldseq, (int) COUNT(yieldseq)),
+        "yield to the next lower row");
+
+  /* test 3: priority 5 is raised above priority 70 */
+  logged_g = 0;
+  t = posTaskCreate(logTask, (void*)(MPTR_t) 250, 5, 0);
+  if (t == NULL)
+  {
+    report("failed to create a task\n");
+    exit(1);
+  }
+  createtask(logTask, 70);
+  posTaskSetPriority(t, 250);
+  createtask(logTask, 5);
+  posTaskSleep(HZ / 10);
+  check(sequence(raiseseq, (int) COUNT(raiseseq)),
+        "raised task moves to another row");
+
+  /* test 4: one signal per tick, the highest waiter wakes up first */
+  logged_g = 0;
+  sema_g = posSemaCreate(0);
+  if (sema_g == NULL)
+  {
+    report("failed to create the semaphore\n");
+    exit(1);
+  }
+  for (i = 0; i < (int) COUNT(waiters_g); ++i)
+    createtask(waitTask, waiters_g[i]);
+  posTaskSleep(HZ / 10);
+  for (i = 0; i < (int) COUNT(waiters_g); ++i)
+  {
+    posSemaSignal(sema_g);
+    posTaskSleep(1);
+  }
+  posTaskSleep(HZ / 10);
+  check(descending((int) COUNT(waiters_g)),
+        "semaphore wakes the highest waiter first");
+
+  report("priority test %s\n", failed_g ? "FAILED" : "passed");
+  exit(failed_g ? 1 : 0);
+}
+
+
+int main(void)
+{
+  posInit(firstTask, NULL, FIRSTPRIO, 0, 0);
+  return 0;
+}
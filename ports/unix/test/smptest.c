@@ -0,0 +1,398 @@
+/*
+ *  SMP test for the pico]OS Unix / Linux port.
+ *
+ *  Every core of the SMP configuration is a POSIX thread. The test
+ *  checks the kernel lock, the inter-processor interrupts, the task
+ *  affinity and the load balancing between the cores:
+ *
+ *  1. Four tasks increment two shared counters, one protected by
+ *     posTaskSchedLock and one protected by a mutex.
+ *  2. Two tasks that are bound to different cores exchange
+ *     semaphore signals (every signal wakes a task on the other core).
+ *  3. A task that is bound to the last core checks that it is never
+ *     executed on another core.
+ *  4. CPU bound tasks of equal priority must be spread over all cores.
+ *  5. With the nano layer (make NANO=1): tasks on all but the first
+ *     core allocate and free heap memory, while a task on the first
+ *     core creates short living tasks whose stacks the port takes
+ *     from the same heap. The heap and its counters must stay intact.
+ *
+ *  The program prints the results and exits with status 0 when all
+ *  checks passed, or with status 1 when a check failed or timed out.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <picoos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+#if POSCFG_SMP_CORES < 2
+#error This test requires POSCFG_SMP_CORES > 1
+#endif
+#if (POSCFG_ENABLE_NANO != 0) && (NOSCFG_MEM_MANAGER_TYPE != 1)
+#error The nano layer test requires the internal memory manager
+#endif
+
+
+#define LOCKERS       4
+#define LOCK_LOOPS    20000
+#define PINGPONGS     20000
+#define PIN_LOOPS     200
+#define WORKERS       (2 * POSCFG_SMP_CORES)
+#define TIMEOUT       (20 * HZ)
+
+#define ALLCORES      ((1UL << POSCFG_SMP_CORES) - 1)
+#define PINGCORE      1
+#define PONGCORE      2
+#define PINCORE       (POSCFG_SMP_CORES - 1)
+
+#define HEAPERS       (POSCFG_SMP_CORES - 1)
+#define HEAP_LOOPS    20000
+#define HEAP_BLOCKS   8
+#define CREATE_LOOPS  2000
+#define HEAPSIZE      (4 * 1024 * 1024)
+
+
+static volatile long          schedcnt_g;
+static volatile long          mutexcnt_g;
+static volatile int           lockersdone_g;
+static volatile int           pingsdone_g;
+static volatile int           pinerrors_g;
+static volatile int           pinrounds_g;
+static volatile unsigned long workcnt_g[WORKERS];
+static volatile unsigned long workcores_g[WORKERS];
+static POSMUTEX_t             mutex_g;
+static POSSEMA_t              ping_g;
+static POSSEMA_t              pong_g;
+static int                    failed_g;
+
+#if POSCFG_ENABLE_NANO != 0
+static char                   membuf_g[HEAPSIZE];
+void *__heap_start  = (void*) &membuf_g[0];
+void *__heap_end    = (void*) &membuf_g[HEAPSIZE-1];
+
+static volatile int           heapersdone_g;
+static volatile int           heaperrors_g;
+static volatile int           shortsdone_g;
+static volatile int           creatorsdone_g;
+#endif
+
+
+
+/* Tasks may move to another thread at every interrupt, so the
+   output is done with write() and not with the locked stdio functions */
+static void report(const char *fmt, ...)
+{
+  char buf[200];
+  va_list args;
+  int len;
+
+  va_start(args, fmt);
+  len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (len > (int)sizeof(buf) - 1)
+    len = (int)sizeof(buf) - 1;
+  if (len > 0)
+    (void) write(1, buf, (size_t) len);
+}
+
+
+static void check(int ok, const char *what)
+{
+  report("%-44s %s\n", what, ok ? "ok" : "FAILED");
+  if (!ok)
+    failed_g = 1;
+}
+
+
+/* waits until *counter reaches count, returns 0 on timeout */
+static int waitfor(volatile int *counter, int count)
+{
+  JIF_t start = jiffies;
+
+  while (*counter < count)
+  {
+    if ((JIF_t)(jiffies - start) > TIMEOUT)
+      return 0;
+    posTaskSleep(HZ / 10);
+  }
+  return 1;
+}
+
+
+
+static void lockerTask(void *arg)
+{
+  long v;
+  int i;
+
+  (void) arg;
+  for (i = 0; i < LOCK_LOOPS; ++i)
+  {
+    posTaskSchedLock();
+    v = schedcnt_g;
+    schedcnt_g = v + 1;
+    posTaskSchedUnlock();
+
+    posMutexLock(mutex_g);
+    v = mutexcnt_g;
+    if ((i & 127) == 0)
+      posTaskSleep(0);
+    mutexcnt_g = v + 1;
+    posMutexUnlock(mutex_g);
+  }
+  posTaskSchedLock();
+  ++lockersdone_g;
+  posTaskSchedUnlock();
+}
+
+
+static void pingTask(void *arg)
+{
+  int i;
+
+  (void) arg;
+  posTaskSetAffinity(posTaskGetCurrent(), 1UL << PINGCORE);
+  for (i = 0; i < PINGPONGS; ++i)
+  {
+    posSemaSignal(ping_g);
+    posSemaGet(pong_g);
+  }
+  pingsdone_g = 1;
+}
+
+
+static void pongTask(void *arg)
+{
+  (void) arg;
+  posTaskSetAffinity(posTaskGetCurrent(), 1UL << PONGCORE);
+  for (;;)
+  {
+    posSemaGet(ping_g);
+    posSemaSignal(pong_g);
+  }
+}
+
+
+static void pinnedTask(void *arg)
+{
+  int i;
+
+  (void) arg;
+  posTaskSetAffinity(posTaskGetCurrent(), 1UL << PINCORE);
+  for (i = 0; i < PIN_LOOPS; ++i)
+  {
+    if (POS_CPUID != PINCORE)
+      ++pinerrors_g;
+    if (i & 1)
+      posTaskSleep(1);
+    else
+      posTaskYield();
+    ++pinrounds_g;
+  }
+}
+
+
+static void workerTask(void *arg)
+{
+  int w = (int)(MPTR_t) arg;
+
+  for (;;)
+  {
+    ++workcnt_g[w];
+    workcores_g[w] |= 1UL << POS_CPUID;
+  }
+}
+
+
+
+#if POSCFG_ENABLE_NANO != 0
+
+/* returns 1 when no other core changed the heap while the
+   scheduler lock was held for a while */
+static int heapLocked(void)
+{
+  NOSMEMSTATS_t before, after;
+  volatile long i;
+
+  posTaskSchedLock();
+  (void) nosMemStats(&before);
+  for (i = 0; i < 100000; ++i);
+  (void) nosMemStats(&after);
+  posTaskSchedUnlock();
+  return (before.allocCount == after.allocCount) &&
+         (before.freeCount == after.freeCount);
+}
+
+
+static void heapTask(void *arg)
+{
+  unsigned char *blk[HEAP_BLOCKS];
+  unsigned len[HEAP_BLOCKS];
+  unsigned seed = (unsigned)(MPTR_t) arg;
+  unsigned j, k;
+  int i, e = 0;
+
+  posTaskSetAffinity(posTaskGetCurrent(), 2UL << (MPTR_t) arg);
+  for (j = 0; j < HEAP_BLOCKS; ++j)
+    blk[j] = NULL;
+  for (i = 0; i < HEAP_LOOPS; ++i)
+  {
+    if (((i & 63) == 0) && !heapLocked())
+      ++e;
+    seed = seed * 1103515245U + 12345U;
+    j = (seed >> 24) % HEAP_BLOCKS;
+    if (blk[j] != NULL)
+    {
+      for (k = 0; k < len[j]; ++k)
+      {
+        if (blk[j][k] != (unsigned char) (len[j] + j))
+        {
+          ++e;
+          break;
+        }
+      }
+      nosMemFree(blk[j]);
+      blk[j] = NULL;
+    }
+    else
+    {
+      len[j] = 32 + ((seed >> 8) & 4095);
+      blk[j] = (unsigned char*) nosMemAlloc(len[j]);
+      if (blk[j] == NULL)
+        ++e;
+      else
+        nosMemSet(blk[j], (char) (len[j] + j), len[j]);
+    }
+  }
+  for (j = 0; j < HEAP_BLOCKS; ++j)
+  {
+    if (blk[j] != NULL)
+      nosMemFree(blk[j]);
+  }
+  posTaskSchedLock();
+  heaperrors_g += e;
+  ++heapersdone_g;
+  posTaskSchedUnlock();
+}
+
+
+static void shortTask(void *arg)
+{
+  (void) arg;
+  posTaskSchedLock();
+  ++shortsdone_g;
+  posTaskSchedUnlock();
+}
+
+
+static void creatorTask(void *arg)
+{
+  UINT_t stacksize;
+  int i;
+
+  (void) arg;
+  posTaskSetAffinity(posTaskGetCurrent(), 1UL);
+  for (i = 0; i < CREATE_LOOPS; ++i)
+  {
+    /* the port takes the stack directly with posTaskCreate */
+    stacksize = (UINT_t) (16384 + (i & 3) * 8192);
+    while (posTaskCreate(shortTask, NULL, 6, stacksize) == NULL)
+      posTaskSleep(1);
+  }
+  creatorsdone_g = 1;
+}
+
+#endif /* POSCFG_ENABLE_NANO */
+
+
+
+static void firstTask(void *arg)
+{
+  unsigned long used;
+  int i, ok;
+
+  (void) arg;
+  mutex_g = posMutexCreate();
+  ping_g  = posSemaCreate(0);
+  pong_g  = posSemaCreate(0);
+  if ((mutex_g == NULL) || (ping_g == NULL) || (pong_g == NULL))
+  {
+    report("failed to create the test events\n");
+    exit(1);
+  }
+
+  report("pico]OS SMP test, %u cores\n", (unsigned) POSCFG_SMP_CORES);
+
+  /* test 1 + 2 + 3 run concurrently */
+  for (i = 0; i < LOCKERS; ++i)
+    posTaskCreate(lockerTask, NULL, 3, 0);
+  posTaskCreate(pongTask, NULL, 4, 0);
+  posTaskCreate(pingTask, NULL, 4, 0);
+  posTaskCreate(pinnedTask, NULL, 5, 0);
+
+  ok = waitfor(&lockersdone_g, LOCKERS);
+  check(ok, "lockers finished");
+  check(schedcnt_g == (long) LOCKERS * LOCK_LOOPS,
+        "counter protected by posTaskSchedLock");
+  check(mutexcnt_g == (long) LOCKERS * LOCK_LOOPS,
+        "counter protected by a mutex");
+  check(waitfor(&pingsdone_g, 1), "ping-pong between two cores");
+  check(waitfor(&pinrounds_g, PIN_LOOPS) && (pinerrors_g == 0),
+        "task bound to one core");
+
+  /* test 4: more CPU bound tasks than cores, below our priority */
+  for (i = 0; i < WORKERS; ++i)
+    posTaskCreate(workerTask, (void*)(MPTR_t) i, 1, 0);
+  posTaskSleep(HZ);
+  used = 0;
+  ok = 1;
+  for (i = 0; i < WORKERS; ++i)
+  {
+    used |= workcores_g[i];
+    if (workcnt_g[i] == 0)
+      ok = 0;
+  }
+  check(ok, "all CPU bound tasks make progress");
+  check(used == ALLCORES, "CPU bound tasks use all cores");
+
+#if POSCFG_ENABLE_NANO != 0
+  /* test 5: heap and task creation on different cores, above the
+     CPU bound tasks of test 4 */
+  {
+    NOSMEMSTATS_t ms;
+
+    for (i = 0; i < HEAPERS; ++i)
+      posTaskCreate(heapTask, (void*)(MPTR_t) i, 5, 0);
+    posTaskCreate(creatorTask, NULL, 5, 0);
+    check(waitfor(&heapersdone_g, HEAPERS) && (heaperrors_g == 0),
+          "heap blocks intact while tasks are created");
+    check(waitfor(&creatorsdone_g, 1) &&
+          waitfor(&shortsdone_g, CREATE_LOOPS),
+          "tasks created while the heap is in use");
+    ok = (nosMemStats(&ms) == E_OK) &&
+         (ms.allocCount - ms.freeCount == ms.usedBlocks) &&
+         (ms.usedBytes + ms.freeBytes == ms.heapSize) &&
+         (ms.failCount == 0);
+    check(ok, "heap counters consistent");
+  }
+#endif
+
+  report("SMP test %s\n", failed_g ? "FAILED" : "passed");
+  exit(failed_g ? 1 : 0);
+}
+
+
+int main(void)
+{
+#if POSCFG_ENABLE_NANO != 0
+  nosInit(firstTask, NULL, 10, 0, 0);
+#else
+  posInit(firstTask, NULL, 10, 0, 0);
+#endif
+  return 0;
+}
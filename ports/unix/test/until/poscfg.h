@@ -0,0 +1,24 @@
+/*
+ *  pico]OS configuration of the absolute timeout test for the
+ *  Unix / Linux port.
+ *
+ *  The test uses the default configuration of the port with the
+ *  absolute timeouts enabled and a faster timer, so the test does
+ *  not take too long.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#ifndef _TEST_POSCFG_H
+#define _TEST_POSCFG_H
+
+#include "../../default/poscfg.h"
+
+#undef  POSCFG_FEATURE_SLEEPUNTIL
+#define POSCFG_FEATURE_SLEEPUNTIL  1
+
+#undef  HZ
+#define HZ                     100
+
+#endif /* _TEST_POSCFG_H */
@@ -0,0 +1,294 @@
+/*
+ *  Absolute timeout test for the pico]OS Unix / Linux port.
+ *
+ *  The test checks the functions that take an absolute time:
+ *
+ *  1. posTaskSleepUntil must wake the task at the requested tick,
+ *     and must not block when the time has already passed.
+ *  2. posTaskSleepPeriodic must release the task every period, and
+ *     must skip the periods that were missed without shifting the
+ *     phase of the period.
+ *  3. posSemaWaitUntil, posMessageWaitUntil and posFlagWaitUntil
+ *     must time out at the deadline, must return early when the
+ *     event happens before the deadline, and must not block when
+ *     the deadline has already passed.
+ *
+ *  The timer of the port runs in real time, so a task may be woken
+ *  up one tick late when the host is busy. The test accepts up to
+ *  SLACK ticks, but a task must never run before its deadline.
+ *
+ *  The program prints the results and exits with status 0 when all
+ *  checks passed, or with status 1 when a check failed.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <picoos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+
+#define FIRSTPRIO     (POSCFG_MAX_PRIO_LEVEL - 1)
+#define HELPERPRIO    1
+#define SLACK         2
+#define WAIT          5
+#define PERIOD        3
+#define PERIODS       10
+#define EVENTDELAY    3
+#define FLAGNUM       2
+
+#define EV_SEMA       0
+#define EV_MESSAGE    1
+#define EV_FLAG       2
+
+
+static POSTASK_t    main_g;
+static POSSEMA_t    sema_g;
+static POSFLAG_t    flag_g;
+static int          failed_g;
+
+
+
+static void report(const char *fmt, ...)
+{
+  char buf[200];
+  va_list args;
+  int len;
+
+  va_start(args, fmt);
+  len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (len > (int)sizeof(buf) - 1)
+    len = (int)sizeof(buf) - 1;
+  if (len > 0)
+    (void) write(1, buf, (size_t) len);
+}
+
+
+static void check(int ok, const char *what)
+{
+  report("%-52s %s\n", what, ok ? "ok" : "FAILED");
+  if (!ok)
+    failed_g = 1;
+}
+
+
+/* returns 1 when the time is at the deadline or at most SLACK ticks later */
+static int ontime(JIF_t now, JIF_t deadline)
+{
+  SJIF_t late = (SJIF_t) (now - deadline);
+
+  if ((late < 0) || (late > SLACK))
+  {
+    report("  woke up %ld ticks after the deadline\n", (long) late);
+    return 0;
+  }
+  return 1;
+}
+
+
+/* returns 1 when the time is before the deadline */
+static int early(JIF_t now, JIF_t deadline)
+{
+  return POS_TIMEAFTER(deadline, now) ? 1 : 0;
+}
+
+
+
+/* signals the event EVENTDELAY ticks after it was started */
+static void eventTask(void *arg)
+{
+  void *msg;
+
+  posTaskSleep(EVENTDELAY);
+  switch ((int)(MPTR_t) arg)
+  {
+    case EV_SEMA:
+      posSemaSignal(sema_g);
+      break;
+
+    case EV_MESSAGE:
+      msg = posMessageAlloc();
+      if (msg != NULL)
+        posMessageSend(msg, main_g);
+      break;
+
+    default:
+      posFlagSet(flag_g, FLAGNUM);
+      break;
+  }
+}
+
+
+static void startevent(int what)
+{
+  if (posTaskCreate(eventTask, (void*)(MPTR_t) what, HELPERPRIO, 0) == NULL)
+  {
+    report("failed to create a task\n");
+    exit(1);
+  }
+}
+
+
+
+static void testSleepUntil(void)
+{
+  JIF_t deadline, start;
+  int i, ok;
+
+  ok = 1;
+  for (i = 1; i <= WAIT; ++i)
+  {
+    deadline = jiffies + (JIF_t) i;
+    posTaskSleepUntil(deadline);
+    ok &= ontime(jiffies, deadline);
+  }
+  check(ok, "posTaskSleepUntil wakes up at the deadline");
+
+  start = jiffies;
+  posTaskSleepUntil(start - WAIT);
+  check(ontime(jiffies, start), "posTaskSleepUntil does not block when late");
+}
+
+
+static void testSleepPeriodic(void)
+{
+  JIF_t start, next;
+  UINT_t skipped;
+  int i, ok;
+
+  ok = 1;
+  start = next = jiffies;
+  for (i = 0; i < PERIODS; ++i)
+  {
+    skipped = posTaskSleepPeriodic(&next, PERIOD);
+    ok &= (skipped == 0) && ontime(jiffies, next);
+  }
+  ok &= (next == start + (JIF_t)(PERIODS * PERIOD));
+  check(ok, "posTaskSleepPeriodic releases the task every period");
+
+  /* stay busy until two release times have been missed */
+  while (!POS_TIMEAFTER(jiffies, next + 2 * PERIOD + 1))
+    ;
+  skipped = posTaskSleepPeriodic(&next, PERIOD);
+  ok = (skipped >= 2) && ontime(jiffies, next) &&
+       (((JIF_t)(next - start) % PERIOD) == 0);
+  check(ok, "posTaskSleepPeriodic skips missed periods");
+}
+
+
+static void testSema(void)
+{
+  JIF_t deadline;
+  VAR_t rc;
+
+  sema_g = posSemaCreate(0);
+  if (sema_g == NULL)
+  {
+    report("failed to create the semaphore\n");
+    exit(1);
+  }
+
+  deadline = jiffies + WAIT;
+  rc = posSemaWaitUntil(sema_g, deadline);
+  check((rc > 0) && ontime(jiffies, deadline),
+        "posSemaWaitUntil times out at the deadline");
+
+  startevent(EV_SEMA);
+  deadline = jiffies + 10 * WAIT;
+  rc = posSemaWaitUntil(sema_g, deadline);
+  check((rc == 0) && early(jiffies, deadline),
+        "posSemaWaitUntil returns when signalled");
+
+  deadline = jiffies - WAIT;
+  rc = posSemaWaitUntil(sema_g, deadline);
+  check((rc > 0) && ontime(jiffies, deadline + WAIT),
+        "posSemaWaitUntil does not block when late");
+
+  posSemaDestroy(sema_g);
+}
+
+
+static void testMessage(void)
+{
+  JIF_t deadline;
+  void *msg;
+
+  deadline = jiffies + WAIT;
+  msg = posMessageWaitUntil(deadline);
+  check((msg == NULL) && ontime(jiffies, deadline),
+        "posMessageWaitUntil times out at the deadline");
+
+  startevent(EV_MESSAGE);
+  deadline = jiffies + 10 * WAIT;
+  msg = posMessageWaitUntil(deadline);
+  check((msg != NULL) && early(jiffies, deadline),
+        "posMessageWaitUntil returns when a message arrives");
+  if (msg != NULL)
+    posMessageFree(msg);
+
+  deadline = jiffies - WAIT;
+  msg = posMessageWaitUntil(deadline);
+  check((msg == NULL) && ontime(jiffies, deadline + WAIT),
+        "posMessageWaitUntil does not block when late");
+}
+
+
+static void testFlag(void)
+{
+  JIF_t deadline;
+  VAR_t rc;
+
+  flag_g = posFlagCreate();
+  if (flag_g == NULL)
+  {
+    report("failed to create the flag object\n");
+    exit(1);
+  }
+
+  deadline = jiffies + WAIT;
+  rc = posFlagWaitUntil(flag_g, deadline);
+  check((rc == 0) && ontime(jiffies, deadline),
+        "posFlagWaitUntil times out at the deadline");
+
+  startevent(EV_FLAG);
+  deadline = jiffies + 10 * WAIT;
+  rc = posFlagWaitUntil(flag_g, deadline);
+  check((rc == (1 << FLAGNUM)) && early(jiffies, deadline),
+        "posFlagWaitUntil returns when a flag is set");
+
+  deadline = jiffies - WAIT;
+  rc = posFlagWaitUntil(flag_g, deadline);
+  check((rc == 0) && ontime(jiffies, deadline + WAIT),
+        "posFlagWaitUntil does not block when late");
+
+  posFlagDestroy(flag_g);
+}
+
+
+
+static void firstTask(void *arg)
+{
+  (void) arg;
+  main_g = posTaskGetCurrent();
+  report("pico]OS absolute timeout test, HZ = %u\n", (unsigned) HZ);
+
+  testSleepUntil();
+  testSleepPeriodic();
+  testSema();
+  testMessage();
+  testFlag();
+
+  report("absolute timeout test %s\n", failed_g ? "FAILED" : "passed");
+  exit(failed_g ? 1 : 0);
+}
+
+
+int main(void)
+{
+  posInit(firstTask, NULL, FIRSTPRIO, 0, 0);
+  return 0;
+}
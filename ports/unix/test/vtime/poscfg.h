@@ -0,0 +1,24 @@
+/*
+ *  pico]OS configuration of the virtual time test for the Unix / Linux
+ *  port.
+ *
+ *  The test uses the default configuration of the port in virtual
+ *  time mode. The idle task drives the timer, so the Unix port does
+ *  not start its timer thread.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#ifndef _TEST_POSCFG_H
+#define _TEST_POSCFG_H
+
+#include "../../default/poscfg.h"
+
+#undef  POSCFG_FEATURE_VIRTUALTIME
+#define POSCFG_FEATURE_VIRTUALTIME  1
+
+#undef  HZ
+#define HZ                          1000
+
+#endif /* _TEST_POSCFG_H */
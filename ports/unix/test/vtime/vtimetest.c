@@ -0,0 +1,248 @@
+/*
+ *  Virtual time test for the pico]OS Unix / Linux port.
+ *
+ *  The kernel is built with POSCFG_FEATURE_VIRTUALTIME, so the idle
+ *  task drives the timer and the time jumps to the next timeout when
+ *  all tasks are blocked. The test simulates one day of device time
+ *  with a periodic task, a periodic timer, a semaphore wait with
+ *  timeout, a message box and tasks that sleep for an hour.
+ *
+ *  Every event is added with its time to a trace checksum, and the
+ *  checksum is printed once per simulated hour. The program exits
+ *  with status 1 when the count of periodic events does not match
+ *  the simulated time. "make check" runs the program twice and
+ *  compares the output of both runs, which must be identical.
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <picoos.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <unistd.h>
+
+#if POSCFG_FEATURE_VIRTUALTIME == 0
+#error This test requires POSCFG_FEATURE_VIRTUALTIME
+#endif
+
+
+#define HOURS         24
+#define HOURTICKS     ((JIF_t) HZ * 3600)
+#define SIMTICKS      (HOURS * HOURTICKS)
+
+#define SAMPLEPERIOD  MS(250)
+#define TIMERPERIOD   MS(1000)
+#define WORKTIMEOUT   MS(700)
+#define SIGNALEVERY   3
+#define MESSAGEEVERY  7
+
+#define PRIO_MAIN     (POSCFG_MAX_PRIO_LEVEL - 1)
+#define PRIO_SAMPLE   5
+#define PRIO_TIMER    4
+#define PRIO_WORKER   3
+#define PRIO_LOGGER   2
+#define PRIO_HOUR     1
+
+#define EV_SAMPLE     1
+#define EV_TIMER      2
+#define EV_SIGNAL     3
+#define EV_TIMEOUT    4
+#define EV_MESSAGE    5
+#define EV_HOUR       6
+#define EV_COUNT      7
+
+
+static JIF_t          start_g;
+static POSSEMA_t      worksema_g;
+static POSSEMA_t      timersema_g;
+static POSTASK_t      logger_g;
+static unsigned long  trace_g = 2166136261UL;
+static unsigned long  count_g[EV_COUNT];
+
+
+
+static void report(const char *fmt, ...)
+{
+  char buf[200];
+  va_list args;
+  int len;
+
+  va_start(args, fmt);
+  len = vsnprintf(buf, sizeof(buf), fmt, args);
+  va_end(args);
+  if (len > (int)sizeof(buf) - 1)
+    len = (int)sizeof(buf) - 1;
+  if (len > 0)
+    (void) write(1, buf, (size_t) len);
+}
+
+
+static void fail(const char *what)
+{
+  report("%s\n", what);
+  exit(1);
+}
+
+
+/* adds an event and the current time to the trace (32 bit FNV-1a) */
+static void trace(int event)
+{
+  unsigned long t = (unsigned long) (jiffies - start_g);
+  int i;
+
+  posTaskSchedLock();
+  ++count_g[event];
+  trace_g = ((trace_g ^ (unsigned long) event) * 16777619UL) & 0xFFFFFFFFUL;
+  for (i = 0; i < 4; ++i)
+  {
+    trace_g = ((trace_g ^ (t & 0xFF)) * 16777619UL) & 0xFFFFFFFFUL;
+    t >>= 8;
+  }
+  posTaskSchedUnlock();
+}
+
+
+
+/* periodic task: signals the worker and sends messages to the logger */
+static void sampleTask(void *arg)
+{
+  JIF_t next = start_g;
+  void *msg;
+
+  (void) arg;
+  for (;;)
+  {
+    if (posTaskSleepPeriodic(&next, SAMPLEPERIOD) != 0)
+      fail("a period of the sample task was missed");
+    trace(EV_SAMPLE);
+    if ((count_g[EV_SAMPLE] % SIGNALEVERY) == 0)
+      posSemaSignal(worksema_g);
+    if ((count_g[EV_SAMPLE] % MESSAGEEVERY) == 0)
+    {
+      msg = posMessageAlloc();
+      if (msg == NULL)
+        fail("failed to allocate a message");
+      posMessageSend(msg, logger_g);
+    }
+  }
+}
+
+
+/* waits for the periodic timer */
+static void timerTask(void *arg)
+{
+  (void) arg;
+  for (;;)
+  {
+    posSemaGet(timersema_g);
+    trace(EV_TIMER);
+  }
+}
+
+
+/* waits for the signal of the sample task, with a timeout */
+static void workerTask(void *arg)
+{
+  (void) arg;
+  for (;;)
+  {
+    if (posSemaWait(worksema_g, WORKTIMEOUT) == 0)
+      trace(EV_SIGNAL);
+    else
+      trace(EV_TIMEOUT);
+  }
+}
+
+
+/* waits for messages of the sample task without a timeout */
+static void loggerTask(void *arg)
+{
+  void *msg;
+
+  (void) arg;
+  for (;;)
+  {
+    msg = posMessageWait(INFINITE);
+    if (msg == NULL)
+      fail("failed to receive a message");
+    trace(EV_MESSAGE);
+    posMessageFree(msg);
+  }
+}
+
+
+/* sleeps for one hour and prints the trace */
+static void hourTask(void *arg)
+{
+  int hour;
+
+  (void) arg;
+  for (hour = 1; hour <= HOURS; ++hour)
+  {
+    posTaskSleep((UINT_t) HOURTICKS);
+    trace(EV_HOUR);
+    report("hour %2d: %9lu ticks, %7lu samples, trace %08lx\n", hour,
+           (unsigned long) (jiffies - start_g), count_g[EV_SAMPLE],
+           trace_g);
+  }
+}
+
+
+
+static void createtask(POSTASKFUNC_t func, VAR_t prio)
+{
+  if (posTaskCreate(func, NULL, prio, 0) == NULL)
+    fail("failed to create a task");
+}
+
+
+static void firstTask(void *arg)
+{
+  POSTIMER_t tmr;
+  int ok;
+
+  (void) arg;
+  report("pico]OS virtual time test, %d hours at HZ = %u\n",
+         HOURS, (unsigned) HZ);
+
+  worksema_g  = posSemaCreate(0);
+  timersema_g = posSemaCreate(0);
+  tmr = posTimerCreate();
+  if ((worksema_g == NULL) || (timersema_g == NULL) || (tmr == NULL))
+    fail("failed to create the objects");
+
+  start_g = jiffies;
+  createtask(sampleTask, PRIO_SAMPLE);
+  createtask(timerTask, PRIO_TIMER);
+  createtask(workerTask, PRIO_WORKER);
+  createtask(hourTask, PRIO_HOUR);
+  logger_g = posTaskCreate(loggerTask, NULL, PRIO_LOGGER, 0);
+  if (logger_g == NULL)
+    fail("failed to create a task");
+  posTimerSet(tmr, timersema_g, TIMERPERIOD, TIMERPERIOD);
+  posTimerStart(tmr);
+
+  /* wake up between two periods, after the last hour was printed */
+  posTaskSleepUntil(start_g + SIMTICKS + SAMPLEPERIOD / 2);
+
+  report("samples %lu, timer %lu, signals %lu, timeouts %lu, messages %lu\n",
+         count_g[EV_SAMPLE], count_g[EV_TIMER], count_g[EV_SIGNAL],
+         count_g[EV_TIMEOUT], count_g[EV_MESSAGE]);
+  report("trace %08lx\n", trace_g);
+
+  ok = (count_g[EV_SAMPLE] == SIMTICKS / SAMPLEPERIOD) &&
+       (count_g[EV_TIMER] == SIMTICKS / TIMERPERIOD) &&
+       (count_g[EV_HOUR] == HOURS) &&
+       (count_g[EV_MESSAGE] == count_g[EV_SAMPLE] / MESSAGEEVERY);
+  report("virtual time test %s\n", ok ? "passed" : "FAILED");
+  exit(ok ? 0 : 1);
+}
+
+
+int main(void)
+{
+  posInit(firstTask, NULL, PRIO_MAIN, 0, 0);
+  return 0;
+}
@@ -0,0 +1,209 @@
+/*
+ *  pico]OS statistics page viewer
+ *
+ *  Host program that displays the statistics page of a pico]OS
+ *  process that runs on the Unix / Linux port. The page is a POSIX
+ *  shared memory object that is created by the port and updated by
+ *  the nano layer (see nosStatPageStart and NOSCFG_STATPAGE_SHMNAME).
+ *
+ *  The viewer only maps the page read-only and copies it. It never
+ *  locks anything in the observed process: a copy is accepted when
+ *  the sequence counter of the page was even and did not change
+ *  while the page was copied.
+ *
+ *  Build:  cc -O2 -I../../../inc -o statview statview.c -lrt
+ *  Usage:  statview [-1] [-i interval_ms] [shm_name]
+ *          (default shm_name is "/picoos-stats")
+ *
+ *  License:  modified BSD, see license.txt in the picoos root directory.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pos_stpage.h>
+
+
+#define DEFAULT_SHMNAME  "/picoos-stats"
+
+
+/* names of the task states (NOSSTATTASK_RUNNING ...) */
+static const char *statename_g[] = {
+  "-", "running", "ready", "blocked", "w-msg"
+};
+
+
+static const char* statename(unsigned long state)
+{
+  if (state < sizeof(statename_g) / sizeof(statename_g[0]))
+    return statename_g[state];
+  return "?";
+}
+
+static void printval(unsigned long v, int width)
+{
+  if (v == NOSSTATPAGE_NA)
+    printf(" %*s", width, "n/a");
+  else
+    printf(" %*lu", width, v);
+}
+
+/* Copies a consistent snapshot of the page. Returns 0 on success. */
+static int snapshot(const NOSSTATPAGE_t *pg, NOSSTATPAGE_t *copy,
+                    size_t size)
+{
+  unsigned long seq;
+  int tries;
+
+  for (tries = 0; tries < 1000; tries++)
+  {
+    seq = pg->seq;
+    if ((seq & 1) == 0)
+    {
+      __sync_synchronize();
+      memcpy(copy, (const void*) pg, size);
+      __sync_synchronize();
+      if ((pg->seq == seq) && (copy->magic == NOSSTATPAGE_MAGIC))
+        return 0;
+    }
+    usleep(100);
+  }
+  return -1;
+}
+
+static void show(const NOSSTATPAGE_t *p, size_t size, int clear)
+{
+  unsigned long i, n;
+
+  if (clear)
+    printf("\033[H\033[2J");
+
+  printf("pico]OS statistics  update %lu", p->updates);
+  if (p->jiffies != NOSSTATPAGE_NA && p->hz != 0)
+    printf("  uptime %lu.%02lu s", p->jiffies / p->hz,
+           (p->jiffies % p->hz) * 100 / p->hz);
+  if (p->cpuusage != NOSSTATPAGE_NA)
+    printf("  cpu %lu%%", p->cpuusage);
+  printf("\n");
+
+  printf("switches");
+  printval(p->switches, 1);
+  printf("   allocfail");
+  printval(p->allocfail, 1);
+  printf("\n");
+
+  printf("heap size");
+  printval(p->heapsize, 1);
+  printf("  used");
+  printval(p->heapused, 1);
+  printf("  max");
+  printval(p->heapmaxused, 1);
+  printf("  largest free");
+  printval(p->heaplargest, 1);
+  printf("  blocks");
+  printval(p->heapblocks, 1);
+  printf("  failed");
+  printval(p->heapfail, 1);
+  printf("\n\n");
+
+  printf("%-15s %4s %-10s %10s %10s %8s %5s %5s %14s\n",
+         "task", "prio", "state", "switches", "wakeups", "timeouts",
+         "msgs", "max", "cpu time [us]");
+  n = (p->tasks < p->maxtasks) ? p->tasks : p->maxtasks;
+  if ((n != 0) && (NOSSTATPAGE_SIZE(n) > size))
+    n = 1 + (size - NOSSTATPAGE_SIZE(1)) / sizeof(NOSSTATTASK_t);
+  for (i = 0; i < n; i++)
+  {
+    const NOSSTATTASK_t *t = &p->task[i];
+    printf("%-15.*s %4ld %-10s", NOSSTATPAGE_NAMELEN - 1, t->name,
+           t->priority, (t->state == NOSSTATPAGE_NA) ?
+           "n/a" : statename(t->state));
+    printval(t->switches, 10);
+    printval(t->wakeups, 10);
+    printval(t->timeouts, 8);
+    printval(t->msgcount, 5);
+    printval(t->msgmax, 5);
+    if (t->cputime == (unsigned long long) NOSSTATPAGE_NA)
+      printf(" %14s", "n/a");
+    else
+      printf(" %14llu", t->cputime);
+    printf("\n");
+  }
+  fflush(stdout);
+}
+
+int main(int argc, char *argv[])
+{
+  const char *name = DEFAULT_SHMNAME;
+  NOSSTATPAGE_t *pg, *copy;
+  struct stat st;
+  long interval = 1000;
+  int once = 0;
+  int fd, i;
+
+  for (i = 1; i < argc; i++)
+  {
+    if (strcmp(argv[i], "-1") == 0)
+      once = 1;
+    else if ((strcmp(argv[i], "-i") == 0) && (i + 1 < argc))
+      interval = atol(argv[++i]);
+    else if (argv[i][0] != '-')
+      name = argv[i];
+    else
+    {
+      fprintf(stderr, "usage: %s [-1] [-i interval_ms] [shm_name]\n",
+              argv[0]);
+      return 1;
+    }
+  }
+
+  fd = shm_open(name, O_RDONLY, 0);
+  if (fd < 0)
+  {
+    perror(name);
+    return 1;
+  }
+  if ((fstat(fd, &st) != 0) || ((size_t) st.st_size < sizeof(NOSSTATPAGE_t)))
+  {
+    fprintf(stderr, "%s: not a statistics page\n", name);
+    return 1;
+  }
+  pg = (NOSSTATPAGE_t*) mmap(NULL, (size_t) st.st_size, PROT_READ,
+                             MAP_SHARED, fd, 0);
+  close(fd);
+  if (pg == (NOSSTATPAGE_t*) MAP_FAILED)
+  {
+    perror("mmap");
+    return 1;
+  }
+  copy = (NOSSTATPAGE_t*) malloc((size_t) st.st_size);
+  if (copy == NULL)
+    return 1;
+
+  for (;;)
+  {
+    if (snapshot(pg, copy, (size_t) st.st_size) != 0)
+    {
+      fprintf(stderr, "%s: no valid statistics page\n", name);
+    }
+    else if (copy->version != NOSSTATPAGE_VERSION)
+    {
+      fprintf(stderr, "%s: unsupported page version %lu\n",
+              name, copy->version);
+      return 1;
+    }
+    else
+    {
+      show(copy, (size_t) st.st_size, !once);
+    }
+    if (once)
+      break;
+    usleep((useconds_t) interval * 1000);
+  }
+  return 0;
+}
@@ -82,6 +82,13 @@ extern void POSCALL nos_initBottomHalfs(void);
 #if NOSCFG_FEATURE_REGISTRY != 0
 extern void POSCALL nos_initRegistry(void);
 #endif
+#if (NOSCFG_FEATURE_MEMALLOC != 0) && (NOSCFG_FEATURE_MEMSTATS != 0) && \
+    (NOSCFG_FEATURE_USERREG != 0)
+extern void POSCALL nos_regMemStats(void);
+#endif
+#if NOSCFG_FEATURE_MEMCACHE != 0
+extern void POSCALL nos_memCacheExit(POSTASK_t task);
+#endif
 
 /* private */
 static void nano_init(void *arg);
@@ -445,16 +452,19 @@ void POSCALL nosTimerDestroy(NOSTIMER_t tmr)
 
 #ifdef NOS_NEEDTASKEXITHOOK
 
-static void nos_taskExitHook(POSTASK_t task, texhookevent_t event);
-static void nos_taskExitHook(POSTASK_t task, texhookevent_t event)
+void nos_taskExitHook(POSTASK_t task, texhookevent_t event)
 {
 #if NOSCFG_FEATURE_REGISTRY != 0
   if (event == texh_exitcalled)
     nos_regDelSysKey(REGTYPE_TASK, task, NULL);
 #endif
+#if NOSCFG_FEATURE_MEMCACHE != 0
+  if (event == texh_exitcalled)
+    nos_memCacheExit(task);
+#endif
 #if POSCFG_TASKSTACKTYPE == 0
   if (event == texh_freestackmem)
-    NOS_MEM_FREE(task->nosstkroot);
+    NOS_STACK_FREE(task->nosstkroot);
 #endif
 }
 
@@ -497,11 +507,13 @@ NOSTASK_t POSCALL nosTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
   if (stacksize == 0)
     stacksize = NOSCFG_DEFAULT_STACKSIZE;
 
+  /* The stack memory is freed by the task exit hook with NOS_STACK_FREE,
+     so it must be taken directly from the heap or from the stack cache. */
   task = NULL;
-  stk = nosMemAlloc(NOSCFG_STKMEM_RESERVE + stacksize);
+  posTaskSchedLock();
+  stk = NOS_STACK_ALLOC(NOSCFG_STKMEM_RESERVE + stacksize);
   if (stk != NULL)
   {
-    posTaskSchedLock();
 #if NOSCFG_STACK_GROWS_UP == 0
     task = posTaskCreate(funcptr, funcarg, priority, 
                          (void*) (((MEMPTR_t)stk) + stacksize -
@@ -521,8 +533,15 @@ NOSTASK_t POSCALL nosTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
       POS_SETTASKNAME(task, name);
 #endif
     }
-    posTaskSchedUnlock();
+    else
+    {
+      NOS_STACK_FREE(stk);
+    }
+  }
+  posTaskSchedUnlock();
 
+  if (task != NULL)
+  {
 #if POSCFG_FEATURE_SLEEP != 0
     posTaskSleep(0);
 #elif POSCFG_FEATURE_YIELD != 0
@@ -536,18 +555,22 @@ NOSTASK_t POSCALL nosTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
   if (stacksize == 0)
     stacksize = NOSCFG_DEFAULT_STACKSIZE;
 
-#if NOSCFG_FEATURE_REGISTRY != 0
+#ifdef NOS_NEEDTASKEXITHOOK
   posTaskSchedLock();
 #endif
 
   task = posTaskCreate(funcptr, funcarg, priority, stacksize);
 
-#if NOSCFG_FEATURE_REGISTRY != 0
+#ifdef NOS_NEEDTASKEXITHOOK
   if (task != NULL)
   {
     task->exithook = nos_taskExitHook;
+#if NOSCFG_FEATURE_REGISTRY != 0
     nos_regEnableSysKey(re, task);
     POS_SETTASKNAME(task, re->name);
+#else
+    POS_SETTASKNAME(task, name);
+#endif
   }
   posTaskSchedUnlock();
 #else
@@ -557,19 +580,23 @@ NOSTASK_t POSCALL nosTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
   /*-----------------------------------------------*/
 #elif POSCFG_TASKSTACKTYPE == 2
 
-#if NOSCFG_FEATURE_REGISTRY != 0
+#ifdef NOS_NEEDTASKEXITHOOK
   posTaskSchedLock();
 #endif
 
   (void) stacksize;
   task = posTaskCreate(funcptr, funcarg, priority);
 
-#if NOSCFG_FEATURE_REGISTRY != 0
+#ifdef NOS_NEEDTASKEXITHOOK
   if (task != NULL)
   {
     task->exithook = nos_taskExitHook;
+#if NOSCFG_FEATURE_REGISTRY != 0
     nos_regEnableSysKey(re, task);
     POS_SETTASKNAME(task, re->name);
+#else
+    POS_SETTASKNAME(task, name);
+#endif
   }
   posTaskSchedUnlock();
 #else
@@ -608,7 +635,7 @@ static void nano_init(void *arg)
   posCurrentTask_g->exithook = nos_taskExitHook;
 #else
   (void) arg;
-#if NOSCFG_FEATURE_REGISTRY != 0
+#ifdef NOS_NEEDTASKEXITHOOK
   posCurrentTask_g->exithook = nos_taskExitHook;
 #endif
 #endif
@@ -619,6 +646,10 @@ static void nano_init(void *arg)
 #if NOSCFG_FEATURE_REGISTRY != 0
   nos_initRegistry();
 #endif
+#if (NOSCFG_FEATURE_MEMALLOC != 0) && (NOSCFG_FEATURE_MEMSTATS != 0) && \
+    (NOSCFG_FEATURE_USERREG != 0)
+  nos_regMemStats();
+#endif
 #if (NOSCFG_FEATURE_CONIN != 0) || (NOSCFG_FEATURE_CONOUT != 0) || \
     (NOSCFG_FEATURE_PRINTF != 0) || (NOSCFG_FEATURE_SPRINTF != 0)
   nos_initConIO();
@@ -660,8 +691,8 @@ void POSCALL nosInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority,
     taskStackSize = NOSCFG_DEFAULT_STACKSIZE;
   if (idleStackSize == 0)
     idleStackSize = NOSCFG_DEFAULT_STACKSIZE;
-  stk_task1 = NOS_MEM_ALLOC(NOSCFG_STKMEM_RESERVE + taskStackSize);
-  stk_idle  = NOS_MEM_ALLOC(NOSCFG_STKMEM_RESERVE + idleStackSize);
+  stk_task1 = NOS_STACK_ALLOC(NOSCFG_STKMEM_RESERVE + taskStackSize);
+  stk_idle  = NOS_STACK_ALLOC(NOSCFG_STKMEM_RESERVE + idleStackSize);
   if ((stk_task1 != NULL) && (stk_idle != NULL))
   {
 #if NOSCFG_STACK_GROWS_UP == 0
@@ -61,10 +61,17 @@
 #undef NULL
 #endif
 #include <stdlib.h>
+#ifndef NULL
+#define NULL ((void*)0)
+#endif
 #endif
 
 /* function prototypes */
 void POSCALL nos_initMem(void);
+#if (NOSCFG_FEATURE_MEMALLOC != 0) && (NOSCFG_FEATURE_MEMSTATS != 0) && \
+    (NOSCFG_FEATURE_USERREG != 0)
+void POSCALL nos_regMemStats(void);
+#endif
 
 /* we need nosMemCopy for nosRealloc */
 #if (NOSCFG_FEATURE_REALLOC != 0) && (NOSCFG_FEATURE_MEMCOPY == 0)
@@ -73,66 +80,109 @@ void POSCALL nos_initMem(void);
 void nosMemCopy(void *dst, void *src, UINT_t count);
 #endif
 
+/* nosMemMove uses nosMemCopy for non-overlapping and forward moves */
+#if (NOSCFG_FEATURE_MEMMOVE != 0) && (NOSCFG_FEATURE_MEMCOPY == 0)
+#undef NOSCFG_FEATURE_MEMCOPY
+#define NOSCFG_FEATURE_MEMCOPY  1
+void nosMemCopy(void *dst, void *src, UINT_t count);
+#endif
+
 
 
 /*---------------------------------------------------------------------------
- *  MEMORY FUNCTIONS:  memset / memcpy
+ *  MEMORY FUNCTIONS:  memset / memcpy / memmove / memcmp
+ *
+ * Notes:
+ *   The fast variants of these functions work on memory words that have
+ *   the width of a pointer (type MEMPTR_t), this is 64 bit on 64 bit hosts.
+ *   Word loops are unrolled four times. When source and destination are
+ *   not aligned to each other, the destination is aligned and the source
+ *   words are read aligned and shifted together ("shift-merge"). This
+ *   requires the byte order to be known (see NOSCFG_MEM_BYTEORDER),
+ *   otherwise the functions fall back to byte copying for such buffers.
+ *   Note that shift-merge reads whole aligned source words, so up to
+ *   one word minus one byte may be read beyond the source buffer
+ *   (but never across a word boundary).
  *-------------------------------------------------------------------------*/
 
+#if (MVAR_BITS > 8) && (POSCFG_SMALLCODE == 0) && (POSCFG_FASTCODE != 0)
+
+#define NOS_MEMFAST
+
+typedef MEMPTR_t  MWORD_t;
+
+#define MWSIZE          ((UINT_t) sizeof(MWORD_t))
+#define MWOFS(p)        ((UVAR_t) (((MEMPTR_t)(p)) & (sizeof(MWORD_t)-1)))
+#define MWHEAD(p)       ((UVAR_t) ((~(((MEMPTR_t)(p))-1)) & (sizeof(MWORD_t)-1)))
+
+#if NOSCFG_MEM_BYTEORDER == 1
+#define MWMERGE(lo, hi, sl, sr)  (((lo) >> (sl)) | ((hi) << (sr)))
+#elif NOSCFG_MEM_BYTEORDER == 2
+#define MWMERGE(lo, hi, sl, sr)  (((lo) << (sl)) | ((hi) >> (sr)))
+#endif
+
+#if (NOSCFG_FEATURE_MEMCOPY != 0) || (NOSCFG_FEATURE_MEMMOVE != 0)
+static UINT_t POSCALL n_wcopyfwd(MWORD_t *d, char *cs, UINT_t n);
+#endif
+#if NOSCFG_FEATURE_MEMMOVE != 0
+static UINT_t POSCALL n_wcopybwd(MWORD_t *d, char *cs, UINT_t n);
+#endif
+
+#endif /* fast code */
+
+/*-------------------------------------------------------------------------*/
+
 #if NOSCFG_FEATURE_MEMSET != 0
 
 void POSCALL nosMemSet(void *buf, char val, UINT_t count)
 {
   char   *cb = (char*) buf;
 
-#if (MVAR_BITS > 8) && (POSCFG_SMALLCODE == 0) && (POSCFG_FASTCODE != 0)
+#ifdef NOS_MEMFAST
   UVAR_t i;
 
-  i = (UVAR_t) (~(((MEMPTR_t) buf)-1)) & (sizeof(UVAR_t)-1);
-  if ((i != 0) && ((UINT_t)i < count))
+  if (count >= 2 * MWSIZE)
   {
+    MWORD_t *wb;
+    MWORD_t f;
+    UINT_t  n;
+
+    i = MWHEAD(cb);
     count -= (UINT_t) i;
-#if (MVAR_BITS > 16)
     while (i != 0)
     {
-#endif
       *cb++ = val;
-#if (MVAR_BITS > 16)
       i--;
     }
-#endif
-  }
 
-  if (count >= sizeof(UVAR_t))
-  {
-    UVAR_t *ucb = (UVAR_t*) cb;
-    UVAR_t f = (UVAR_t) val;
-    f |= f << 8;
-#if MVAR_BITS > 16
-    f |= f << 16;
-#endif
-    do
+    /* replicate the fill byte into all bytes of the word */
+    f  = (MWORD_t) (unsigned char) val;
+    f *= ((MWORD_t) ~0) / 0xFF;
+
+    wb = (MWORD_t*) (void*) cb;
+    n  = count / MWSIZE;
+    count -= n * MWSIZE;
+    while (n >= 4)
     {
-      *ucb++ = f;
-      count -= sizeof(UVAR_t);
+      wb[0] = f;
+      wb[1] = f;
+      wb[2] = f;
+      wb[3] = f;
+      wb += 4;
+      n  -= 4;
     }
-    while (count >= sizeof(UVAR_t));
-    cb = (char*) ucb;
+    while (n != 0)
+    {
+      *wb++ = f;
+      n--;
+    }
+    cb = (char*) wb;
   }
 
-  if (count != 0)
+  while (count != 0)
   {
-#if (MVAR_BITS > 16)
-    do
-    {
-#endif
-      *cb = val;
-#if (MVAR_BITS > 16)
-      cb++;
-      count--;
-    }
-    while (count != 0);
-#endif
+    *cb++ = val;
+    count--;
   }
 
 #else
@@ -151,6 +201,73 @@ void POSCALL nosMemSet(void *buf, char val, UINT_t count)
 
 /*-------------------------------------------------------------------------*/
 
+#if defined(NOS_MEMFAST) && \
+    ((NOSCFG_FEATURE_MEMCOPY != 0) || (NOSCFG_FEATURE_MEMMOVE != 0))
+
+/* Copy n words upwards to the aligned destination d.
+ * Returns the count of words copied; this is zero when the source
+ * is misaligned and the byte order of the machine is unknown.
+ */
+static UINT_t POSCALL n_wcopyfwd(MWORD_t *d, char *cs, UINT_t n)
+{
+  MWORD_t *s;
+  UINT_t  c = n;
+#ifdef MWMERGE
+  MWORD_t w0, w1;
+  UVAR_t  sl, sr;
+#endif
+
+  if (MWOFS(cs) == 0)
+  {
+    s = (MWORD_t*) (void*) cs;
+    while (n >= 4)
+    {
+      d[0] = s[0];
+      d[1] = s[1];
+      d[2] = s[2];
+      d[3] = s[3];
+      d += 4;
+      s += 4;
+      n -= 4;
+    }
+    while (n != 0)
+    {
+      *d++ = *s++;
+      n--;
+    }
+    return c;
+  }
+
+#ifdef MWMERGE
+  sl = (UVAR_t) (MWOFS(cs) * 8);
+  sr = (UVAR_t) (MWSIZE * 8) - sl;
+  s  = (MWORD_t*) (void*) (cs - MWOFS(cs));
+  w0 = *s++;
+  while (n >= 2)
+  {
+    w1 = s[0];
+    d[0] = MWMERGE(w0, w1, sl, sr);
+    w0 = s[1];
+    d[1] = MWMERGE(w1, w0, sl, sr);
+    d += 2;
+    s += 2;
+    n -= 2;
+  }
+  if (n != 0)
+  {
+    w1 = *s;
+    *d = MWMERGE(w0, w1, sl, sr);
+  }
+  return c;
+#else
+  return 0;
+#endif
+}
+
+#endif
+
+/*-------------------------------------------------------------------------*/
+
 #if NOSCFG_FEATURE_MEMCOPY != 0
 
 void POSCALL nosMemCopy(void *dst, void *src, UINT_t count)
@@ -158,53 +275,219 @@ void POSCALL nosMemCopy(void *dst, void *src, UINT_t count)
   char   *cd = (char*) dst;
   char   *cs = (char*) src;
 
-#if (MVAR_BITS > 8) && (POSCFG_SMALLCODE == 0) && (POSCFG_FASTCODE != 0)
+#ifdef NOS_MEMFAST
   UVAR_t i;
+  UINT_t n;
 
-  i = (UVAR_t) (~(((MEMPTR_t)src)-1)) & (sizeof(UVAR_t)-1);
-  if ((i == (UVAR_t)((~(((MEMPTR_t)dst)-1)) & (sizeof(UVAR_t)-1))) &&
-      (count > sizeof(UVAR_t)))
+  if (count >= 2 * MWSIZE)
   {
-    if (i != 0)
+    /* align destination */
+    i = MWHEAD(cd);
+    count -= (UINT_t) i;
+    while (i != 0)
     {
-      count -= (UINT_t) i;
-#if (MVAR_BITS > 16)
-      do
-      {
+      *cd++ = *cs++;
+      i--;
+    }
+
+    n = n_wcopyfwd((MWORD_t*) (void*) cd, cs, count / MWSIZE) * MWSIZE;
+    cd += n;
+    cs += n;
+    count -= n;
+  }
 #endif
-        *cd++ = *cs++;
-#if (MVAR_BITS > 16)
-        --i;
-      }
-      while (i != 0);
+
+  while (count != 0)
+  {
+    *cd++ = *cs++;
+    --count;
+  }
+}
+
+#endif /* NOSCFG_FEATURE_MEMCOPY */
+
+/*-------------------------------------------------------------------------*/
+
+#if NOSCFG_FEATURE_MEMMOVE != 0
+
+#ifdef NOS_MEMFAST
+
+/* Copy n words downwards. d points behind the aligned destination words,
+ * cs points behind the source words. Returns the count of words copied.
+ */
+static UINT_t POSCALL n_wcopybwd(MWORD_t *d, char *cs, UINT_t n)
+{
+  MWORD_t *s;
+  UINT_t  c = n;
+#ifdef MWMERGE
+  MWORD_t w0, w1;
+  UVAR_t  sl, sr;
 #endif
+
+  if (MWOFS(cs) == 0)
+  {
+    s = (MWORD_t*) (void*) cs;
+    while (n >= 4)
+    {
+      d -= 4;
+      s -= 4;
+      d[3] = s[3];
+      d[2] = s[2];
+      d[1] = s[1];
+      d[0] = s[0];
+      n -= 4;
     }
+    while (n != 0)
+    {
+      *--d = *--s;
+      n--;
+    }
+    return c;
+  }
 
-    if (count >= sizeof(UVAR_t))
+#ifdef MWMERGE
+  sl = (UVAR_t) (MWOFS(cs) * 8);
+  sr = (UVAR_t) (MWSIZE * 8) - sl;
+  s  = (MWORD_t*) (void*) (cs - MWOFS(cs));
+  w1 = *s;
+  while (n != 0)
+  {
+    w0 = *--s;
+    *--d = MWMERGE(w0, w1, sl, sr);
+    w1 = w0;
+    n--;
+  }
+  return c;
+#else
+  return 0;
+#endif
+}
+
+#endif /* NOS_MEMFAST */
+
+void POSCALL nosMemMove(void *dst, const void *src, UINT_t count)
+{
+  char   *cd = (char*) dst;
+  char   *cs = (char*) src;
+
+  /* copy upwards if the destination does not overlap the source end */
+  if ((MEMPTR_t)(cd - cs) >= (MEMPTR_t) count)
+  {
+    nosMemCopy(cd, cs, count);
+    return;
+  }
+
+  cd += count;
+  cs += count;
+
+#ifdef NOS_MEMFAST
+  if (count >= 2 * MWSIZE)
+  {
+    UVAR_t i;
+    UINT_t n;
+
+    /* align the end of the destination */
+    i = MWOFS(cd);
+    count -= (UINT_t) i;
+    while (i != 0)
+    {
+      *--cd = *--cs;
+      i--;
+    }
+
+    n = n_wcopybwd((MWORD_t*) (void*) cd, cs, count / MWSIZE) * MWSIZE;
+    cd -= n;
+    cs -= n;
+    count -= n;
+  }
+#endif
+
+  while (count != 0)
+  {
+    *--cd = *--cs;
+    --count;
+  }
+}
+
+#endif /* NOSCFG_FEATURE_MEMMOVE */
+
+/*-------------------------------------------------------------------------*/
+
+#if NOSCFG_FEATURE_MEMCMP != 0
+
+VAR_t POSCALL nosMemCmp(const void *buf1, const void *buf2, UINT_t count)
+{
+  const unsigned char *c1 = (const unsigned char*) buf1;
+  const unsigned char *c2 = (const unsigned char*) buf2;
+
+#ifdef NOS_MEMFAST
+  UVAR_t i;
+  UINT_t n, k;
+
+  if (count >= 2 * MWSIZE)
+  {
+    const MWORD_t *w1, *w2;
+
+    i = MWHEAD(c1);
+    count -= (UINT_t) i;
+    while (i != 0)
     {
-      UVAR_t *ucd = (UVAR_t*) cd;
-      UVAR_t *ucs = (UVAR_t*) cs;
-      do
+      if (*c1 != *c2)
+        return (*c1 < *c2) ? -1 : 1;
+      c1++;
+      c2++;
+      i--;
+    }
+
+    /* Compare word by word until a difference is found. The bytes
+       of the differing word are then compared by the loop below. */
+    n = count / MWSIZE;
+    w1 = (const MWORD_t*) (const void*) c1;
+    k = 0;
+    if (MWOFS(c2) == 0)
+    {
+      w2 = (const MWORD_t*) (const void*) c2;
+      while ((k < n) && (w1[k] == w2[k]))
+        k++;
+    }
+#ifdef MWMERGE
+    else
+    {
+      MWORD_t  m0, m1;
+      UVAR_t   sl, sr;
+
+      sl = (UVAR_t) (MWOFS(c2) * 8);
+      sr = (UVAR_t) (MWSIZE * 8) - sl;
+      w2 = (const MWORD_t*) (const void*) (c2 - MWOFS(c2));
+      m0 = *w2++;
+      while (k < n)
       {
-        *ucd++ = *ucs++;
-        count -= sizeof(UVAR_t);
+        m1 = w2[k];
+        if (w1[k] != MWMERGE(m0, m1, sl, sr))
+          break;
+        m0 = m1;
+        k++;
       }
-      while (count >= sizeof(UVAR_t));
-      cd = (char*) ucd;
-      cs = (char*) ucs;
     }
+#endif
+    c1 += k * MWSIZE;
+    c2 += k * MWSIZE;
+    count -= k * MWSIZE;
   }
-
 #endif
 
   while (count != 0)
   {
-    *cd++ = *cs++;
+    if (*c1 != *c2)
+      return (*c1 < *c2) ? -1 : 1;
+    c1++;
+    c2++;
     --count;
   }
+  return 0;
 }
 
-#endif /* NOSCFG_FEATURE_MEMCOPY */
+#endif /* NOSCFG_FEATURE_MEMCMP */
 
 
 
@@ -245,6 +528,24 @@ typedef struct BLOCK_s
 
 static BLOCK_t  freeBlockList_g;
 
+#if NOSCFG_FEATURE_MEMSTATS != 0
+static NOSMEMSTATS_t  memstats_g;
+#define MEMSTAT_USED(s)  \
+  do { memstats_g.usedBytes += (s); memstats_g.freeBytes -= (s); \
+       if (memstats_g.usedBytes > memstats_g.maxUsedBytes) \
+         memstats_g.maxUsedBytes = memstats_g.usedBytes; } while(0)
+#define MEMSTAT_FREED(s) \
+  do { memstats_g.usedBytes -= (s); memstats_g.freeBytes += (s); } while(0)
+#define MEMSTAT_FBLKS(d) memstats_g.freeBlocks += (UINT_t)(d)
+#define MEMSTAT_VALID(p) \
+  ((((MEMPTR_t)(p)) >= BLOCK_STRUCT_SIZE) && \
+   ((((BLOCK_t)(p)) - 1)->h.magic == MEM_MAGIC))
+#else
+#define MEMSTAT_USED(s)  do { } while(0)
+#define MEMSTAT_FREED(s) do { } while(0)
+#define MEMSTAT_FBLKS(d) do { } while(0)
+#endif
+
 /*-------------------------------------------------------------------------*/
 
 void* POSCALL nos_malloc(UINT_t size)
@@ -292,6 +593,7 @@ void* POSCALL nos_malloc(UINT_t size)
   else
   {
     /* take the whole block */
+    MEMSTAT_FBLKS(-1);
     if (bl == NULL)
     {
       freeBlockList_g = bp->h.next;
@@ -303,6 +605,7 @@ void* POSCALL nos_malloc(UINT_t size)
   }
 
   bp->h.magic = MEM_MAGIC;
+  MEMSTAT_USED(bp->size);
   return (void*) (bp + 1);
 }
 
@@ -325,6 +628,7 @@ void POSCALL nos_free(void *mp)
   if (b->h.magic != MEM_MAGIC)
     return;
   b->h.magic = 0;
+  MEMSTAT_FREED(b->size);
 
   /* find neighbour blocks and join them */
 
@@ -386,6 +690,9 @@ void POSCALL nos_free(void *mp)
           lp->h.next = b;
         }
 
+        /* joined with both neighbours: one free block less */
+        if (f)
+          MEMSTAT_FBLKS(-1);
         f = 1;
         break;
       }
@@ -397,6 +704,7 @@ void POSCALL nos_free(void *mp)
 #endif
   {
     /* could not join blocks, simply add to list */
+    MEMSTAT_FBLKS(1);
     b->h.next = freeBlockList_g;
     freeBlockList_g = b;
   }
@@ -439,6 +747,8 @@ static void* POSCALL nos_realloc(void *memblock, UINT_t size)
         if (s >= asize)
         {
           /* allocate the block that is the direct neighbour of memblock */
+          MEMSTAT_FBLKS(-1);
+          MEMSTAT_USED(p->size);
           if (l == NULL)
           {
             freeBlockList_g = p->h.next;
@@ -500,19 +810,254 @@ void POSCALL nos_initMem(void)
   freeBlockList_g->size = 
     (((MEMPTR_t)__heap_end) - ((MEMPTR_t)freeBlockList_g) + 1) &
       ~(POSCFG_ALIGNMENT - 1);
+#if NOSCFG_FEATURE_MEMSTATS != 0
+  memstats_g.heapSize   = freeBlockList_g->size;
+  memstats_g.freeBytes  = freeBlockList_g->size;
+  memstats_g.freeBlocks = 1;
+#endif
 }
 
 #endif  /* NOSCFG_MEM_MANAGER_TYPE == 1 */
 
 /*-------------------------------------------------------------------------*/
 
+#if (NOSCFG_FEATURE_MEMSTATS != 0) && (NOSCFG_MEM_MANAGER_TYPE != 1)
+static NOSMEMSTATS_t  memstats_g;
+#define MEMSTAT_VALID(p) ((p) != NULL)
+#endif
+
+#if NOSCFG_FEATURE_MEMSTATS != 0
+
+/* count allocations, must be called with scheduler locked */
+static void POSCALL n_memStatAlloc(void *p);
+static void POSCALL n_memStatAlloc(void *p)
+{
+  if (p == NULL)
+  {
+    memstats_g.failCount++;
+  }
+  else
+  {
+    memstats_g.allocCount++;
+    memstats_g.usedBlocks++;
+    if (memstats_g.usedBlocks > memstats_g.maxUsedBlocks)
+      memstats_g.maxUsedBlocks = memstats_g.usedBlocks;
+  }
+}
+
+/* count frees, must be called before the heap block is freed */
+#define MEMSTAT_ALLOC(p)  n_memStatAlloc(p)
+#define MEMSTAT_FREE(p) \
+  do { if (MEMSTAT_VALID(p)) { memstats_g.freeCount++; \
+                               memstats_g.usedBlocks--; } } while(0)
+#else
+#define MEMSTAT_ALLOC(p)  do { } while(0)
+#define MEMSTAT_FREE(p)   do { } while(0)
+#endif
+
+/*---------------------------------------------------------------------------
+ *  PER-TASK MEMORY CACHES
+ *
+ * Notes:
+ *   Every task created by nosTaskCreate can own a cache of small memory
+ *   blocks. The cache has one list of free blocks per size class. Only
+ *   the owning task accesses its cache, so blocks can be taken from and
+ *   put into the cache without locking the scheduler. The cache is
+ *   refilled from the heap and flushed back to the heap in batches.
+ *   Every block that is allocated by nosMemAlloc gets a small header
+ *   that stores the size class of the block (0 = not cacheable), this
+ *   allows nosMemFree to put blocks into the cache of the calling task
+ *   regardless of the task the block was allocated by.
+ *-------------------------------------------------------------------------*/
+
+#if NOSCFG_FEATURE_MEMCACHE != 0
+
+#if POSCFG_ALIGNMENT > 1
+#define MC_HDRSIZE  \
+  ((sizeof(UVAR_t) + (POSCFG_ALIGNMENT-1)) & ~(POSCFG_ALIGNMENT - 1))
+#else
+#define MC_HDRSIZE  sizeof(UVAR_t)
+#endif
+#define MC_HDR(p)        (*(UVAR_t*)(void*)(((char*)(p)) - MC_HDRSIZE))
+#define MC_BLKSIZE(c)    (((UINT_t)NOSCFG_MEMCACHE_MINSIZE) << (c))
+#define MC_NEXT(p)       (*(void**)(p))
+
+/* marks the cache of a task that has already called nos_memCacheExit */
+static UVAR_t memCacheExited_g;
+#define MC_EXITED        ((void*) &memCacheExited_g)
+
+typedef struct {
+  void    *list[NOSCFG_MEMCACHE_CLASSES];
+  UVAR_t   count[NOSCFG_MEMCACHE_CLASSES];
+} MEMCACHE_t;
+
+void POSCALL nos_memCacheExit(POSTASK_t task);
+static void* POSCALL n_heapAlloc(UINT_t size, UVAR_t tag);
+static MEMCACHE_t* POSCALL n_memCacheGet(void);
+static void POSCALL n_memCacheRefill(MEMCACHE_t *mc, UVAR_t c);
+static void POSCALL n_memCacheFlush(MEMCACHE_t *mc, UVAR_t c, UVAR_t keep);
+
+#define HEAP_ALLOC(s)    n_heapAlloc(s, 0)
+#define HEAP_PTR(p)      ((void*)(((char*)(p)) - MC_HDRSIZE))
+#define HEAP_FREE(p)     NOS_MEM_FREE(HEAP_PTR(p))
+
+/* allocate a block with header from the heap, scheduler must be locked */
+static void* POSCALL n_heapAlloc(UINT_t size, UVAR_t tag)
+{
+  char *p;
+
+  if (size == 0)
+    return NULL;
+
+  p = (char*) NOS_MEM_ALLOC(size + MC_HDRSIZE);
+  if (p == NULL)
+    return NULL;
+
+  *(UVAR_t*)(void*)p = tag;
+  return (void*) (p + MC_HDRSIZE);
+}
+
+/* return the cache of the current task, create it if necessary */
+static MEMCACHE_t* POSCALL n_memCacheGet(void)
+{
+  POSTASK_t   task = posCurrentTask_g;
+  MEMCACHE_t  *mc;
+  UVAR_t      c;
+
+  if ((posRunning_g == 0) || (posInInterrupt_g != 0) ||
+      (task->exithook != nos_taskExitHook))
+    return NULL;
+
+  /* a terminating task uses the heap directly */
+  if (task->nosmemcache == MC_EXITED)
+    return NULL;
+
+  mc = (MEMCACHE_t*) task->nosmemcache;
+  if (mc == NULL)
+  {
+    posTaskSchedLock();
+    mc = (MEMCACHE_t*) NOS_MEM_ALLOC(sizeof(MEMCACHE_t));
+    MEMSTAT_ALLOC(mc);
+    posTaskSchedUnlock();
+    if (mc != NULL)
+    {
+      for (c = 0; c < NOSCFG_MEMCACHE_CLASSES; ++c)
+      {
+        mc->list[c]  = NULL;
+        mc->count[c] = 0;
+      }
+      task->nosmemcache = (void*) mc;
+    }
+  }
+  return mc;
+}
+
+/* move a batch of new blocks from the heap into the cache */
+static void POSCALL n_memCacheRefill(MEMCACHE_t *mc, UVAR_t c)
+{
+  void   *p;
+  UVAR_t i;
+
+  posTaskSchedLock();
+  for (i = 0; i < NOSCFG_MEMCACHE_BATCH; ++i)
+  {
+    p = n_heapAlloc(MC_BLKSIZE(c), (UVAR_t)(c + 1));
+    if (p == NULL)
+      break;
+    MEMSTAT_ALLOC(p);
+    MC_NEXT(p) = mc->list[c];
+    mc->list[c] = p;
+    mc->count[c]++;
+  }
+  posTaskSchedUnlock();
+}
+
+/* give blocks back to the heap until 'keep' blocks are left in the cache */
+static void POSCALL n_memCacheFlush(MEMCACHE_t *mc, UVAR_t c, UVAR_t keep)
+{
+  void *p;
+
+  posTaskSchedLock();
+  while (mc->count[c] > keep)
+  {
+    p = mc->list[c];
+    mc->list[c] = MC_NEXT(p);
+    mc->count[c]--;
+    MEMSTAT_FREE(HEAP_PTR(p));
+    HEAP_FREE(p);
+  }
+  posTaskSchedUnlock();
+}
+
+/* free the cache of a terminating task, called by the task exit hook */
+void POSCALL nos_memCacheExit(POSTASK_t task)
+{
+  MEMCACHE_t  *mc = (MEMCACHE_t*) task->nosmemcache;
+  UVAR_t      c;
+
+  if (mc == MC_EXITED)
+    return;
+
+  /* Blocks that are freed later by the exit hooks must not create
+     a new cache, the cache would never be freed again. */
+  task->nosmemcache = MC_EXITED;
+  if (mc == NULL)
+    return;
+
+  for (c = 0; c < NOSCFG_MEMCACHE_CLASSES; ++c)
+  {
+    n_memCacheFlush(mc, c, 0);
+  }
+  posTaskSchedLock();
+  MEMSTAT_FREE(mc);
+  NOS_MEM_FREE(mc);
+  posTaskSchedUnlock();
+}
+
+#else /* NOSCFG_FEATURE_MEMCACHE */
+
+#define HEAP_ALLOC(s)    NOS_MEM_ALLOC(s)
+#define HEAP_PTR(p)      (p)
+#define HEAP_FREE(p)     NOS_MEM_FREE(p)
+
+#endif /* NOSCFG_FEATURE_MEMCACHE */
+
+/*-------------------------------------------------------------------------*/
+
 void* POSCALL nosMemAlloc(UINT_t size)
 {
   void *p;
+#if NOSCFG_FEATURE_MEMCACHE != 0
+  MEMCACHE_t  *mc;
+  UVAR_t      c;
+
+  if ((size != 0) && (size <= MC_BLKSIZE(NOSCFG_MEMCACHE_CLASSES - 1)))
+  {
+    mc = n_memCacheGet();
+    if (mc != NULL)
+    {
+      for (c = 0; MC_BLKSIZE(c) < size; ++c);
+      if (mc->list[c] == NULL)
+        n_memCacheRefill(mc, c);
+      p = mc->list[c];
+      if (p != NULL)
+      {
+        mc->list[c] = MC_NEXT(p);
+        mc->count[c]--;
+        return p;
+      }
+    }
+  }
+#endif
   if (posRunning_g == 0)
-    return NOS_MEM_ALLOC(size);
+  {
+    p = HEAP_ALLOC(size);
+    MEMSTAT_ALLOC(p);
+    return p;
+  }
   posTaskSchedLock();
-  p = NOS_MEM_ALLOC(size);
+  p = HEAP_ALLOC(size);
+  MEMSTAT_ALLOC(p);
   posTaskSchedUnlock();
   return p;
 }
@@ -521,8 +1066,34 @@ void* POSCALL nosMemAlloc(UINT_t size)
 
 void POSCALL nosMemFree(void *p)
 {
+#if NOSCFG_FEATURE_MEMCACHE != 0
+  MEMCACHE_t  *mc;
+  UVAR_t      c;
+
+  if (p == NULL)
+    return;
+
+  c = MC_HDR(p);
+  if (c != 0)
+  {
+    mc = n_memCacheGet();
+    if (mc != NULL)
+    {
+      --c;
+      MC_NEXT(p) = mc->list[c];
+      mc->list[c] = p;
+      if (++(mc->count[c]) > NOSCFG_MEMCACHE_MAXBLOCKS)
+      {
+        n_memCacheFlush(mc, c,
+                        NOSCFG_MEMCACHE_MAXBLOCKS - NOSCFG_MEMCACHE_BATCH);
+      }
+      return;
+    }
+  }
+#endif
   posTaskSchedLock();
-  NOS_MEM_FREE(p);
+  MEMSTAT_FREE(HEAP_PTR(p));
+  HEAP_FREE(p);
   posTaskSchedUnlock();
 }
 
@@ -533,8 +1104,53 @@ void POSCALL nosMemFree(void *p)
 void* POSCALL nosMemRealloc(void *memblock, UINT_t size)
 {
   void *p;
+#if NOSCFG_FEATURE_MEMCACHE != 0
+  UINT_t  s;
+
+  if (memblock == NULL)
+    return NULL;
+
+  if (size == 0)
+  {
+    nosMemFree(memblock);
+    return NULL;
+  }
+
+  if (MC_HDR(memblock) != 0)
+  {
+    /* cached blocks have a fixed size, move the content to a new block */
+    s = MC_BLKSIZE(MC_HDR(memblock) - 1);
+    if (size <= s)
+      return memblock;
+    p = nosMemAlloc(size);
+    if (p != NULL)
+    {
+      nosMemCopy(p, memblock, s);
+      nosMemFree(memblock);
+    }
+    return p;
+  }
+
+  posTaskSchedLock();
+  p = nos_realloc(((char*)memblock) - MC_HDRSIZE, size + MC_HDRSIZE);
+  if (p != NULL)
+  {
+    p = (void*) (((char*)p) + MC_HDRSIZE);
+  }
+#else
   posTaskSchedLock();
+  if (size == 0)
+  {
+    MEMSTAT_FREE(memblock);
+  }
   p = nos_realloc(memblock, size);
+#endif
+#if NOSCFG_FEATURE_MEMSTATS != 0
+  if ((p == NULL) && (memblock != NULL) && (size != 0))
+  {
+    memstats_g.failCount++;
+  }
+#endif
   posTaskSchedUnlock();
   return p;
 }
@@ -543,6 +1159,202 @@ void* POSCALL nosMemRealloc(void *memblock, UINT_t size)
 
 /*-------------------------------------------------------------------------*/
 
+#if NOSCFG_FEATURE_MEMSTATS != 0
+
+VAR_t POSCALL nosMemStats(NOSMEMSTATS_t *stats)
+{
+#if NOSCFG_MEM_MANAGER_TYPE == 1
+  BLOCK_t  p;
+  UINT_t   l = 0;
+#endif
+
+  if (stats == NULL)
+    return -E_ARG;
+
+  posTaskSchedLock();
+#if NOSCFG_MEM_MANAGER_TYPE == 1
+  for (p = freeBlockList_g; p != NULL; p = p->h.next)
+  {
+    if (p->size > l)
+      l = p->size;
+  }
+  memstats_g.largestFree = l;
+#endif
+  *stats = memstats_g;
+  posTaskSchedUnlock();
+  return E_OK;
+}
+
+#if NOSCFG_FEATURE_USERREG != 0
+
+void POSCALL nos_regMemStats(void)
+{
+  KEYVALUE_t kv;
+  kv.voidptr = (void*) &memstats_g;
+  (void) nosRegSet(NOS_MEMSTATS_REGKEY, kv);
+}
+
+#endif
+#endif /* NOSCFG_FEATURE_MEMSTATS */
+
+
+
+/*---------------------------------------------------------------------------
+ *  STACK CACHE
+ *
+ * Notes:
+ *   Task stacks are allocated in size classes of NOSCFG_STKCACHE_GRANULE
+ *   bytes. When a task terminates, its stack is kept in a list per size
+ *   class (up to NOSCFG_STKCACHE_MAXSTACKS stacks in total), so the next
+ *   task with a stack of the same size class gets its stack without
+ *   searching the heap. Each stack has a small header that holds the
+ *   list pointer and the size class. The header is placed below the
+ *   stack memory, so a terminating task may still use its stack while
+ *   the stack is put into the cache.
+ *   nos_stackAlloc and nos_stackFree are called with the scheduler
+ *   locked (by the nano layer) or with interrupts disabled (by the port
+ *   functions p_pos_initTask and p_pos_freeStack).
+ *-------------------------------------------------------------------------*/
+
+#if NOSCFG_FEATURE_STACKCACHE != 0
+
+typedef struct STKHDR_s {
+  struct STKHDR_s *next;
+  UVAR_t          cls;
+} STKHDR_t;
+
+#if POSCFG_ALIGNMENT > 1
+#define SC_HDRSIZE  \
+  ((sizeof(STKHDR_t) + (POSCFG_ALIGNMENT-1)) & ~(POSCFG_ALIGNMENT - 1))
+#else
+#define SC_HDRSIZE  sizeof(STKHDR_t)
+#endif
+
+static STKHDR_t  *stkCache_g[NOSCFG_STKCACHE_CLASSES];
+static UVAR_t    stkCacheCount_g = 0;
+
+static void POSCALL n_stackCacheRelease(void);
+
+/*-------------------------------------------------------------------------*/
+
+static void POSCALL n_stackCacheRelease(void)
+{
+  STKHDR_t  *h;
+  UVAR_t    c;
+
+  for (c = 0; c < NOSCFG_STKCACHE_CLASSES; ++c)
+  {
+    while (stkCache_g[c] != NULL)
+    {
+      h = stkCache_g[c];
+      stkCache_g[c] = h->next;
+      MEMSTAT_FREE(h);
+      NOS_MEM_FREE(h);
+    }
+  }
+  stkCacheCount_g = 0;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void* POSCALL nos_stackAlloc(UINT_t size)
+{
+  STKHDR_t  *h;
+  UINT_t    c;
+
+  c = (size + (NOSCFG_STKCACHE_GRANULE - 1)) / NOSCFG_STKCACHE_GRANULE;
+  if ((c != 0) && (c <= NOSCFG_STKCACHE_CLASSES))
+  {
+    h = stkCache_g[c - 1];
+    if (h != NULL)
+    {
+      stkCache_g[c - 1] = h->next;
+      --stkCacheCount_g;
+      return (void*) (((char*)h) + SC_HDRSIZE);
+    }
+    size = c * NOSCFG_STKCACHE_GRANULE;
+  }
+  else
+  {
+    c = 0;
+  }
+
+  h = (STKHDR_t*) NOS_MEM_ALLOC(size + SC_HDRSIZE);
+  if ((h == NULL) && (stkCacheCount_g != 0))
+  {
+    /* heap exhausted, give the cached stacks back and try again */
+    n_stackCacheRelease();
+    h = (STKHDR_t*) NOS_MEM_ALLOC(size + SC_HDRSIZE);
+  }
+  MEMSTAT_ALLOC(h);
+  if (h == NULL)
+    return NULL;
+
+  h->cls = (UVAR_t) c;
+  return (void*) (((char*)h) + SC_HDRSIZE);
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL nos_stackFree(void *stk)
+{
+  STKHDR_t  *h;
+
+  if (stk == NULL)
+    return;
+
+  h = (STKHDR_t*) (void*) (((char*)stk) - SC_HDRSIZE);
+  if ((h->cls != 0) && (stkCacheCount_g < NOSCFG_STKCACHE_MAXSTACKS))
+  {
+    h->next = stkCache_g[h->cls - 1];
+    stkCache_g[h->cls - 1] = h;
+    ++stkCacheCount_g;
+  }
+  else
+  {
+    MEMSTAT_FREE(h);
+    NOS_MEM_FREE(h);
+  }
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL nosStackCacheFlush(void)
+{
+  posTaskSchedLock();
+  n_stackCacheRelease();
+  posTaskSchedUnlock();
+}
+
+#elif NOSCFG_FEATURE_MEMSTATS != 0
+
+/* Without the stack cache, the stack functions are
+   only needed to count the stacks in the statistics. */
+
+void* POSCALL nos_stackAlloc(UINT_t size)
+{
+  void *stk;
+
+  stk = NOS_MEM_ALLOC(size);
+  MEMSTAT_ALLOC(stk);
+  return stk;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL nos_stackFree(void *stk)
+{
+  if (stk == NULL)
+    return;
+
+  MEMSTAT_FREE(stk);
+  NOS_MEM_FREE(stk);
+}
+
+#endif /* NOSCFG_FEATURE_STACKCACHE */
+
+/*-------------------------------------------------------------------------*/
+
 #else  /* NOSCFG_FEATURE_MEMALLOC != 0 */
 
 /* this is just a dummy function */
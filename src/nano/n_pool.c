@@ -0,0 +1,387 @@
+/*
+ *  Copyright (c) 2004-2012, Dennis Kuschel.
+ *  All rights reserved. 
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. The name of the author may not be used to endorse or promote
+ *      products derived from this software without specific prior written
+ *      permission. 
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ *  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ *  INDIRECT,  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ *  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ *  OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @file   n_pool.c
+ * @brief  nano layer, task pools
+ * @author Dennis Kuschel
+ *
+ * This file is originally from the pico]OS realtime operating system
+ * (http://picoos.sourceforge.net).
+ */
+
+#define _N_POOL_C
+#include "../src/nano/privnano.h"
+
+#if NOSCFG_FEATURE_TASKPOOL != 0
+
+/* check features */
+#if POSCFG_FEATURE_INHIBITSCHED == 0
+#error POSCFG_FEATURE_INHIBITSCHED not enabled
+#endif
+#if POSCFG_FEATURE_SEMAPHORES == 0
+#error POSCFG_FEATURE_SEMAPHORES not enabled
+#endif
+#if POSCFG_FEATURE_SEMADESTROY == 0
+#error POSCFG_FEATURE_SEMADESTROY not enabled
+#endif
+#if POSCFG_FEATURE_EXIT == 0
+#error POSCFG_FEATURE_EXIT not enabled
+#endif
+#if NOSCFG_FEATURE_TASKCREATE == 0
+#error NOSCFG_FEATURE_TASKCREATE not enabled
+#endif
+#if NOSCFG_FEATURE_MEMALLOC == 0
+#error NOSCFG_FEATURE_MEMALLOC not enabled
+#endif
+
+
+
+/*---------------------------------------------------------------------------
+ *  TYPEDEFS
+ *-------------------------------------------------------------------------*/
+
+#define JOB_QUEUED    0
+#define JOB_DONE      1
+#define JOB_RELEASED  2
+
+struct nosjob {
+  struct nosjob   *next;
+  NOSJOBFUNC_t    func;
+  void            *arg;
+  void            *result;
+  POSSEMA_t       donesema;   /* created when a task waits for the job */
+  UVAR_t          state;
+  UVAR_t          waiting;    /* set while a task waits for the job,
+                                 2 = released during the wait */
+};
+
+struct nospool {
+  struct nosjob   *first;     /* queue of pending jobs */
+  struct nosjob   *last;
+  POSSEMA_t       jobsema;    /* counts pending jobs and exit requests */
+  POSSEMA_t       exitsema;   /* signalled by terminating workers */
+  UVAR_t          workers;    /* count of running worker tasks */
+  UVAR_t          joining;
+};
+
+
+
+/*---------------------------------------------------------------------------
+ *  FUNCTION PROTOTYPES
+ *-------------------------------------------------------------------------*/
+
+static void nos_poolWorker(void *arg);
+static void POSCALL nos_poolFree(NOSPOOL_t pool);
+
+
+
+/*---------------------------------------------------------------------------
+ *  WORKER TASK
+ *-------------------------------------------------------------------------*/
+
+static void nos_poolWorker(void *arg)
+{
+  NOSPOOL_t  pool = (NOSPOOL_t) arg;
+  NOSJOB_t   job;
+  void       *r;
+
+  for (;;)
+  {
+    (void) posSemaGet(pool->jobsema);
+
+    posTaskSchedLock();
+    job = pool->first;
+    if (job == NULL)
+    {
+      /* no more jobs, the pool is being joined */
+      pool->workers--;
+      (void) posSemaSignal(pool->exitsema);
+      posTaskSchedUnlock();
+      return;
+    }
+    pool->first = job->next;
+    if (pool->first == NULL)
+      pool->last = NULL;
+    posTaskSchedUnlock();
+
+    r = (job->func)(job->arg);
+
+    posTaskSchedLock();
+    if (job->state == JOB_RELEASED)
+    {
+      if (job->donesema != NULL)
+        posSemaDestroy(job->donesema);
+      nosMemFree(job);
+    }
+    else
+    {
+      job->result = r;
+      job->state  = JOB_DONE;
+      if (job->donesema != NULL)
+        (void) posSemaSignal(job->donesema);
+    }
+    posTaskSchedUnlock();
+  }
+}
+
+
+
+/*---------------------------------------------------------------------------
+ *  TASK POOL FUNCTIONS
+ *-------------------------------------------------------------------------*/
+
+static void POSCALL nos_poolFree(NOSPOOL_t pool)
+{
+  posSemaDestroy(pool->exitsema);
+  posSemaDestroy(pool->jobsema);
+  nosMemFree(pool);
+}
+
+/*-------------------------------------------------------------------------*/
+
+NOSPOOL_t POSCALL nosPoolCreate(UVAR_t workers, VAR_t priority,
+                                UINT_t stacksize)
+{
+  NOSPOOL_t  pool;
+  UVAR_t     i;
+
+  if (workers == 0)
+    return NULL;
+
+  pool = (NOSPOOL_t) nosMemAlloc(sizeof(struct nospool));
+  if (pool == NULL)
+    return NULL;
+
+  pool->first    = NULL;
+  pool->last     = NULL;
+  pool->workers  = 0;
+  pool->joining  = 0;
+  pool->jobsema  = posSemaCreate(0);
+  pool->exitsema = posSemaCreate(0);
+  if ((pool->jobsema == NULL) || (pool->exitsema == NULL))
+  {
+    if (pool->jobsema != NULL)
+      posSemaDestroy(pool->jobsema);
+    if (pool->exitsema != NULL)
+      posSemaDestroy(pool->exitsema);
+    nosMemFree(pool);
+    return NULL;
+  }
+
+  for (i = 0; i < workers; ++i)
+  {
+    if (nosTaskCreate(nos_poolWorker, (void*) pool, priority,
+                      stacksize, NULL) == NULL)
+    {
+      /* terminate the workers created so far and free the pool */
+      (void) nosPoolJoin(pool);
+      return NULL;
+    }
+    posTaskSchedLock();
+    pool->workers++;
+    posTaskSchedUnlock();
+  }
+  return pool;
+}
+
+/*-------------------------------------------------------------------------*/
+
+NOSJOB_t POSCALL nosPoolSubmit(NOSPOOL_t pool, NOSJOBFUNC_t func,
+                               void *arg)
+{
+  NOSJOB_t  job;
+
+  if ((pool == NULL) || (func == NULL))
+    return NULL;
+
+  job = (NOSJOB_t) nosMemAlloc(sizeof(struct nosjob));
+  if (job == NULL)
+    return NULL;
+
+  job->next     = NULL;
+  job->func     = func;
+  job->arg      = arg;
+  job->result   = NULL;
+  job->donesema = NULL;
+  job->state    = JOB_QUEUED;
+  job->waiting  = 0;
+
+  posTaskSchedLock();
+  if (pool->joining != 0)
+  {
+    posTaskSchedUnlock();
+    nosMemFree(job);
+    return NULL;
+  }
+  if (pool->last == NULL)
+  {
+    pool->first = job;
+  }
+  else
+  {
+    pool->last->next = job;
+  }
+  pool->last = job;
+  (void) posSemaSignal(pool->jobsema);
+  posTaskSchedUnlock();
+  return job;
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL nosJobWait(NOSJOB_t job, UINT_t timeoutticks, void **result)
+{
+  POSSEMA_t  sema;
+  VAR_t      status;
+  UVAR_t     released;
+
+  if (job == NULL)
+    return -E_ARG;
+
+  posTaskSchedLock();
+  if (job->waiting != 0)
+  {
+    /* the first waiter frees the job, so a second one is refused */
+    posTaskSchedUnlock();
+    return -E_FORB;
+  }
+  if (job->state != JOB_DONE)
+  {
+    if (timeoutticks == 0)
+    {
+      posTaskSchedUnlock();
+      return 1;
+    }
+    if (job->donesema == NULL)
+    {
+      job->donesema = posSemaCreate(0);
+      if (job->donesema == NULL)
+      {
+        posTaskSchedUnlock();
+        return -E_NOMORE;
+      }
+    }
+    sema = job->donesema;
+    job->waiting = 1;
+    posTaskSchedUnlock();
+
+#if POSCFG_FEATURE_SEMAWAIT != 0
+    status = posSemaWait(sema, timeoutticks);
+#else
+    status = posSemaGet(sema);
+#endif
+
+    posTaskSchedLock();
+    released = (job->waiting == 2);
+    job->waiting = 0;
+    if (status != 0)
+    {
+      posTaskSchedUnlock();
+      /* the handle was released by another task while we waited */
+      if (released)
+        nosJobRelease(job);
+      return status;
+    }
+  }
+
+  if (result != NULL)
+    *result = job->result;
+  if (job->donesema != NULL)
+    posSemaDestroy(job->donesema);
+  nosMemFree(job);
+  posTaskSchedUnlock();
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL nosJobRelease(NOSJOB_t job)
+{
+  if (job == NULL)
+    return;
+
+  posTaskSchedLock();
+  if (job->waiting != 0)
+  {
+    /* the waiting task frees the job */
+    job->waiting = 2;
+  }
+  else
+  if (job->state == JOB_DONE)
+  {
+    if (job->donesema != NULL)
+      posSemaDestroy(job->donesema);
+    nosMemFree(job);
+  }
+  else
+  {
+    job->state = JOB_RELEASED;
+  }
+  posTaskSchedUnlock();
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL nosPoolJoin(NOSPOOL_t pool)
+{
+  UVAR_t  i, n;
+
+  if (pool == NULL)
+    return -E_ARG;
+
+  /* Wake every worker once more. A worker terminates when it
+     finds the job queue empty, so all pending jobs are done first. */
+  posTaskSchedLock();
+  if (pool->joining != 0)
+  {
+    posTaskSchedUnlock();
+    return -E_ARG;
+  }
+  pool->joining = 1;
+  n = pool->workers;
+  for (i = 0; i < n; ++i)
+  {
+    (void) posSemaSignal(pool->jobsema);
+  }
+  posTaskSchedUnlock();
+
+  for (i = 0; i < n; ++i)
+  {
+    (void) posSemaGet(pool->exitsema);
+  }
+
+  nos_poolFree(pool);
+  return E_OK;
+}
+
+#endif /* NOSCFG_FEATURE_TASKPOOL */
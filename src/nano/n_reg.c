@@ -560,6 +560,54 @@ VAR_t POSCALL nosRegQueryElem(NOSREGQHANDLE_t qh, NOSGENERICHANDLE_t *genh,
 }
 
 
+#if POSCFG_FEATURE_STATISTICS != 0
+
+VAR_t POSCALL nosRegQueryStats(NOSREGQHANDLE_t qh, NOSOBJSTATS_t *stats)
+{
+  REGQUERY_t rq = (REGQUERY_t) qh;
+  REGELEM_t re;
+  VAR_t status;
+
+  if ((rq == NULL) || (stats == NULL) || (rq->queryElem == NULL))
+    return -E_ARG;
+
+  posSemaGet(reglist_sema_g);
+
+  re = rq->queryElem;
+  if (!IS_VISIBLE(re))
+  {
+    posSemaSignal(reglist_sema_g);
+    return -E_NOTFOUND;
+  }
+
+  switch (rq->type)
+  {
+    case REGTYPE_TASK:
+      status = posTaskGetStats(re->handle.tsk, &stats->task);
+      break;
+#if NOSCFG_FEATURE_SEMAPHORES != 0
+    case REGTYPE_SEMAPHORE:
+#endif
+#if NOSCFG_FEATURE_MUTEXES != 0
+    case REGTYPE_MUTEX:
+#endif
+#if NOSCFG_FEATURE_FLAGS != 0
+    case REGTYPE_FLAG:
+#endif
+      status = posEventGetStats(re->handle.generic, &stats->event);
+      break;
+    default:
+      status = -E_NOTFOUND;
+      break;
+  }
+
+  posSemaSignal(reglist_sema_g);
+  return status;
+}
+
+#endif /* POSCFG_FEATURE_STATISTICS */
+
+
 void POSCALL nosRegQueryEnd(NOSREGQHANDLE_t qh)
 {
   REGQUERY_t rq = (REGQUERY_t) qh;
@@ -582,6 +630,174 @@ void POSCALL nosRegQueryEnd(NOSREGQHANDLE_t qh)
 /*-------------------------------------------------------------------------*/
 
 
+#if (NOSCFG_FEATURE_MUTEXES != 0) && (POSCFG_FEATURE_MUTEXPROF != 0) && \
+    (NOSCFG_FEATURE_PRINTF != 0)
+
+typedef struct {
+  POSMUTEXPROF_t  prof;
+  char            name[NOS_MAX_REGKEYLEN+1];
+} MUTEXPROF_t;
+
+#define CYC2USEC(c)  ((UINT_t)(((POSTIME_t)(c) * 1000000) / POS_CYCLES_HZ))
+
+void POSCALL nosMutexProfDump(void)
+{
+  MUTEXPROF_t *mp, tmp;
+  REGELEM_t re;
+  UINT_t n, i, j;
+  char tname[NOS_MAX_REGKEYLEN+1];
+
+  posSemaGet(reglist_sema_g);
+  n = 0;
+  for (re = reglist_syselem_g[REGTYPE_MUTEX]; re != NULL; re = re->next)
+  {
+    if (IS_VISIBLE(re))
+      ++n;
+  }
+  posSemaSignal(reglist_sema_g);
+  if (n == 0)
+    return;
+
+  mp = (MUTEXPROF_t*) nosMemAlloc(n * sizeof(MUTEXPROF_t));
+  if (mp == NULL)
+    return;
+
+  /* copy the records, mutexes may have been created meanwhile */
+  posSemaGet(reglist_sema_g);
+  i = 0;
+  for (re = reglist_syselem_g[REGTYPE_MUTEX];
+       (re != NULL) && (i < n); re = re->next)
+  {
+    if (IS_VISIBLE(re) &&
+        (posMutexGetProf(re->handle.mtx, &mp[i].prof) == E_OK))
+    {
+      for (j=0; (j < NOS_MAX_REGKEYLEN) && (re->name[j] != 0); ++j)
+      {
+        mp[i].name[j] = re->name[j];
+      }
+      mp[i].name[j] = 0;
+      ++i;
+    }
+  }
+  posSemaSignal(reglist_sema_g);
+  n = i;
+
+  /* sort by the total wait time, longest first */
+  for (i = 1; i < n; ++i)
+  {
+    tmp = mp[i];
+    for (j = i; (j > 0) && (mp[j-1].prof.waittotal < tmp.prof.waittotal); --j)
+    {
+      mp[j] = mp[j-1];
+    }
+    mp[j] = tmp;
+  }
+
+  for (i = 0; i < n; ++i)
+  {
+    nosPrintf3("%s: locks %u, blocked %u", mp[i].name,
+               mp[i].prof.locks, mp[i].prof.contended);
+    nosPrintf4(", wait %u/%u us, hold %u/%u us",
+               CYC2USEC(mp[i].prof.waittotal), CYC2USEC(mp[i].prof.waitmax),
+               CYC2USEC(mp[i].prof.holdtotal), CYC2USEC(mp[i].prof.holdmax));
+    if ((mp[i].prof.maxholder == NULL) ||
+        (nosGetNameByHandle(mp[i].prof.maxholder, tname, sizeof(tname),
+                            REGTYPE_TASK) != E_OK))
+    {
+      tname[0] = '-';
+      tname[1] = 0;
+    }
+    nosPrintf1(", longest held by %s\n", tname);
+  }
+
+  nosMemFree(mp);
+}
+
+#endif /* NOSCFG_FEATURE_MUTEXES && POSCFG_FEATURE_MUTEXPROF &&
+          NOSCFG_FEATURE_PRINTF */
+
+
+/*-------------------------------------------------------------------------*/
+
+
+#if NOSCFG_FEATURE_STATPAGE != 0
+
+#if POSCFG_FEATURE_HRTIME != 0
+#define CYC2USEC_LL(c) \
+  ((unsigned long long)(((POSTIME_t)(c) * 1000000) / POS_CYCLES_HZ))
+#endif
+
+UINT_t POSCALL nos_regStatPageTasks(NOSSTATTASK_t *ti, UINT_t maxtasks)
+{
+#if POSCFG_FEATURE_STATISTICS != 0
+  POSTASKSTATS_t st;
+#endif
+  REGELEM_t re;
+  UINT_t n, j;
+
+  n = 0;
+  posSemaGet(reglist_sema_g);
+  for (re = reglist_syselem_g[REGTYPE_TASK];
+       (re != NULL) && (n < maxtasks); re = re->next)
+  {
+    if (!IS_VISIBLE(re))
+      continue;
+
+    ti->handle = (unsigned long) (MEMPTR_t) re->handle.tsk;
+#if POSCFG_FEATURE_GETPRIORITY != 0
+    ti->priority = (long) posTaskGetPriority(re->handle.tsk);
+#else
+    ti->priority = -1;
+#endif
+#if POSCFG_FEATURE_STATISTICS != 0
+    if (posTaskGetStats(re->handle.tsk, &st) == E_OK)
+    {
+      /* NOSSTATTASK_xxx and POSTASKRUN_xxx have the same values */
+      ti->state    = (unsigned long) st.state;
+      ti->switches = st.switches;
+      ti->wakeups  = st.wakeups;
+      ti->timeouts = st.timeouts;
+      ti->msgcount = st.msgcount;
+      ti->msgmax   = st.msgmax;
+#if POSCFG_FEATURE_HRTIME != 0
+      ti->cputime  = CYC2USEC_LL(st.runcycles);
+#else
+      ti->cputime  = NOSSTATPAGE_NA;
+#endif
+    }
+    else
+#endif
+    {
+      ti->state    = NOSSTATPAGE_NA;
+      ti->switches = NOSSTATPAGE_NA;
+      ti->wakeups  = NOSSTATPAGE_NA;
+      ti->timeouts = NOSSTATPAGE_NA;
+      ti->msgcount = NOSSTATPAGE_NA;
+      ti->msgmax   = NOSSTATPAGE_NA;
+      ti->cputime  = NOSSTATPAGE_NA;
+    }
+    for (j = 0; (j < NOS_MAX_REGKEYLEN) && (j < NOSSTATPAGE_NAMELEN - 1) &&
+                (re->name[j] != 0); ++j)
+    {
+      ti->name[j] = re->name[j];
+    }
+    for (; j < NOSSTATPAGE_NAMELEN; ++j)
+    {
+      ti->name[j] = 0;
+    }
+    ++ti;
+    ++n;
+  }
+  posSemaSignal(reglist_sema_g);
+  return n;
+}
+
+#endif /* NOSCFG_FEATURE_STATPAGE */
+
+
+/*-------------------------------------------------------------------------*/
+
+
 NOSGENERICHANDLE_t POSCALL nosGetHandleByName(NOSREGTYPE_t objtype, 
                                               const char *objname)
 {
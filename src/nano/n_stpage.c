@@ -0,0 +1,257 @@
+/*
+ *  Copyright (c) 2004-2012, Dennis Kuschel.
+ *  All rights reserved. 
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. The name of the author may not be used to endorse or promote
+ *      products derived from this software without specific prior written
+ *      permission. 
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ *  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ *  INDIRECT,  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ *  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ *  OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @file   n_stpage.c
+ * @brief  nano layer, statistics page
+ * @author Dennis Kuschel
+ *
+ * This file is originally from the pico]OS realtime operating system
+ * (http://picoos.sourceforge.net).
+ */
+
+#define _N_STPAGE_C
+#include "../src/nano/privnano.h"
+
+#if NOSCFG_FEATURE_STATPAGE != 0
+
+/* check features */
+#if POSCFG_FEATURE_SLEEP == 0
+#error POSCFG_FEATURE_SLEEP not enabled
+#endif
+#if NOSCFG_FEATURE_MEMALLOC == 0
+#error NOSCFG_FEATURE_MEMALLOC not enabled
+#endif
+
+#if defined(NOSCFG_STATPAGE_SHMNAME) && !defined(NOS_STATPAGE_MAP)
+#error NOSCFG_STATPAGE_SHMNAME requires a port that defines NOS_STATPAGE_MAP
+#endif
+
+
+
+/*---------------------------------------------------------------------------
+ *  MACROS AND VARIABLES
+ *-------------------------------------------------------------------------*/
+
+#ifndef NOS_MEMBARRIER
+#ifdef __GNUC__
+#define NOS_MEMBARRIER()  __sync_synchronize()
+#else
+#define NOS_MEMBARRIER()  do { } while(0)
+#endif
+#endif
+
+static NOSSTATPAGE_t  *statpage_g = NULL;
+static NOSSTATPAGE_t  *statshadow_g;
+static UINT_t         statperiod_g;
+
+
+
+/*---------------------------------------------------------------------------
+ *  FUNCTION PROTOTYPES
+ *-------------------------------------------------------------------------*/
+
+static void nos_statPageTask(void *arg);
+static void POSCALL nos_statPageFill(NOSSTATPAGE_t *pg);
+static void POSCALL nos_statPagePublish(NOSSTATPAGE_t *pg,
+                                        NOSSTATPAGE_t *shadow);
+
+
+
+/*---------------------------------------------------------------------------
+ *  STATISTICS PAGE TASK
+ *-------------------------------------------------------------------------*/
+
+/* Collects the statistics into the private copy of the page.
+ */
+static void POSCALL nos_statPageFill(NOSSTATPAGE_t *pg)
+{
+#if POSCFG_FEATURE_STATISTICS != 0
+  POSSYSSTATS_t  ss;
+#endif
+#if NOSCFG_FEATURE_MEMSTATS != 0
+  NOSMEMSTATS_t  ms;
+#endif
+
+  ++pg->updates;
+  pg->hz = HZ;
+#if POSCFG_FEATURE_JIFFIES != 0
+  pg->jiffies = (unsigned long) jiffies;
+#else
+  pg->jiffies = NOSSTATPAGE_NA;
+#endif
+#if NOSCFG_FEATURE_CPUUSAGE != 0
+  pg->cpuusage = nosCpuUsage();
+#else
+  pg->cpuusage = NOSSTATPAGE_NA;
+#endif
+
+#if POSCFG_FEATURE_STATISTICS != 0
+  if (posSystemGetStats(&ss) == E_OK)
+  {
+    pg->switches  = ss.switches;
+    pg->allocfail = ss.allocfail;
+  }
+  else
+#endif
+  {
+    pg->switches  = NOSSTATPAGE_NA;
+    pg->allocfail = NOSSTATPAGE_NA;
+  }
+
+  pg->heapsize    = NOSSTATPAGE_NA;
+  pg->heapused    = NOSSTATPAGE_NA;
+  pg->heapmaxused = NOSSTATPAGE_NA;
+  pg->heaplargest = NOSSTATPAGE_NA;
+  pg->heapblocks  = NOSSTATPAGE_NA;
+  pg->heapfail    = NOSSTATPAGE_NA;
+#if NOSCFG_FEATURE_MEMSTATS != 0
+  if (nosMemStats(&ms) == E_OK)
+  {
+#if NOSCFG_MEM_MANAGER_TYPE == 1
+    /* the byte counts are only known by the internal allocator */
+    pg->heapsize    = ms.heapSize;
+    pg->heapused    = ms.usedBytes;
+    pg->heapmaxused = ms.maxUsedBytes;
+    pg->heaplargest = ms.largestFree;
+#endif
+    pg->heapblocks  = ms.usedBlocks;
+    pg->heapfail    = ms.failCount;
+  }
+#endif
+
+  pg->tasks = nos_regStatPageTasks(pg->task, (UINT_t) pg->maxtasks);
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* Copies the private copy to the page. The sequence counter is odd
+ * while the copy is in progress, so a reader can detect a torn copy.
+ */
+static void POSCALL nos_statPagePublish(NOSSTATPAGE_t *pg,
+                                        NOSSTATPAGE_t *shadow)
+{
+  unsigned long  *d, *s;
+  unsigned long  seq, n;
+
+  seq = pg->seq | 1;
+  pg->seq = seq;
+  NOS_MEMBARRIER();
+
+  d = (unsigned long*) (void*) pg;
+  s = (unsigned long*) (void*) shadow;
+  n = NOSSTATPAGE_SIZE(shadow->tasks ? shadow->tasks : 1) /
+        sizeof(unsigned long);
+  for (++d, ++s, --n; n != 0; --n)
+  {
+    *d++ = *s++;
+  }
+
+  NOS_MEMBARRIER();
+  pg->seq = seq + 1;
+}
+
+/*-------------------------------------------------------------------------*/
+
+static void nos_statPageTask(void *arg)
+{
+  (void) arg;
+
+  for (;;)
+  {
+    nos_statPageFill(statshadow_g);
+    nos_statPagePublish(statpage_g, statshadow_g);
+    posTaskSleep(statperiod_g);
+  }
+}
+
+
+
+/*---------------------------------------------------------------------------
+ *  STATISTICS PAGE FUNCTIONS
+ *-------------------------------------------------------------------------*/
+
+VAR_t POSCALL nosStatPageStart(void *page, UINT_t size,
+                               VAR_t priority, UINT_t periodticks)
+{
+  NOSSTATPAGE_t  *pg = (NOSSTATPAGE_t*) page;
+  UINT_t         maxtasks;
+
+  if ((size < NOSSTATPAGE_SIZE(1)) || (periodticks == 0))
+    return -E_ARG;
+  if (statpage_g != NULL)
+    return -E_FORB;
+
+  maxtasks = 1 + (UINT_t) ((size - NOSSTATPAGE_SIZE(1)) /
+                           sizeof(NOSSTATTASK_t));
+  size = NOSSTATPAGE_SIZE(maxtasks);
+
+  if (pg == NULL)
+  {
+#ifdef NOSCFG_STATPAGE_SHMNAME
+    pg = (NOSSTATPAGE_t*) NOS_STATPAGE_MAP(NOSCFG_STATPAGE_SHMNAME, size);
+    if (pg == NULL)
+      return -E_FAIL;
+#else
+    return -E_ARG;
+#endif
+  }
+
+  statshadow_g = (NOSSTATPAGE_t*) nosMemAlloc(size);
+  if (statshadow_g == NULL)
+    return -E_NOMEM;
+
+  statshadow_g->seq         = 0;
+  statshadow_g->magic       = NOSSTATPAGE_MAGIC;
+  statshadow_g->version     = NOSSTATPAGE_VERSION;
+  statshadow_g->pagesize    = (unsigned long) size;
+  statshadow_g->maxtasks    = (unsigned long) maxtasks;
+  statshadow_g->updates     = 0;
+  statshadow_g->tasks       = 0;
+  statperiod_g = periodticks;
+
+  /* the page becomes valid when the first update is published */
+  pg->seq   = 0;
+  pg->magic = 0;
+  statpage_g = pg;
+
+  if (nosTaskCreate(nos_statPageTask, NULL, priority, 0,
+                    "statpage") == NULL)
+  {
+    statpage_g = NULL;
+    nosMemFree(statshadow_g);
+    return -E_NOMEM;
+  }
+  return E_OK;
+}
+
+#endif /* NOSCFG_FEATURE_STATPAGE */
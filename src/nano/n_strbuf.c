@@ -0,0 +1,392 @@
+/*
+ *  Copyright (c) 2004-2012, Dennis Kuschel.
+ *  All rights reserved. 
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions
+ *  are met:
+ *
+ *   1. Redistributions of source code must retain the above copyright
+ *      notice, this list of conditions and the following disclaimer.
+ *   2. Redistributions in binary form must reproduce the above copyright
+ *      notice, this list of conditions and the following disclaimer in the
+ *      documentation and/or other materials provided with the distribution.
+ *   3. The name of the author may not be used to endorse or promote
+ *      products derived from this software without specific prior written
+ *      permission. 
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS
+ *  OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ *  WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ *  ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT,
+ *  INDIRECT,  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ *  (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ *  HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT,
+ *  STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ *  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED
+ *  OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+/**
+ * @file   n_strbuf.c
+ * @brief  nano layer, stream buffers
+ * @author Dennis Kuschel
+ *
+ * This file is originally from the pico]OS realtime operating system
+ * (http://picoos.sourceforge.net).
+ */
+
+#define _N_STRBUF_C
+#include "../src/nano/privnano.h"
+
+#if NOSCFG_FEATURE_STREAMBUF != 0
+
+/* check features */
+#if POSCFG_FEATURE_INHIBITSCHED == 0
+#error POSCFG_FEATURE_INHIBITSCHED not enabled
+#endif
+#if POSCFG_FEATURE_SEMAPHORES == 0
+#error POSCFG_FEATURE_SEMAPHORES not enabled
+#endif
+#if POSCFG_FEATURE_SEMADESTROY == 0
+#error POSCFG_FEATURE_SEMADESTROY not enabled
+#endif
+#if NOSCFG_FEATURE_MEMALLOC == 0
+#error NOSCFG_FEATURE_MEMALLOC not enabled
+#endif
+
+
+
+/*---------------------------------------------------------------------------
+ *  TYPEDEFS
+ *-------------------------------------------------------------------------*/
+
+/*
+ * The data in the ring is always contiguous. When a reservation does
+ * not fit into the space behind the write position, the writer wraps
+ * to the start of the buffer and the old write position becomes the
+ * end of the valid data ("end"). The reader follows when it reaches
+ * this end. The ring is inverted when wr < rd, and it is empty when
+ * wr == rd.
+ */
+struct nosstream {
+  unsigned char   *buf;
+  UINT_t          size;
+  UINT_t          wr;         /* write position */
+  UINT_t          rd;         /* read position */
+  UINT_t          end;        /* end of the data when the ring is inverted */
+  UINT_t          rsvpos;     /* start of the reserved space */
+  UINT_t          rsvsize;    /* size of the reserved space */
+  UINT_t          wneed;      /* space a waiting writer needs, or 0 */
+  UVAR_t          reserved;
+  UVAR_t          rwait;      /* set when the reader waits for data */
+  POSSEMA_t       wsema;      /* signalled when the writer can continue */
+  POSSEMA_t       rsema;      /* signalled when data was committed */
+};
+
+
+
+/*---------------------------------------------------------------------------
+ *  FUNCTION PROTOTYPES
+ *-------------------------------------------------------------------------*/
+
+static UVAR_t POSCALL nos_streamFit(NOSSTREAM_t s, UINT_t size,
+                                    UINT_t *pos);
+static UINT_t POSCALL nos_streamAvail(NOSSTREAM_t s);
+static VAR_t  POSCALL nos_streamWait(POSSEMA_t sema, UINT_t timeoutticks);
+
+
+
+/*---------------------------------------------------------------------------
+ *  HELPER FUNCTIONS
+ *-------------------------------------------------------------------------*/
+
+/* Tests if 'size' contiguous bytes can be reserved and
+ * returns the position of the space. Scheduler must be locked.
+ */
+static UVAR_t POSCALL nos_streamFit(NOSSTREAM_t s, UINT_t size,
+                                    UINT_t *pos)
+{
+  if (s->wr == s->rd)
+  {
+    /* empty, the writer restarts at the begin of the buffer */
+    *pos = 0;
+    return 1;
+  }
+  if (s->wr > s->rd)
+  {
+    if (s->size - s->wr >= size)
+    {
+      *pos = s->wr;
+      return 1;
+    }
+    /* wrap around, but the write position must stay below rd */
+    if (s->rd > size)
+    {
+      *pos = 0;
+      return 1;
+    }
+    return 0;
+  }
+  if (s->rd - s->wr > size)
+  {
+    *pos = s->wr;
+    return 1;
+  }
+  return 0;
+}
+
+/*-------------------------------------------------------------------------*/
+
+/* Returns the count of contiguous bytes at the read position.
+ * The reader wraps here when it has reached the end of the data
+ * in an inverted ring. Scheduler must be locked.
+ */
+static UINT_t POSCALL nos_streamAvail(NOSSTREAM_t s)
+{
+  if ((s->wr < s->rd) && (s->rd == s->end))
+  {
+    s->rd  = 0;
+    s->end = s->size;
+  }
+  if (s->wr >= s->rd)
+    return s->wr - s->rd;
+  return s->end - s->rd;
+}
+
+/*-------------------------------------------------------------------------*/
+
+static VAR_t POSCALL nos_streamWait(POSSEMA_t sema, UINT_t timeoutticks)
+{
+#if POSCFG_FEATURE_SEMAWAIT != 0
+  return posSemaWait(sema, timeoutticks);
+#else
+  (void) timeoutticks;
+  return posSemaGet(sema);
+#endif
+}
+
+
+
+/*---------------------------------------------------------------------------
+ *  STREAM BUFFER FUNCTIONS
+ *-------------------------------------------------------------------------*/
+
+NOSSTREAM_t POSCALL nosStreamCreate(UINT_t size)
+{
+  NOSSTREAM_t  s;
+
+  if (size == 0)
+    return NULL;
+
+  s = (NOSSTREAM_t) nosMemAlloc(sizeof(struct nosstream) + size);
+  if (s == NULL)
+    return NULL;
+
+  s->buf      = (unsigned char*) (s + 1);
+  s->size     = size;
+  s->wr       = 0;
+  s->rd       = 0;
+  s->end      = size;
+  s->rsvpos   = 0;
+  s->rsvsize  = 0;
+  s->wneed    = 0;
+  s->reserved = 0;
+  s->rwait    = 0;
+  s->wsema    = posSemaCreate(0);
+  s->rsema    = posSemaCreate(0);
+  if ((s->wsema == NULL) || (s->rsema == NULL))
+  {
+    if (s->wsema != NULL)
+      posSemaDestroy(s->wsema);
+    if (s->rsema != NULL)
+      posSemaDestroy(s->rsema);
+    nosMemFree(s);
+    return NULL;
+  }
+  return s;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL nosStreamDestroy(NOSSTREAM_t s)
+{
+  if (s == NULL)
+    return;
+
+  posSemaDestroy(s->wsema);
+  posSemaDestroy(s->rsema);
+  nosMemFree(s);
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL nosStreamReserve(NOSSTREAM_t s, UINT_t size, void **buf,
+                               UINT_t timeoutticks)
+{
+  UINT_t  pos;
+  VAR_t   status;
+
+  if ((s == NULL) || (buf == NULL) || (size == 0) || (size > s->size))
+    return -E_ARG;
+
+  posTaskSchedLock();
+  if (s->reserved != 0)
+  {
+    posTaskSchedUnlock();
+    return -E_FAIL;
+  }
+
+  while (nos_streamFit(s, size, &pos) == 0)
+  {
+    if (timeoutticks == 0)
+    {
+      posTaskSchedUnlock();
+      return 1;
+    }
+
+    /* nosStreamConsume signals us when the space is available */
+    s->wneed = size;
+    posTaskSchedUnlock();
+    status = nos_streamWait(s->wsema, timeoutticks);
+    posTaskSchedLock();
+
+    if (status != 0)
+    {
+      if (s->wneed != 0)
+      {
+        s->wneed = 0;
+        posTaskSchedUnlock();
+        return status;
+      }
+      /* signalled just after the timeout, take the signal back */
+      (void) posSemaGet(s->wsema);
+    }
+  }
+
+  if (s->wr == s->rd)
+  {
+    s->wr  = 0;
+    s->rd  = 0;
+    s->end = s->size;
+  }
+  s->rsvpos   = pos;
+  s->rsvsize  = size;
+  s->reserved = 1;
+  posTaskSchedUnlock();
+
+  *buf = (void*) (s->buf + pos);
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL nosStreamCommit(NOSSTREAM_t s, UINT_t size)
+{
+  if (s == NULL)
+    return -E_ARG;
+
+  posTaskSchedLock();
+  if ((s->reserved == 0) || (size > s->rsvsize))
+  {
+    posTaskSchedUnlock();
+    return -E_ARG;
+  }
+  s->reserved = 0;
+
+  if (size != 0)
+  {
+    if (s->rsvpos != s->wr)
+    {
+      /* the writer has wrapped around, the ring is inverted now */
+      s->end = s->wr;
+    }
+    s->wr = s->rsvpos + size;
+
+    if (s->rwait != 0)
+    {
+      s->rwait = 0;
+      (void) posSemaSignal(s->rsema);
+    }
+  }
+  posTaskSchedUnlock();
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL nosStreamPeek(NOSSTREAM_t s, void **buf, UINT_t *size,
+                            UINT_t timeoutticks)
+{
+  UINT_t  avail;
+  VAR_t   status;
+
+  if ((s == NULL) || (buf == NULL) || (size == NULL))
+    return -E_ARG;
+
+  posTaskSchedLock();
+  while ((avail = nos_streamAvail(s)) == 0)
+  {
+    if (timeoutticks == 0)
+    {
+      posTaskSchedUnlock();
+      *size = 0;
+      return 1;
+    }
+
+    /* nosStreamCommit signals us when new data is available */
+    s->rwait = 1;
+    posTaskSchedUnlock();
+    status = nos_streamWait(s->rsema, timeoutticks);
+    posTaskSchedLock();
+
+    if (status != 0)
+    {
+      if (s->rwait != 0)
+      {
+        s->rwait = 0;
+        posTaskSchedUnlock();
+        *size = 0;
+        return status;
+      }
+      /* signalled just after the timeout, take the signal back */
+      (void) posSemaGet(s->rsema);
+    }
+  }
+  *buf  = (void*) (s->buf + s->rd);
+  *size = avail;
+  posTaskSchedUnlock();
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL nosStreamConsume(NOSSTREAM_t s, UINT_t size)
+{
+  UINT_t  pos;
+
+  if (s == NULL)
+    return -E_ARG;
+
+  posTaskSchedLock();
+  if (size > nos_streamAvail(s))
+  {
+    posTaskSchedUnlock();
+    return -E_ARG;
+  }
+  s->rd += size;
+  (void) nos_streamAvail(s);
+
+  if ((s->wneed != 0) && (nos_streamFit(s, s->wneed, &pos) != 0))
+  {
+    s->wneed = 0;
+    (void) posSemaSignal(s->wsema);
+  }
+  posTaskSchedUnlock();
+  return E_OK;
+}
+
+#endif /* NOSCFG_FEATURE_STREAMBUF */
@@ -52,6 +52,13 @@
 
 /*-------------------------------------------------------------------------*/
 
+#ifdef NOS_NEEDTASKEXITHOOK
+/* task exit hook of the nano layer, it is set by nosTaskCreate */
+extern void nos_taskExitHook(POSTASK_t task, texhookevent_t event);
+#endif
+
+/*-------------------------------------------------------------------------*/
+
 #if NOSCFG_FEATURE_REGISTRY != 0
 
 union khandle {
@@ -98,6 +105,12 @@ extern void POSCALL nos_regDelSysKey(NOSREGTYPE_t type,
 extern void  POSCALL nos_regEnableSysKey(REGELEM_t re,
                                          NOSGENERICHANDLE_t handle);
 
+#if NOSCFG_FEATURE_STATPAGE != 0
+/* fills the task records of the statistics page */
+extern UINT_t POSCALL nos_regStatPageTasks(NOSSTATTASK_t *ti,
+                                           UINT_t maxtasks);
+#endif
+
 #endif /* _N_REG_C */
 
 #endif /* NOSCFG_FEATURE_REGISTRY */
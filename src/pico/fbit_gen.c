@@ -70,6 +70,13 @@
  * POSCFG_FBIT_BITSHIFT = 1:
  *  Set this to 1 if your machine is able to do fast bit shifts.
  *  This is true for most of the bigger machines such as PowerPC.
+ *
+ * POSCFG_FBIT_BUILTIN = 1:
+ *  "findbit" is implemented as a macro in picoos.h that uses the
+ *  count-trailing-zeros builtin of GCC compatible compilers
+ *  (__builtin_ctz). On most CPUs this compiles to a single bit scan
+ *  instruction, plus a rotate for the round robin offset.
+ *  This file is then not needed. Any value of MVAR_BITS is supported.
  */
 
 
@@ -88,7 +95,17 @@
 #error This file implements only lookup-tables for MVAR_BITS == 8
 #endif
 
-#if (POSCFG_FBIT_USE_LUTABLE == 1)
+/* Rotate the bitfield right by the round robin offset. The left shift
+ * is masked, so an offset of zero does not shift by MVAR_BITS.
+ */
+#define FBIT_ROTR(bf, ofs) \
+  (((bf) << ((MVAR_BITS - (ofs)) & (MVAR_BITS - 1))) | ((bf) >> (ofs)))
+
+#if (POSCFG_FBIT_BUILTIN != 0)
+
+/* nothing to do, findbit is a macro defined in picoos.h */
+
+#elif (POSCFG_FBIT_USE_LUTABLE == 1)
 
 VAR_t const p_pos_fbittbl[256] =
 { 0,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,4,0,1,0,2,0,1,0,3,0,1,0,2,0,1,0,
@@ -107,7 +124,7 @@ VAR_t const p_pos_fbittbl[256] =
 UVAR_t POSCALL p_pos_findbit(const UVAR_t bitfield, UVAR_t rrOffset)
 {
   UVAR_t bf, bit;
-  bf = (bitfield << (MVAR_BITS - rrOffset)) | (bitfield >> rrOffset); 
+  bf = FBIT_ROTR(bitfield, rrOffset); 
   bit = p_pos_fbittbl[bf];
   return (bit + rrOffset) & (MVAR_BITS - 1);
 }
@@ -203,17 +220,19 @@ VAR_t const p_pos_fbittbl_rr[8][256] =
 /*-------------------------------------------------------------------------*/
 
 
-#if (POSCFG_FASTCODE != 0) && (MVAR_BITS <= 32)
+#if (POSCFG_FASTCODE != 0) && \
+    ((MVAR_BITS <= 32) || (POSCFG_FBIT_BITSHIFT != 0))
 #if (POSCFG_FBIT_BITSHIFT != 0)
 
 /*
- * Fast generic findbit() -function for 8/16/32 bit architectures.
+ * Fast generic findbit() -function for 8/16/32/64 bit architectures.
  * The code supports roundrobin and standard-scheduling.
  *
  * Speed:
  *   8 bit: 3 if-branches
  *  16 bit: 4 if-branches
  *  32 bit: 5 if-branches
+ *  64 bit: 6 if-branches
  *
  * When roundrobin is enabled, also two shift-, one and-, one or-
  * and one addition operation are needed.
@@ -238,12 +257,19 @@ UVAR_t POSCALL p_pos_findbit(const UVAR_t bitfield, UVAR_t rrOffset)
   UVAR_t bf;
   UVAR_t bit;
   
-  bf = (bitfield << (MVAR_BITS - rrOffset)) | (bitfield >> rrOffset);
+  bf = FBIT_ROTR(bitfield, rrOffset);
 
 #endif /* POSCFG_ROUNDROBIN */
 
   bit = 0;
 
+#if (MVAR_BITS > 32)
+  if ((bf & 0xFFFFFFFFUL) == 0)
+  {
+    bit |= 32;
+    bf >>= 32;
+  }
+#endif
 #if (MVAR_BITS > 16)
   if ((bf & 0xFFFF) == 0)
   {
@@ -314,7 +340,7 @@ UVAR_t POSCALL p_pos_findbit(const UVAR_t bitfield, UVAR_t rrOffset)
   UVAR_t bf;
   UVAR_t bit;
   
-  bf = (bitfield << (MVAR_BITS - rrOffset)) | (bitfield >> rrOffset);
+  bf = FBIT_ROTR(bitfield, rrOffset);
 
 #endif /* POSCFG_ROUNDROBIN */
 
@@ -497,7 +523,7 @@ UVAR_t POSCALL p_pos_findbit(const UVAR_t bitfield, UVAR_t rrOffset)
   UVAR_t bf;
   UVAR_t bit;
   
-  bf = (bitfield << (MVAR_BITS - rrOffset)) | (bitfield >> rrOffset);
+  bf = FBIT_ROTR(bitfield, rrOffset);
   
   for (bit = 0; bit < MVAR_BITS; bit++)
   {
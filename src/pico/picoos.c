@@ -78,14 +78,46 @@
  *  LOCAL TYPES AND VARIABLES
  *-------------------------------------------------------------------------*/
 
+/* Table of task bits. Each priority row has a word of task bits in
+ * xtable, and ymask has a bit set for each row that is not empty.
+ * When there are more rows than bits in a word, a third level is
+ * added: ytable holds the row bits of MVAR_BITS rows per word, and
+ * zmask has a bit set for each word in ytable that is not empty.
+ */
 typedef struct TBITS {
   UVAR_t         xtable[SYS_TASKTABSIZE_Y];
-#if SYS_TASKTABSIZE_Y > 1
+#if SYS_TASKTABSIZE_Z > 1
+  UVAR_t         ytable[SYS_TASKTABSIZE_Z];
+  UVAR_t         zmask;
+#elif SYS_TASKTABSIZE_Y > 1
   UVAR_t         ymask;
 #endif
 } TBITS_t;
 
 
+/* Links between tasks, events, timers and message buffers. When
+ * POSCFG_COMPACT_OBJECTS is set, the objects are linked by their
+ * index in the object table, and the index 0 is the NULL link.
+ */
+#if POSCFG_COMPACT_OBJECTS != 0
+#define POSLINK_PTR(type, base, link) \
+  (((link) == 0) ? NULL : (type*)((void*)(((MEMPTR_t)(base)) + \
+    (((MEMPTR_t)(link)) - 1) * ALIGNEDSIZE(sizeof(type)))))
+#define POSLINK_IDX(ltype, type, base, ptr) \
+  (((ptr) == NULL) ? 0 : (ltype)(((((MEMPTR_t)(ptr)) - \
+    ((MEMPTR_t)(base))) / ALIGNEDSIZE(sizeof(type))) + 1))
+
+#define TASK_NIL        0
+#define TASK_PTR(link)  POSLINK_PTR(struct POSTASK, posTaskBase_g, link)
+#define TASK_LINK(task) \
+          POSLINK_IDX(POSTASKLINK_t, struct POSTASK, posTaskBase_g, task)
+#else
+#define TASK_NIL        NULL
+#define TASK_PTR(link)  (link)
+#define TASK_LINK(task) (task)
+#endif
+
+
 #if SYS_FEATURE_EVENTS != 0
 
 typedef union EVENT {
@@ -107,7 +139,14 @@ typedef union EVENT {
     } d;
     TBITS_t      pend;
 #if POSCFG_FEATURE_MUTEXES != 0
-    POSTASK_t    task;
+    POSTASKLINK_t task;
+#endif
+#if POSCFG_FEATURE_STATISTICS != 0
+    POSEVENTSTATS_t stats;
+#endif
+#if POSCFG_FEATURE_MUTEXPROF != 0
+    POSMUTEXPROF_t  mprof;
+    POSCYCLES_t     mlocked;
 #endif
 #ifdef POS_DEBUGHELP
     struct PICOEVENT deb;
@@ -115,8 +154,21 @@ typedef union EVENT {
   } e;
 } *EVENT_t;
 
+#if POSCFG_COMPACT_OBJECTS != 0
+#define EV_NIL          0
+#define EV_PTR(link)    POSLINK_PTR(union EVENT, posEventBase_g, link)
+#define EV_LINK(ev) \
+          POSLINK_IDX(POSEVENTLINK_t, union EVENT, posEventBase_g, ev)
+#else
+#define EV_NIL          NULL
+#define EV_PTR(link)    ((EVENT_t)(link))
+#define EV_LINK(ev)     ((void*)(ev))
+#endif
 
 static EVENT_t   posFreeEvents_g;
+#if POSCFG_COMPACT_OBJECTS != 0
+static EVENT_t   posEventBase_g;
+#endif
 
 #if (POSCFG_DYNAMIC_MEMORY == 0) && \
     ((POSCFG_MAX_EVENTS + SYS_MSGBOXEVENTS) != 0)
@@ -129,6 +181,18 @@ STATICBUFFER(posStaticEventMem_g, sizeof(union EVENT), \
 
 #if POSCFG_FEATURE_MSGBOXES != 0
 
+#if POSCFG_COMPACT_OBJECTS != 0
+typedef POSMSGLINK_t    MSGLINK_t;
+#define MSG_NIL         0
+#define MSG_PTR(link)   POSLINK_PTR(MSGBUF_t, posMessageBase_g, link)
+#define MSG_LINK(mbuf)  POSLINK_IDX(MSGLINK_t, MSGBUF_t, posMessageBase_g, mbuf)
+#else
+typedef struct MSGBUF   *MSGLINK_t;
+#define MSG_NIL         NULL
+#define MSG_PTR(link)   ((MSGBUF_t*)(link))
+#define MSG_LINK(mbuf)  (mbuf)
+#endif
+
 typedef struct MSGBUF {
 #if POSCFG_MSG_MEMORY != 0
   unsigned char  buffer[POSCFG_MSG_BUFSIZE];
@@ -138,13 +202,16 @@ typedef struct MSGBUF {
 #if POSCFG_ARGCHECK > 1
   UVAR_t         magic;
 #endif
-  struct MSGBUF *next;
+  MSGLINK_t      next;
 } MSGBUF_t;
 
 static POSSEMA_t msgAllocSyncSem_g;
 static POSSEMA_t msgAllocWaitSem_g;
 static UVAR_t    msgAllocWaitReq_g;
 static MSGBUF_t  *posFreeMessagebuf_g;
+#if POSCFG_COMPACT_OBJECTS != 0
+static MSGBUF_t  *posMessageBase_g;
+#endif
 
 #if (POSCFG_DYNAMIC_MEMORY == 0) && (POSCFG_MAX_MESSAGES != 0)
 STATICBUFFER(posStaticMessageMem_g, sizeof(MSGBUF_t), POSCFG_MAX_MESSAGES);
@@ -155,23 +222,60 @@ STATICBUFFER(posStaticMessageMem_g, sizeof(MSGBUF_t), POSCFG_MAX_MESSAGES);
 
 #if POSCFG_FEATURE_TIMER != 0
 
+#if POSCFG_COMPACT_OBJECTS != 0
+#if POSCFG_MAX_TIMER < 256
+typedef unsigned char   TMRLINK_t;
+#else
+typedef unsigned short  TMRLINK_t;
+#endif
+#define TMR_NIL         0
+#define TMR_PTR(link)   POSLINK_PTR(TIMER_t, posTimerBase_g, link)
+#define TMR_LINK(tmr)   POSLINK_IDX(TMRLINK_t, TIMER_t, posTimerBase_g, tmr)
+#else
+typedef struct TIMER    *TMRLINK_t;
+#define TMR_NIL         NULL
+#define TMR_PTR(link)   (link)
+#define TMR_LINK(tmr)   (tmr)
+#endif
+
 typedef struct TIMER {
 #if POSCFG_ARGCHECK > 1
   UVAR_t         magic;
 #endif
-  struct TIMER   *prev;
-  struct TIMER   *next;
-  POSSEMA_t      sema;
+  TMRLINK_t      prev;
+  TMRLINK_t      next;
+#if POSCFG_FEATURE_TIMERCALLBACK != 0
+  TMRLINK_t      cbnext;
+#endif
+  POSEVENTLINK_t sema;
   UINT_t         counter;
   UINT_t         wait;
   UINT_t         reload;
 #if POSCFG_FEATURE_TIMERFIRED != 0
   VAR_t          fired;
 #endif
+#if POSCFG_FEATURE_TIMERCALLBACK != 0
+  POSTIMERFUNC_t func;
+  void           *arg;
+  UVAR_t         context;
+  UVAR_t         queued;
+#endif
 } TIMER_t;
 
 static TIMER_t   *posFreeTimer_g;
 static TIMER_t   *posActiveTimers_g;
+#if POSCFG_COMPACT_OBJECTS != 0
+static TIMER_t   *posTimerBase_g;
+#endif
+
+#if (POSCFG_FEATURE_TIMERCALLBACK != 0) && (POSCFG_TASKSTACKTYPE != 0)
+#define POS_TIMERTASK  1
+static POSSEMA_t  posTimerTaskSema_g;
+static TIMER_t   *posTimerQueueHead_g;
+static TIMER_t   *posTimerQueueTail_g;
+#else
+#define POS_TIMERTASK  0
+#endif
 
 #if (POSCFG_DYNAMIC_MEMORY == 0) && (POSCFG_MAX_TIMER != 0)
 STATICBUFFER(posStaticTmrMem_g, sizeof(TIMER_t), POSCFG_MAX_TIMER);
@@ -183,26 +287,129 @@ STATICBUFFER(posStaticTmrMem_g, sizeof(TIMER_t), POSCFG_MAX_TIMER);
 #if POSCFG_FEATURE_JIFFIES != 0
 #if POSCFG_FEATURE_LARGEJIFFIES == 0
 volatile JIF_t jiffies;
+#define POS_JIFFIES  jiffies
 #else
 static volatile JIF_t pos_jiffies_g;
+#define POS_JIFFIES  pos_jiffies_g  /* only valid when the kernel is locked */
 #endif
 #endif /* POSCFG_FEATURE_JIFFIES */
 
+#if POSCFG_FEATURE_HRTIME != 0
+static volatile POSTIME_t   pos_hrTicks_g;
+static volatile POSCYCLES_t pos_tickCycles_g;
+#endif
+
+/* Sequence counter for lock-free reading of the time variables that
+ * can not be read with a single access. The counter is odd while
+ * the timer interrupt updates the variables. */
+#if ((POSCFG_FEATURE_JIFFIES != 0) && (POSCFG_FEATURE_LARGEJIFFIES != 0)) || \
+    (POSCFG_FEATURE_HRTIME != 0)
+#define POS_TIMESEQ  1
+static volatile UVAR_t pos_timeSeq_g;
+#else
+#define POS_TIMESEQ  0
+#endif
+
 
+#if SYS_SMP != 0
+static UVAR_t    posCoreMustSchedule_g[POSCFG_SMP_CORES];
+static TBITS_t   posCoreReadyTasks_g[POSCFG_SMP_CORES];
+static volatile UVAR_t posCoreSwitchCtr_g[POSCFG_SMP_CORES];
+#define posMustSchedule_g  posCoreMustSchedule_g[POS_CPUID]
+#define posReadyTasks_g    posCoreReadyTasks_g[POS_CPUID]
+#else
 static UVAR_t    posMustSchedule_g;
 static TBITS_t   posReadyTasks_g;
+#endif
 static TBITS_t   posAllocatedTasks_g;
 static POSTASK_t posSleepingTasks_g;
 static POSTASK_t posFreeTasks_g;
+#if POSCFG_COMPACT_OBJECTS != 0
+static POSTASK_t posTaskBase_g;
+#endif
 static POSTASK_t posTaskTable_g[SYS_TASKTABSIZE_X * SYS_TASKTABSIZE_Y];
 
 #if POSCFG_CTXSW_COMBINE > 1
 static UVAR_t    posCtxCombineCtr_g;
 #endif
+#if POSCFG_CTXSW_ADAPTIVE != 0
+static UVAR_t    posCtxCombineThr_g;
+static UINT_t    posCtxTickEvents_g;
+static POSCTXSTATS_t posCtxStats_g;
+#define POS_CTXSW_THRESHOLD  posCtxCombineThr_g
+#else
+#define POS_CTXSW_THRESHOLD  POSCFG_CTXSW_COMBINE
+#endif
+#if (POSCFG_CTXSW_ADAPTIVE != 0) && (POSCFG_FEATURE_HRTIME != 0)
+/* The time from the first deferred wakeup until the scheduler runs
+ * is measured with the cycle counter. */
+static UVAR_t      posCtxPending_g;
+static POSCYCLES_t posCtxWakeCycles_g;
+static POSCYCLES_t posCtxTickLatency_g;
+static POSCYCLES_t posCtxMaxLatency_g;
+#define pos_ctxDeferred() do { \
+    if (posCtxPending_g == 0) { \
+      posCtxPending_g = 1; \
+      posCtxWakeCycles_g = POS_CYCLES(); } } while(0)
+#define pos_ctxScheduled() do { \
+    if (posCtxPending_g != 0) pos_ctxLatency(); } while(0)
+#else
+#define pos_ctxDeferred()   do { } while(0)
+#define pos_ctxScheduled()  do { } while(0)
+#endif
+
+#if POSCFG_FEATURE_STACKCHECK != 0
+static UINT_t    posStackCheckIdx_g;
+#endif
+
+#if POSCFG_FEATURE_STATISTICS != 0
+static POSSYSSTATS_t posSysStats_g;
+#if POSCFG_FEATURE_HRTIME != 0
+/* cycle counter value at the last context switch */
+static POSCYCLES_t   posRunStart_g[POSCFG_SMP_CORES];
+#endif
+#endif
+
+#if POSCFG_FEATURE_LOCKPROF != 0
+/* state of the currently measured critical section */
+typedef struct {
+  POSLOCKSITE_t  *site;
+  POSCYCLES_t    start;
+  UVAR_t         depth;
+} LOCKPROF_t;
+#define POS_LOCKPROF_IRQ      0
+#define POS_LOCKPROF_INHIBIT  1
+static POSLOCKSITE_t *posLockSites_g;
+#if SYS_SMP != 0
+static LOCKPROF_t posCoreLockProf_g[POSCFG_SMP_CORES][2];
+#define posLockProf_g  posCoreLockProf_g[POS_CPUID]
+#else
+static LOCKPROF_t posLockProf_g[2];
+#endif
+#endif
 
 #if POSCFG_FEATURE_INHIBITSCHED != 0
+#if SYS_SMP != 0
+static volatile UVAR_t posCoreInhibitSched_g[POSCFG_SMP_CORES];
+static UVAR_t    posSchedLockCore_g;   /* core number + 1, 0 = unlocked */
+#define posInhibitSched_g  posCoreInhibitSched_g[POS_CPUID]
+#else
 static UVAR_t    posInhibitSched_g;
 #endif
+#endif
+
+#if (SYS_SMP != 0) && (POSCFG_FEATURE_INHIBITSCHED != 0) && \
+    (POSCFG_TASKSTACKTYPE != 0)
+/* The port may take the task stacks from the nano layer heap, which is
+ * protected by posTaskSchedLock only. This waits with the kernel lock
+ * held until no other core holds the scheduler lock. */
+#define pos_waitSchedLockFree() \
+  while ((posSchedLockCore_g != 0) && \
+         (posSchedLockCore_g != (UVAR_t)(POS_CPUID + 1))) \
+  { POS_SCHED_UNLOCK; POS_SCHED_LOCK; }
+#else
+#define pos_waitSchedLockFree()  do { } while(0)
+#endif
 
 #if POSCFG_FEATURE_IDLETASKHOOK != 0
 static POSIDLEFUNC_t  posIdleTaskFuncHook_g;
@@ -279,7 +486,12 @@ UVAR_t posShift1lTab_g[8] = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
 
 #if POSCFG_ROUNDROBIN != 0
 
+#if SYS_SMP != 0
+static UVAR_t  posCoreNextRoundRobin_g[POSCFG_SMP_CORES][SYS_TASKTABSIZE_Y];
+#define posNextRoundRobin_g  posCoreNextRoundRobin_g[POS_CPUID]
+#else
 static UVAR_t  posNextRoundRobin_g[SYS_TASKTABSIZE_Y];
+#endif
 #define POS_NEXTROUNDROBIN(idx)  posNextRoundRobin_g[idx]
 
 #else  /* ROUNDROBIN */
@@ -290,6 +502,117 @@ static UVAR_t  posNextRoundRobin_g[SYS_TASKTABSIZE_Y];
 
 
 
+/*---------------------------------------------------------------------------
+ * EARLIEST DEADLINE FIRST
+ *-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_EDF != 0
+
+#define POS_EDF_ROW  ((SYS_TASKTABSIZE_Y - 1) - POSCFG_EDF_PRIO)
+
+#define POS_EDF_NOW  POS_JIFFIES
+
+/* Queue of the ready tasks that have a deadline, sorted by absolute
+ * deadline. A task is inserted when it becomes ready and removed when
+ * it blocks, so the scheduler takes the head of the queue.
+ */
+static POSTASK_t posEdfReady_g;
+
+#if SYS_SMP != 0
+#define POS_EDF_ISREADY(task) \
+          pos_isTableBitSet(&posCoreReadyTasks_g[(task)->core], task)
+#else
+#define POS_EDF_ISREADY(task)  pos_isTableBitSet(&posReadyTasks_g, task)
+#endif
+
+static void POSCALL pos_edfRemove(POSTASK_t task);
+static void POSCALL pos_edfRemove(POSTASK_t task)
+{
+  if (task->edfqueued == 0)
+    return;
+  task->edfqueued = 0;
+  if (task->edfnext != TASK_NIL)
+    TASK_PTR(task->edfnext)->edfprev = task->edfprev;
+  if (task->edfprev != TASK_NIL)
+  {
+    TASK_PTR(task->edfprev)->edfnext = task->edfnext;
+  }
+  else
+  {
+    posEdfReady_g = TASK_PTR(task->edfnext);
+  }
+}
+
+static void POSCALL pos_edfInsert(POSTASK_t task);
+static void POSCALL pos_edfInsert(POSTASK_t task)
+{
+  register POSTASK_t prev, next;
+
+  if (task->edfqueued != 0)
+    return;
+  task->edfqueued = 1;
+  prev = NULL;
+  next = posEdfReady_g;
+  while ((next != NULL) &&
+         ((SJIF_t)(task->edfdeadline - next->edfdeadline) >= 0))
+  {
+    prev = next;
+    next = TASK_PTR(next->edfnext);
+  }
+  task->edfprev = TASK_LINK(prev);
+  task->edfnext = TASK_LINK(next);
+  if (next != NULL)
+    next->edfprev = TASK_LINK(task);
+  if (prev != NULL)
+  {
+    prev->edfnext = TASK_LINK(task);
+  }
+  else
+  {
+    posEdfReady_g = task;
+  }
+}
+
+#define pos_edfReady(task) do { \
+          if ((task)->edfperiod != 0) pos_edfInsert(task); } while(0)
+#define pos_edfBlock(task)     pos_edfRemove(task)
+
+/* Returns the x-index of the ready task in the EDF priority level that
+ * has the earliest deadline. This is the head of the queue, only with
+ * SMP the first tasks in the queue may be ready on other cores. Ready
+ * tasks without a deadline are only selected (round robin) when no
+ * deadline task is ready.
+ */
+static UVAR_t POSCALL pos_edfFindBit(void);
+static UVAR_t POSCALL pos_edfFindBit(void)
+{
+  register POSTASK_t task;
+
+  for (task = posEdfReady_g; task != NULL; task = TASK_PTR(task->edfnext))
+  {
+    if ((posReadyTasks_g.xtable[POS_EDF_ROW] & task->bit_x) != 0)
+      return POS_FINDBIT(task->bit_x);
+  }
+  return POS_FINDBIT_EX(posReadyTasks_g.xtable[POS_EDF_ROW],
+                        POS_NEXTROUNDROBIN(POS_EDF_ROW));
+}
+
+#define POS_FINDREADY(ym) \
+  (((ym) == POS_EDF_ROW) ? pos_edfFindBit() : \
+   POS_FINDBIT_EX(posReadyTasks_g.xtable[ym], POS_NEXTROUNDROBIN(ym)))
+
+#else  /* POSCFG_FEATURE_EDF */
+
+#define POS_FINDREADY(ym) \
+  POS_FINDBIT_EX(posReadyTasks_g.xtable[ym], POS_NEXTROUNDROBIN(ym))
+
+#define pos_edfReady(task)     do { } while(0)
+#define pos_edfBlock(task)     do { } while(0)
+
+#endif /* POSCFG_FEATURE_EDF */
+
+
+
 /*---------------------------------------------------------------------------
  * PROTOTYPES OF PRIVATE FUNCTIONS
  *-------------------------------------------------------------------------*/
@@ -298,6 +621,31 @@ static void  POSCALL     pos_schedule(void);
 static void              pos_idletask(void *arg);
 #if SYS_FEATURE_EVENTS != 0
 static VAR_t POSCALL     pos_sched_event(EVENT_t ev);
+static void  POSCALL     pos_semaSignal(EVENT_t ev);
+#endif
+#if POSCFG_CTXSW_ADAPTIVE != 0
+static void  POSCALL     pos_ctxAdapt(void);
+#if POSCFG_FEATURE_HRTIME != 0
+static void  POSCALL     pos_ctxLatency(void);
+#endif
+#endif
+#if POS_TIMERTASK != 0
+static void              pos_timertask(void *arg);
+#endif
+#if POSCFG_FEATURE_SLEEPUNTIL != 0
+static UINT_t POSCALL    pos_ticksUntil(JIF_t deadline);
+#if (POSCFG_FEATURE_SEMAPHORES != 0) && (POSCFG_FEATURE_SEMAWAIT != 0)
+static VAR_t POSCALL     pos_semaWait(POSSEMA_t sema, UINT_t timeoutticks,
+                                      const JIF_t *deadline);
+#endif
+#if (POSCFG_FEATURE_MSGBOXES != 0) && (POSCFG_FEATURE_MSGWAIT != 0)
+static void* POSCALL     pos_messageWait(UINT_t timeoutticks,
+                                         const JIF_t *deadline);
+#endif
+#if (POSCFG_FEATURE_FLAGS != 0) && (POSCFG_FEATURE_FLAGWAIT != 0)
+static VAR_t POSCALL     pos_flagWait(POSFLAG_t flg, UINT_t timeoutticks,
+                                      const JIF_t *deadline);
+#endif
 #endif
 #if (POSCFG_FEATURE_MSGBOXES != 0) && (POSCFG_MSG_MEMORY == 0)
 static MSGBUF_t* POSCALL pos_msgAlloc(void);
@@ -306,12 +654,38 @@ static void  POSCALL     pos_msgFree(MSGBUF_t *mbuf);
 #if POSCFG_FEATURE_SOFTINTS != 0
 static void  POSCALL     pos_execSoftIntQueue(void);
 #endif
+#if POSCFG_FEATURE_STACKCHECK != 0
+static void  POSCALL     pos_checkStack(POSTASK_t task);
+static void  POSCALL     pos_checkNextStack(void);
+#endif
+#if POSCFG_FEATURE_VIRTUALTIME != 0
+static UINT_t POSCALL    pos_nextTimeout(void);
+static void  POSCALL     pos_skipTicks(UINT_t ticks);
+static UVAR_t POSCALL     pos_virtualTick(void);
+#endif
+#if POSCFG_FEATURE_LOCKPROF != 0
+static void  POSCALL     pos_lockProfRecord(POSLOCKSITE_t *site,
+                                            POSCYCLES_t start);
+static void  POSCALL     pos_lockProfSwitch(void);
+#endif
+#if POSCFG_FEATURE_MUTEXPROF != 0
+static void  POSCALL     pos_mutexProfClear(POSMUTEXPROF_t *prof);
+static void  POSCALL     pos_mutexProfLocked(EVENT_t ev);
+static void  POSCALL     pos_mutexProfWaited(EVENT_t ev, POSCYCLES_t start);
+static void  POSCALL     pos_mutexProfUnlocked(EVENT_t ev);
+#endif
 #if POSCFG_FEATURE_LISTS != 0
 #if POSCFG_FEATURE_LISTJOIN != 0
 static void  POSCALL     pos_listJoin(POSLIST_t *prev, POSLIST_t *next,
                                       POSLIST_t *newlist);
 #endif
+static void  POSCALL     pos_listAdd(POSLISTHEAD_t *listhead, UVAR_t pos,
+                                     POSLIST_t *new);
 static void  POSCALL     pos_listRemove(POSLIST_t *listelem);
+#if POSCFG_FEATURE_LISTGETN != 0
+static UINT_t POSCALL    pos_listMove(POSLISTHEAD_t *dest,
+                                      POSLISTHEAD_t *src, UINT_t count);
+#endif
 #endif
 
 
@@ -327,6 +701,22 @@ static void  POSCALL     pos_listRemove(POSLIST_t *listelem);
 #define HAVE_IRQ_DISABLE_ALL
 #endif
 
+#ifndef POS_MEMBARRIER
+#if (SYS_SMP != 0) && defined(__GNUC__)
+#define POS_MEMBARRIER()  __sync_synchronize()
+#else
+#define POS_MEMBARRIER()  do { } while(0)
+#endif
+#endif
+
+#if SYS_SMP != 0
+#define POS_CURRENTTASK  posCoreCurrentTask_g[POS_CPUID]
+#define POS_INTNESTING   posCoreInInterrupt_g[POS_CPUID]
+#else
+#define POS_CURRENTTASK  posCurrentTask_g
+#define POS_INTNESTING   posInInterrupt_g
+#endif
+
 #ifdef POS_DEBUGHELP
 #define tasktimerticks(task)  (task)->deb.timeout
 #define cleartimerticks(task) (task)->deb.timeout = 0
@@ -346,7 +736,40 @@ static UVAR_t posZeroMask_g[7] = {0xFE,0xFC,0xF8,0xF0,0xE0,0xC0,0x80};
 #endif
 
 
-#if SYS_TASKTABSIZE_Y > 1
+#if SYS_TASKTABSIZE_Z > 1
+
+#define pos_setTableBit(table, task) do { \
+    (table)->zmask |= (task)->bit_z; \
+    (table)->ytable[(task)->idx_z] |= (task)->bit_y; \
+    (table)->xtable[(task)->idx_y] |= (task)->bit_x; } while(0)
+
+#define pos_delTableBit(table, task) do { \
+    UVAR_t tbt; \
+    tbt  = (table)->xtable[(task)->idx_y] & ~(task)->bit_x; \
+    (table)->xtable[(task)->idx_y] = tbt; \
+    if (tbt == 0) { \
+      tbt = (table)->ytable[(task)->idx_z] & ~(task)->bit_y; \
+      (table)->ytable[(task)->idx_z] = tbt; \
+      if (tbt == 0) (table)->zmask &= ~(task)->bit_z; } } while(0)
+
+#define pos_isTableBitSet(table, task) \
+    (((table)->xtable[(task)->idx_y] & (task)->bit_x) != 0)
+
+#define pos_isTableEmpty(table)  ((table)->zmask == 0)
+
+#define pos_clearTableRows(table) do { \
+    UVAR_t tbi; \
+    for (tbi = 0; tbi < SYS_TASKTABSIZE_Z; ++tbi) \
+      (table)->ytable[tbi] = 0; \
+    (table)->zmask = 0; } while(0)
+
+#define pos_setTaskRow(task, row) do { \
+    (task)->idx_z = (row) / MVAR_BITS; \
+    (task)->bit_z = pos_shift1l((row) / MVAR_BITS); \
+    (task)->idx_y = (row); \
+    (task)->bit_y = pos_shift1l((row) & (MVAR_BITS - 1)); } while(0)
+
+#elif SYS_TASKTABSIZE_Y > 1
 
 #define pos_setTableBit(table, task) do { \
     (table)->ymask |= (task)->bit_y; \
@@ -361,6 +784,14 @@ static UVAR_t posZeroMask_g[7] = {0xFE,0xFC,0xF8,0xF0,0xE0,0xC0,0x80};
 #define pos_isTableBitSet(table, task) \
     (((table)->xtable[(task)->idx_y] & (task)->bit_x) != 0)
 
+#define pos_isTableEmpty(table)  ((table)->ymask == 0)
+
+#define pos_clearTableRows(table)  (table)->ymask = 0
+
+#define pos_setTaskRow(task, row) do { \
+    (task)->idx_y = (row); \
+    (task)->bit_y = pos_shift1l(row); } while(0)
+
 #else
 
 #define pos_setTableBit(table, task) do { \
@@ -372,18 +803,72 @@ static UVAR_t posZeroMask_g[7] = {0xFE,0xFC,0xF8,0xF0,0xE0,0xC0,0x80};
 #define pos_isTableBitSet(table, task) \
     (((table)->xtable[0] & (task)->bit_x) != 0)
 
+#define pos_isTableEmpty(table)  ((table)->xtable[0] == 0)
+
+#define pos_clearTableRows(table)  do { } while(0)
+
+#define pos_setTaskRow(task, row)  do { } while(0)
+
+#endif
+
+#if SYS_TASKTABSIZE_Z > 1
+
+/* Returns the first row (= highest priority) that has a bit set.
+ */
+static UVAR_t POSCALL pos_findRow(TBITS_t *table);
+static UVAR_t POSCALL pos_findRow(TBITS_t *table)
+{
+  register UVAR_t z = POS_FINDBIT(table->zmask);
+  return (UVAR_t) ((z * MVAR_BITS) + POS_FINDBIT(table->ytable[z]));
+}
+#define POS_FINDROW(table)  pos_findRow(table)
+
+#if defined(pos_zmask)
+/* Returns the first row behind the row "row" that has a bit set.
+ * At least one row with lower priority must have a bit set.
+ */
+static UVAR_t POSCALL pos_findRowBelow(TBITS_t *table, UVAR_t row);
+static UVAR_t POSCALL pos_findRowBelow(TBITS_t *table, UVAR_t row)
+{
+  register UVAR_t z = row / MVAR_BITS;
+  register UVAR_t m = 0;
+
+  if ((row & (MVAR_BITS - 1)) != (MVAR_BITS - 1))
+    m = table->ytable[z] & pos_zmask(row & (MVAR_BITS - 1));
+  if (m == 0)
+  {
+    z = POS_FINDBIT(table->zmask & pos_zmask(z));
+    m = table->ytable[z];
+  }
+  return (UVAR_t) ((z * MVAR_BITS) + POS_FINDBIT(m));
+}
+#define POS_FINDROWBELOW(table, row)  pos_findRowBelow(table, row)
+#endif
+
+#elif SYS_TASKTABSIZE_Y > 1
+
+#define POS_FINDROW(table)  POS_FINDBIT((table)->ymask)
+#define POS_FINDROWBELOW(table, row) \
+          POS_FINDBIT((table)->ymask & pos_zmask(row))
+
+#else
+
+#define POS_FINDROW(table)  0
+
 #endif
 
 #define pos_addToList(list, elem) do { \
-    (elem)->prev = NULL; \
-    (elem)->next = list; \
-    if (list != NULL) list->prev = elem; \
+    (elem)->prev = TASK_NIL; \
+    (elem)->next = TASK_LINK(list); \
+    if (list != NULL) list->prev = TASK_LINK(elem); \
     list = elem; } while(0)
 
 #define pos_removeFromList(list, elem) do { \
-    if ((elem)->next != NULL) (elem)->next->prev = (elem)->prev; \
-    if ((elem)->prev != NULL) (elem)->prev->next = (elem)->next; \
-    else list = (elem)->next; } while(0)
+    if ((elem)->next != TASK_NIL) \
+      TASK_PTR((elem)->next)->prev = (elem)->prev; \
+    if ((elem)->prev != TASK_NIL) \
+      TASK_PTR((elem)->prev)->next = (elem)->next; \
+    else list = TASK_PTR((elem)->next); } while(0)
 
 #if POSCFG_FEATURE_SOFTINTS != 0
 #define softIntsPending()  (sintIdxIn_g != sintIdxOut_g)
@@ -397,6 +882,63 @@ static UVAR_t posZeroMask_g[7] = {0xFE,0xFC,0xF8,0xF0,0xE0,0xC0,0x80};
 #define HOOK_IDLETASK
 #endif
 
+#if POSCFG_FEATURE_STACKCHECK != 0
+#define POS_STACKGUARD_PATTERN  ((UVAR_t) 0xA5C35A3CUL)
+#ifndef HOOK_STACKOVERFLOW
+#define HOOK_STACKOVERFLOW(task) \
+          P_ASSERT("stack overflow detected", 0);
+#endif
+#else
+#define pos_checkStack(task)  do { } while(0)
+#endif
+
+#if POSCFG_FEATURE_LOCKPROF == 0
+#define pos_lockProfSwitch()  do { } while(0)
+#endif
+
+#if POSCFG_FEATURE_MUTEXPROF == 0
+#define pos_mutexProfLocked(ev)         do { } while(0)
+#define pos_mutexProfWaited(ev, start)  do { } while(0)
+#define pos_mutexProfUnlocked(ev)       do { } while(0)
+#endif
+
+#if POSCFG_FEATURE_STATISTICS != 0
+#define pos_statInc(ctr)      ++(ctr)
+#define pos_statDec(ctr)      --(ctr)
+#if POSCFG_FEATURE_HRTIME != 0
+#if SYS_SMP != 0
+#define POS_RUNSTART  posRunStart_g[POS_CPUID]
+#else
+#define POS_RUNSTART  posRunStart_g[0]
+#endif
+/* charges the cycles since the last switch to the current task */
+#define pos_statRunTime() do { \
+    register POSCYCLES_t now = POS_CYCLES(); \
+    POS_CURRENTTASK->stats.runcycles += (POSCYCLES_t)(now - POS_RUNSTART); \
+    POS_RUNSTART = now; \
+  } while(0)
+#define pos_statStart()       do { POS_RUNSTART = POS_CYCLES(); } while(0)
+#else
+#define pos_statRunTime()     do { } while(0)
+#define pos_statStart()       do { } while(0)
+#endif
+#define pos_statSwitch() do { \
+    pos_statRunTime(); \
+    ++posNextTask_g->stats.switches; \
+    ++posSysStats_g.switches; \
+  } while(0)
+#define pos_statMsgAdd(task) do { \
+    if (++(task)->stats.msgcount > (task)->stats.msgmax) \
+      (task)->stats.msgmax = (task)->stats.msgcount; \
+  } while(0)
+#else
+#define pos_statInc(ctr)      do { } while(0)
+#define pos_statDec(ctr)      do { } while(0)
+#define pos_statSwitch()      do { } while(0)
+#define pos_statStart()       do { } while(0)
+#define pos_statMsgAdd(task)  do { } while(0)
+#endif
+
 #ifdef POS_DEBUGHELP
 #define pos_taskHistory(debtask) do { \
     picodeb_taskhistory[2] = picodeb_taskhistory[1]; \
@@ -415,7 +957,7 @@ static UVAR_t posZeroMask_g[7] = {0xFE,0xFC,0xF8,0xF0,0xE0,0xC0,0x80};
 
 #if SYS_TASKDOUBLELINK == 0
 #define pos_addToSleepList(task) do { \
-    (task)->next = posSleepingTasks_g; \
+    (task)->next = TASK_LINK(posSleepingTasks_g); \
     posSleepingTasks_g = task; } while(0)
 #endif
 
@@ -430,7 +972,7 @@ static void POSCALL pos_eventAddTask(EVENT_t ev, POSTASK_t task)
   task->deb.event = &ev->e.deb;
 #endif
 #if SYS_TASKEVENTLINK != 0
-  task->event = (void*)ev;
+  task->event = EV_LINK(ev);
 #endif
   pos_setTableBit(&ev->e.pend, task);
 }
@@ -442,7 +984,7 @@ static void POSCALL pos_eventRemoveTask(EVENT_t ev, POSTASK_t task)
   task->deb.event = NULL;
 #endif
 #if SYS_TASKEVENTLINK != 0
-  task->event = NULL;
+  task->event = EV_NIL;
 #endif
   pos_delTableBit(&ev->e.pend, task);
 }
@@ -458,8 +1000,14 @@ static void POSCALL pos_eventRemoveTask(EVENT_t ev, POSTASK_t task)
 
 #if POSCFG_FASTCODE != 0
 
-#define pos_enableTask(task)    pos_setTableBit(&posReadyTasks_g, task)
-#define pos_disableTask(task)   pos_delTableBit(&posReadyTasks_g, task)
+#if SYS_SMP == 0
+#define pos_enableTask(task) do { \
+          pos_setTableBit(&posReadyTasks_g, task); \
+          pos_edfReady(task); } while(0)
+#define pos_disableTask(task) do { \
+          pos_delTableBit(&posReadyTasks_g, task); \
+          pos_edfBlock(task); } while(0)
+#endif
 
 #if SYS_TASKDOUBLELINK != 0
 #define pos_addToSleepList(task) \
@@ -469,26 +1017,38 @@ static void POSCALL pos_eventRemoveTask(EVENT_t ev, POSTASK_t task)
 #endif  /* SYS_TASKDOUBLELINK */
 
 #if POSCFG_FEATURE_TIMER != 0
-#define pos_addToTimerList(timer) \
-          pos_addToList(posActiveTimers_g, timer)
+#define pos_addToTimerList(timer) do { \
+          (timer)->prev = TMR_NIL; \
+          (timer)->next = TMR_LINK(posActiveTimers_g); \
+          if (posActiveTimers_g != NULL) \
+            posActiveTimers_g->prev = TMR_LINK(timer); \
+          posActiveTimers_g = timer; } while (0)
 #define pos_removeFromTimerList(timer) do { \
-          pos_removeFromList(posActiveTimers_g, timer); \
-          timer->prev = timer; } while (0)
+          if ((timer)->next != TMR_NIL) \
+            TMR_PTR((timer)->next)->prev = (timer)->prev; \
+          if ((timer)->prev != TMR_NIL) \
+            TMR_PTR((timer)->prev)->next = (timer)->next; \
+          else posActiveTimers_g = TMR_PTR((timer)->next); \
+          (timer)->prev = TMR_LINK(timer); } while (0)
 #endif  /* POSCFG_FEATURE_TIMER */
 
 #else /* POSCFG_FASTCODE */
 
+#if SYS_SMP == 0
 static void POSCALL pos_disableTask(POSTASK_t task);
 static void POSCALL pos_disableTask(POSTASK_t task)
 {
   pos_delTableBit(&posReadyTasks_g, task);
+  pos_edfBlock(task);
 }
 
 static void POSCALL pos_enableTask(POSTASK_t task);
 static void POSCALL pos_enableTask(POSTASK_t task)
 {
   pos_setTableBit(&posReadyTasks_g, task);
+  pos_edfReady(task);
 }
+#endif
 
 #if SYS_TASKDOUBLELINK != 0
 static void POSCALL pos_addToSleepList(POSTASK_t task);
@@ -508,14 +1068,23 @@ static void POSCALL pos_removeFromSleepList(POSTASK_t task)
 static void POSCALL pos_addToTimerList(TIMER_t *timer);
 static void POSCALL pos_addToTimerList(TIMER_t *timer)
 {
-  pos_addToList(posActiveTimers_g, timer);
+  timer->prev = TMR_NIL;
+  timer->next = TMR_LINK(posActiveTimers_g);
+  if (posActiveTimers_g != NULL)
+    posActiveTimers_g->prev = TMR_LINK(timer);
+  posActiveTimers_g = timer;
 }
 
 static void POSCALL pos_removeFromTimerList(TIMER_t *timer);
 static void POSCALL pos_removeFromTimerList(TIMER_t *timer)
 {
-  pos_removeFromList(posActiveTimers_g, timer);
-  timer->prev = timer;
+  if (timer->next != TMR_NIL)
+    TMR_PTR(timer->next)->prev = timer->prev;
+  if (timer->prev != TMR_NIL)
+    TMR_PTR(timer->prev)->next = timer->next;
+  else
+    posActiveTimers_g = TMR_PTR(timer->next);
+  timer->prev = TMR_LINK(timer);
 }
 #endif  /* POSCFG_FEATURE_TIMER */
 
@@ -523,6 +1092,224 @@ static void POSCALL pos_removeFromTimerList(TIMER_t *timer)
 
 
 
+/*---------------------------------------------------------------------------
+ * SYMMETRIC MULTIPROCESSING
+ *-------------------------------------------------------------------------*/
+
+#if SYS_SMP != 0
+
+/* Every core has its own table of ready tasks, and each ready task is
+ * in exactly one of these tables (task->core). A core only selects
+ * tasks from its own table. Tasks that are not running can be moved
+ * to another core at any time, even when they were preempted by an
+ * interrupt. Therefore a task must not read a per-core variable
+ * without holding the kernel lock, except through the functions
+ * c_pos_smpCurrentTask and c_pos_smpInInterrupt.
+ */
+
+#define POS_SMP_ALLCORES \
+          ((UVAR_t)(((UVAR_t)~0) >> (MVAR_BITS - POSCFG_SMP_CORES)))
+
+#if SYS_TASKTABSIZE_Y > 1
+#define POS_TASKROW(task)  ((task)->idx_y)
+#else
+#define POS_TASKROW(task)  0
+#endif
+
+#define pos_enableTask(task)    pos_smpEnableTask(task)
+#define pos_disableTask(task) do { \
+          pos_delTableBit(&posCoreReadyTasks_g[(task)->core], task); \
+          pos_edfBlock(task); } while(0)
+#define pos_countSwitch()       ++posCoreSwitchCtr_g[POS_CPUID]
+
+/* Reads a per-core variable of the calling core. The read is repeated
+ * when a context switch happened on the core meanwhile, because the
+ * calling task may have been moved to another core.
+ */
+static UVAR_t POSCALL pos_smpReadVar(volatile UVAR_t *vars);
+static UVAR_t POSCALL pos_smpReadVar(volatile UVAR_t *vars)
+{
+  register UVAR_t c, ctr, v;
+
+  do
+  {
+    c   = POS_CPUID;
+    ctr = posCoreSwitchCtr_g[c];
+    v   = vars[c];
+  }
+  while ((c != POS_CPUID) || (ctr != posCoreSwitchCtr_g[c]));
+  return v;
+}
+
+/* Returns the count of bits set in a bit field.
+ */
+static UVAR_t POSCALL pos_smpBitCount(UVAR_t bits);
+static UVAR_t POSCALL pos_smpBitCount(UVAR_t bits)
+{
+  register UVAR_t n = 0;
+
+  while (bits != 0)
+  {
+    bits &= bits - 1;
+    ++n;
+  }
+  return n;
+}
+
+/* Requests a core to run its scheduler.
+ */
+static void POSCALL pos_smpKick(UVAR_t core);
+static void POSCALL pos_smpKick(UVAR_t core)
+{
+  if (core == POS_CPUID)
+  {
+    posMustSchedule_g = 1;
+  }
+  else
+  {
+    posCoreMustSchedule_g[core] = 1;
+    if (posCoreCurrentTask_g[core] != NULL)
+      p_pos_ipiReschedule(core);
+  }
+}
+
+/* Returns the allowed core with the least important work: the core
+ * whose best ready task has the lowest priority. On equal priority the
+ * core with fewer ready tasks at that level wins, then the last core.
+ */
+static UVAR_t POSCALL pos_smpSelectCore(POSTASK_t task);
+static UVAR_t POSCALL pos_smpSelectCore(POSTASK_t task)
+{
+  register UVAR_t c, best, row, cnt, r, n;
+
+  best = task->core;
+  row  = 0;
+  cnt  = 0;
+  for (c = 0; c < POSCFG_SMP_CORES; ++c)
+  {
+    if ((task->affinity & pos_shift1l(c)) != 0)
+    {
+      r = POS_FINDROW(&posCoreReadyTasks_g[c]);
+      n = pos_smpBitCount(posCoreReadyTasks_g[c].xtable[r]);
+      ++r;
+      if ((r > row) ||
+          ((r == row) && ((n < cnt) || ((n == cnt) && (c == task->core)))))
+      {
+        best = c;
+        row  = r;
+        cnt  = n;
+      }
+    }
+  }
+  return best;
+}
+
+/* Makes a task ready to run. A task that is not running is placed on
+ * the core with the least important work (wake-up load balancing), and
+ * that core is interrupted when the task should preempt its current task.
+ */
+static void POSCALL pos_smpEnableTask(POSTASK_t task);
+static void POSCALL pos_smpEnableTask(POSTASK_t task)
+{
+  register POSTASK_t cur;
+  register UVAR_t c;
+
+  /* a task that blocked while the scheduler was locked is still running */
+  for (c = 0; c < POSCFG_SMP_CORES; ++c)
+  {
+    if (posCoreCurrentTask_g[c] == task)
+      break;
+  }
+  if (c == POSCFG_SMP_CORES)
+    task->core = pos_smpSelectCore(task);
+
+  c = task->core;
+  pos_setTableBit(&posCoreReadyTasks_g[c], task);
+  pos_edfReady(task);
+  cur = posCoreCurrentTask_g[c];
+  if ((c != POS_CPUID) && (cur != NULL) &&
+      (POS_TASKROW(task) <= POS_TASKROW(cur)))
+  {
+    pos_smpKick(c);
+  }
+}
+
+/* Moves the current task to another core when its affinity mask does
+ * not contain this core any more. Called by the scheduler before it
+ * selects the next task, so the current task is switched away.
+ */
+static void POSCALL pos_smpCheckAffinity(void);
+static void POSCALL pos_smpCheckAffinity(void)
+{
+  register POSTASK_t task = posCoreCurrentTask_g[POS_CPUID];
+
+  if (((task->affinity & pos_shift1l(task->core)) == 0) &&
+      pos_isTableBitSet(&posReadyTasks_g, task))
+  {
+    pos_delTableBit(&posReadyTasks_g, task);
+    task->core = pos_smpSelectCore(task);
+    pos_setTableBit(&posCoreReadyTasks_g[task->core], task);
+    pos_smpKick(task->core);
+  }
+}
+
+/* Called from the timer interrupt of each core (periodic load
+ * balancing). A task that waits on another core is moved to this core
+ * when it has a higher priority than all ready tasks of this core, or
+ * when the other core has at least two tasks more at the priority
+ * level this core is running.
+ */
+static void POSCALL pos_smpPull(void);
+static void POSCALL pos_smpPull(void)
+{
+  register TBITS_t   *table;
+  register POSTASK_t task;
+  register UVAR_t c, y, bits, me, myrow, mycnt;
+
+  me    = POS_CPUID;
+  myrow = POS_FINDROW(&posCoreReadyTasks_g[me]);
+  mycnt = pos_smpBitCount(posCoreReadyTasks_g[me].xtable[myrow]);
+
+  for (c = 0; c < POSCFG_SMP_CORES; ++c)
+  {
+    if (c == me)
+      continue;
+    table = &posCoreReadyTasks_g[c];
+    for (y = POS_FINDROW(table); y <= myrow; ++y)
+    {
+      bits = table->xtable[y];
+      if ((y == myrow) && (pos_smpBitCount(bits) < (UVAR_t)(mycnt + 2)))
+        break;
+      while (bits != 0)
+      {
+        task = posTaskTable_g[(y * SYS_TASKTABSIZE_X) + POS_FINDBIT(bits)];
+        bits &= ~task->bit_x;
+        if ((task != posCoreCurrentTask_g[c]) &&
+            ((task->affinity & pos_shift1l(me)) != 0))
+        {
+          pos_delTableBit(table, task);
+          task->core = me;
+          pos_setTableBit(&posCoreReadyTasks_g[me], task);
+          posMustSchedule_g = 1;
+          return;
+        }
+      }
+    }
+  }
+}
+
+#if defined(HAVE_IRQ_DISABLE_ALL) && (POSCFG_FEATURE_SOFTINTS != 0)
+#error POS_IRQ_DISABLE_ALL must not be defined when POSCFG_SMP_CORES > 1
+#endif
+
+#else /* SYS_SMP */
+
+#define pos_countSwitch()  do { } while(0)
+
+#endif /* SYS_SMP */
+
+
+
 /*---------------------------------------------------------------------------
  * PRIVATE FUNCTIONS
  *-------------------------------------------------------------------------*/
@@ -547,20 +1334,286 @@ static void POSCALL pos_listJoin(POSLIST_t *prev, POSLIST_t *next,
 }
 #endif
 
-static void POSCALL pos_listRemove(POSLIST_t *listelem)
+static void POSCALL pos_listAdd(POSLISTHEAD_t *listhead, UVAR_t pos,
+                                POSLIST_t *new)
+{
+  register POSLIST_t *next, *prev;
+  if (pos == POSLIST_HEAD)
+  {
+    next = listhead->next;
+    prev = (POSLIST_t*) listhead;
+  }
+  else
+  {
+    next = (POSLIST_t*) listhead;
+    prev = listhead->prev;
+  }
+  next->prev = new;
+  new->next  = next;
+  new->prev  = prev;
+  prev->next = new;
+#if POSCFG_FEATURE_LISTLEN != 0
+  new->head  = listhead;
+  listhead->length++;
+#endif
+}
+
+static void POSCALL pos_listRemove(POSLIST_t *listelem)
+{
+  register POSLIST_t *prev, *next;
+  prev = listelem->prev;
+  next = listelem->next;  
+  next->prev = prev;
+  prev->next = next;
+#ifdef _DBG
+#if POSCFG_FEATURE_LISTLEN != 0
+  listelem->head = NULL;
+#endif
+#endif
+}
+
+#if POSCFG_FEATURE_LISTGETN != 0
+/* Moves up to count elements from the head of the list src to the
+ * tail of the list dest. Returns the number of moved elements.
+ */
+static UINT_t POSCALL pos_listMove(POSLISTHEAD_t *dest,
+                                   POSLISTHEAD_t *src, UINT_t count)
+{
+  register POSLIST_t *first, *last, *elem;
+  register UINT_t n;
+
+  first = src->next;
+  last  = (POSLIST_t*) src;
+  elem  = first;
+  for (n = 0; (n < count) && (elem != (POSLIST_t*) src); ++n)
+  {
+#if POSCFG_FEATURE_LISTLEN != 0
+    elem->head = dest;
+#endif
+    last = elem;
+    elem = elem->next;
+  }
+  if (n != 0)
+  {
+    src->next        = elem;
+    elem->prev       = (POSLIST_t*) src;
+    first->prev      = dest->prev;
+    dest->prev->next = first;
+    last->next       = (POSLIST_t*) dest;
+    dest->prev       = last;
+#if POSCFG_FEATURE_LISTLEN != 0
+    src->length  -= n;
+    dest->length += n;
+#endif
+  }
+  return n;
+}
+#endif
+#endif /* POSCFG_FEATURE_LISTS */
+
+#if POSCFG_FEATURE_STACKCHECK != 0
+/* Tests the guard words of a task stack. The kernel must be locked.
+ * An overflow is reported only once, the guard is disabled afterwards.
+ */
+static void POSCALL pos_checkStack(POSTASK_t task)
+{
+  register UVAR_t *guard = task->stkguard;
+  register UVAR_t i;
+
+  if (guard != NULL)
+  {
+    for (i = 0; i < POSCFG_STACKGUARD_WORDS; ++i)
+    {
+      if (guard[i] != POS_STACKGUARD_PATTERN)
+      {
+        task->stkguard = NULL;
+        HOOK_STACKOVERFLOW(task)
+        break;
+      }
+    }
+  }
+}
+#endif
+
+#if POSCFG_FEATURE_STACKCHECK != 0
+/* Tests the stack of the next task in the task table.
+ * Up to MVAR_BITS unused table entries are skipped per call.
+ * The kernel must be locked.
+ */
+static void POSCALL pos_checkNextStack(void)
+{
+  register POSTASK_t task;
+  register UVAR_t i;
+
+  for (i = 0; i < MVAR_BITS; ++i)
+  {
+    if (++posStackCheckIdx_g >= (SYS_TASKTABSIZE_X * SYS_TASKTABSIZE_Y))
+      posStackCheckIdx_g = 0;
+    task = posTaskTable_g[posStackCheckIdx_g];
+    if ((task != NULL) && (task->stkguard != NULL))
+    {
+      pos_checkStack(task);
+      break;
+    }
+  }
+}
+#endif
+
+#if POSCFG_FEATURE_LOCKPROF != 0
+/* Adds the hold time of a completed critical section to the
+ * statistics of its call site. The kernel must be locked.
+ */
+static void POSCALL pos_lockProfRecord(POSLOCKSITE_t *site,
+                                       POSCYCLES_t start)
+{
+  register POSCYCLES_t held = POS_CYCLES() - start;
+  register POSCYCLES_t limit = POSCFG_LOCKPROF_MINCYCLES;
+  register UVAR_t b = 0;
+
+  if (site->listed == 0)
+  {
+    site->next = posLockSites_g;
+    posLockSites_g = site;
+    site->listed = 1;
+  }
+  ++site->stats.count;
+  if (held > site->stats.max)
+    site->stats.max = held;
+  while ((held >= limit) && (b < POSCFG_LOCKPROF_BUCKETS - 1))
+  {
+    limit <<= 1;
+    ++b;
+  }
+  ++site->stats.hist[b];
+}
+
+/* Ends the measurement of the current critical section before a
+ * context switch. The next task may resume with the kernel unlocked
+ * (e.g. a newly created task), so the measurement can not be
+ * continued after the switch. The kernel must be locked.
+ */
+static void POSCALL pos_lockProfSwitch(void)
+{
+  register LOCKPROF_t *lp = &posLockProf_g[POS_LOCKPROF_IRQ];
+
+  if (lp->depth != 0)
+  {
+    pos_lockProfRecord(lp->site, lp->start);
+    lp->depth = 0;
+  }
+}
+#endif
+
+#if POSCFG_FEATURE_VIRTUALTIME != 0
+/* Returns the count of ticks until the next task timeout or timer
+ * expires, or zero when nothing waits for a timeout.
+ * The kernel must be locked.
+ */
+static UINT_t POSCALL pos_nextTimeout(void)
+{
+  register POSTASK_t task;
+#if POSCFG_FEATURE_TIMER != 0
+  register TIMER_t   *tmr;
+#endif
+  register UINT_t ticks = 0;
+
+  for (task = posSleepingTasks_g; task != NULL; task = TASK_PTR(task->next))
+  {
+    if ((ticks == 0) || (tasktimerticks(task) < ticks))
+      ticks = tasktimerticks(task);
+  }
+#if POSCFG_FEATURE_TIMER != 0
+  for (tmr = posActiveTimers_g; tmr != NULL; tmr = TMR_PTR(tmr->next))
+  {
+    if ((ticks == 0) || (tmr->counter < ticks))
+      ticks = tmr->counter;
+  }
+#endif
+  return ticks;
+}
+
+/* Advances the system time by several ticks at once. The count of
+ * ticks must be lower than the value returned by pos_nextTimeout,
+ * so no timeout expires. The kernel must be locked.
+ */
+static void POSCALL pos_skipTicks(UINT_t ticks)
+{
+  register POSTASK_t task;
+#if POSCFG_FEATURE_TIMER != 0
+  register TIMER_t   *tmr;
+#endif
+
+#if POS_TIMESEQ != 0
+  ++pos_timeSeq_g;
+  POS_MEMBARRIER();
+#endif
+#if POSCFG_FEATURE_JIFFIES != 0
+#if POSCFG_FEATURE_LARGEJIFFIES == 0
+  jiffies += (JIF_t) ticks;
+#else
+  pos_jiffies_g += (JIF_t) ticks;
+#endif
+#endif
+#if POSCFG_FEATURE_HRTIME != 0
+  pos_hrTicks_g += ticks;
+#endif
+#if POS_TIMESEQ != 0
+  POS_MEMBARRIER();
+  ++pos_timeSeq_g;
+#endif
+
+  for (task = posSleepingTasks_g; task != NULL; task = TASK_PTR(task->next))
+    tasktimerticks(task) -= ticks;
+#if POSCFG_FEATURE_TIMER != 0
+  for (tmr = posActiveTimers_g; tmr != NULL; tmr = TMR_PTR(tmr->next))
+    tmr->counter -= ticks;
+#endif
+}
+
+/* Executes the next timer tick in virtual time mode. This function
+ * is called by the idle task with the kernel unlocked. When no other
+ * task is ready, the time jumps directly to the next timeout.
+ * Returns zero when no tick was executed because nothing waits for
+ * a timeout.
+ */
+static UVAR_t POSCALL pos_virtualTick(void)
 {
-  register POSLIST_t *prev, *next;
-  prev = listelem->prev;
-  next = listelem->next;  
-  next->prev = prev;
-  prev->next = next;
-#ifdef _DBG
-#if POSCFG_FEATURE_LISTLEN != 0
-  listelem->head = NULL;
+  register POSTASK_t self = POS_CURRENTTASK;
+  register UINT_t ticks;
+  register UVAR_t idle;
+  POS_LOCKFLAGS;
+
+  POS_SCHED_LOCK;
+  pos_delTableBit(&posReadyTasks_g, self);
+  idle = pos_isTableEmpty(&posReadyTasks_g);
+  pos_setTableBit(&posReadyTasks_g, self);
+  if (idle != 0)
+  {
+    ticks = pos_nextTimeout();
+    if (ticks == 0)
+    {
+      /* all tasks wait for an event that is not bound to the time */
+      POS_SCHED_UNLOCK;
+      return 0;
+    }
+    if (ticks > 1)
+      pos_skipTicks(ticks - 1);
+  }
+
+  /* the timer interrupt is executed like a real interrupt */
+  ++POS_INTNESTING;
+#if POSCFG_ISR_INTERRUPTABLE != 0
+  POS_SCHED_UNLOCK;
 #endif
+  c_pos_timerInterrupt();
+#if POSCFG_ISR_INTERRUPTABLE != 0
+  POS_SCHED_LOCK;
 #endif
+  --POS_INTNESTING;
+  POS_SCHED_UNLOCK;
+  return 1;
 }
-#endif /* POSCFG_FEATURE_LISTS */
+#endif
 
 static void pos_idletask(void *arg)
 {
@@ -578,8 +1631,20 @@ static void pos_idletask(void *arg)
     posCurrentTask_g->deb.state = task_suspended;
 #endif
     pos_schedule();
+#if POSCFG_FEATURE_STACKCHECK != 0
+    /* check the stack of one task per idle loop, so that also tasks
+       that are not switched for a long time are tested */
+    pos_checkNextStack();
+#endif
     POS_SCHED_UNLOCK;
-    HOOK_IDLETASK
+#if POSCFG_FEATURE_VIRTUALTIME != 0
+    /* the idle hook may wait for the next interrupt, so it is only
+       executed when the time can not wake up a task */
+    if (pos_virtualTick() == 0)
+#endif
+    {
+      HOOK_IDLETASK
+    }
 #if POSCFG_FEATURE_IDLETASKHOOK != 0
     if (posIdleTaskFuncHook_g != NULL)
       (posIdleTaskFuncHook_g)();
@@ -601,7 +1666,7 @@ static void POSCALL pos_execSoftIntQueue(void)
   POS_LOCKFLAGS;
   POS_IRQ_DISABLE_ALL;
 #endif
-  ++posInInterrupt_g;
+  ++POS_INTNESTING;
   do
   {
     intno = softintqueue_g[sintIdxOut_g].intno;
@@ -619,7 +1684,7 @@ static void POSCALL pos_execSoftIntQueue(void)
       sintIdxOut_g = 0;
   }
   while (sintIdxIn_g != sintIdxOut_g);
-  --posInInterrupt_g;
+  --POS_INTNESTING;
 #ifdef HAVE_IRQ_DISABLE_ALL
   POS_IRQ_ENABLE_ALL;
 #endif
@@ -636,7 +1701,7 @@ static void POSCALL pos_schedule(void)
 {
   register UVAR_t ym, xt;
 
-  if (posInInterrupt_g == 0)
+  if (POS_INTNESTING == 0)
   {
     pos_doSoftInts();
 #if POSCFG_FEATURE_INHIBITSCHED != 0
@@ -645,16 +1710,19 @@ static void POSCALL pos_schedule(void)
 #endif
       posMustSchedule_g = 0;
 #if POSCFG_CTXSW_COMBINE > 1
+      pos_ctxScheduled();
       posCtxCombineCtr_g = 0;
 #endif
+#if SYS_SMP != 0
+      pos_smpCheckAffinity();
+#endif
 
 #if SYS_TASKTABSIZE_Y > 1
-      ym = POS_FINDBIT(posReadyTasks_g.ymask);
+      ym = POS_FINDROW(&posReadyTasks_g);
 #else
       ym = 0;
 #endif
-      xt = POS_FINDBIT_EX(posReadyTasks_g.xtable[ym],
-                          POS_NEXTROUNDROBIN(ym));
+      xt = POS_FINDREADY(ym);
 
 #if (SYS_TASKTABSIZE_X > 1) && (POSCFG_ROUNDROBIN != 0)
       posNextRoundRobin_g[ym] = (xt + 1) & (SYS_TASKTABSIZE_X - 1);
@@ -662,8 +1730,12 @@ static void POSCALL pos_schedule(void)
 
       posNextTask_g = posTaskTable_g[(ym * SYS_TASKTABSIZE_X) + xt];
 
-      if (posCurrentTask_g != posNextTask_g)
+      if (POS_CURRENTTASK != posNextTask_g)
       {
+        pos_countSwitch();
+        pos_statSwitch();
+        pos_checkStack(POS_CURRENTTASK);
+        pos_lockProfSwitch();
 #ifdef POS_DEBUGHELP
         posNextTask_g->deb.state = task_running;
         pos_taskHistory(&posNextTask_g->deb);
@@ -672,6 +1744,11 @@ static void POSCALL pos_schedule(void)
       }
 #if POSCFG_FEATURE_INHIBITSCHED != 0
     }
+    else
+    {
+      /* let posTaskSchedUnlock do the scheduling */
+      posMustSchedule_g = 1;
+    }
 #endif
   }
 #ifdef POS_DEBUGHELP
@@ -689,6 +1766,12 @@ static VAR_t POSCALL pos_sched_event(EVENT_t ev)
   register UVAR_t  ym, xt;
   register POSTASK_t task;
 
+#if POSCFG_CTXSW_ADAPTIVE != 0
+  ++posCtxTickEvents_g;
+  ++posCtxStats_g.events;
+#endif
+  pos_statInc(ev->e.stats.signals);
+
 #if POSCFG_FEATURE_SOFTINTS != 0
   if (softIntsPending())
   {
@@ -700,9 +1783,9 @@ static VAR_t POSCALL pos_sched_event(EVENT_t ev)
 #endif
 
 #if SYS_TASKTABSIZE_Y > 1
-  if (ev->e.pend.ymask != 0)
+  if (!pos_isTableEmpty(&ev->e.pend))
   {
-    ym = POS_FINDBIT(ev->e.pend.ymask);
+    ym = POS_FINDROW(&ev->e.pend);
     xt = POS_FINDBIT_EX(ev->e.pend.xtable[ym],
                         POS_NEXTROUNDROBIN(ym));
 #else
@@ -716,6 +1799,7 @@ static VAR_t POSCALL pos_sched_event(EVENT_t ev)
 
     pos_eventRemoveTask(ev, task);
     pos_enableTask(task);
+    pos_statInc(task->stats.wakeups);
     posMustSchedule_g = 1;
 
 #if (POSCFG_SOFT_MTASK == 0) || (POSCFG_CTXSW_COMBINE == 1)
@@ -731,13 +1815,18 @@ static VAR_t POSCALL pos_sched_event(EVENT_t ev)
 #endif
 #endif
 #if POSCFG_CTXSW_COMBINE > 1
-    if (++posCtxCombineCtr_g >= POSCFG_CTXSW_COMBINE)
+    if (++posCtxCombineCtr_g >= POS_CTXSW_THRESHOLD)
     {
       pos_schedule();
     }
     else
 #endif
-    do { } while(0);
+    {
+#if POSCFG_CTXSW_ADAPTIVE != 0
+      ++posCtxStats_g.deferred;
+      pos_ctxDeferred();
+#endif
+    }
 #endif /* else (POSCFG_SOFT_MTASK == 0) || (POSCFG_CTXSW_COMBINE == 1) */
     return 1;
   }
@@ -746,6 +1835,110 @@ static VAR_t POSCALL pos_sched_event(EVENT_t ev)
 
 #endif  /* SYS_FEATURE_EVENTS */
 
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_CTXSW_ADAPTIVE != 0
+
+/* Tunes the context switch combine threshold. This function is called
+ * once per timer tick with the kernel locked. The threshold follows
+ * half the count of events that were signalled in the last tick.
+ * When a woken task had to wait for the timer tick although the event
+ * rate has dropped, the threshold is lowered at once to keep the
+ * switch latency short under light load. With the cycle counter, the
+ * threshold is also not raised while the measured latency is above
+ * ::POSCFG_CTXSW_LATENCY.
+ */
+static void POSCALL pos_ctxAdapt(void)
+{
+  register UINT_t target;
+#if POSCFG_FEATURE_HRTIME != 0
+  register POSCYCLES_t latency;
+#endif
+
+  target = posCtxTickEvents_g / 2;
+  posCtxTickEvents_g = 0;
+  if (target > POSCFG_CTXSW_COMBINE)
+    target = POSCFG_CTXSW_COMBINE;
+  if (target == 0)
+    target = 1;
+
+#if POSCFG_FEATURE_HRTIME != 0
+  /* a wakeup that still waits for the switch counts for this tick */
+  latency = posCtxTickLatency_g;
+  if ((posCtxPending_g != 0) &&
+      ((POSCYCLES_t) (POS_CYCLES() - posCtxWakeCycles_g) > latency))
+  {
+    latency = POS_CYCLES() - posCtxWakeCycles_g;
+  }
+  posCtxTickLatency_g = 0;
+  posCtxStats_g.latency = latency;
+#endif
+
+  if (posCtxCombineCtr_g != 0)
+  {
+    ++posCtxStats_g.delayed;
+    if (target < posCtxCombineThr_g)
+    {
+      posCtxCombineThr_g = (UVAR_t) target;
+      return;
+    }
+  }
+#if POSCFG_FEATURE_HRTIME != 0
+  if (latency > posCtxMaxLatency_g)
+  {
+    if (target < posCtxCombineThr_g)
+      posCtxCombineThr_g = (UVAR_t) target;
+    return;
+  }
+#endif
+  posCtxCombineThr_g = (UVAR_t) ((posCtxCombineThr_g + target + 1) / 2);
+}
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_HRTIME != 0
+
+/* Measures the time from the first deferred wakeup until the scheduler
+ * runs. Called with the kernel locked when wakeups are pending.
+ */
+static void POSCALL pos_ctxLatency(void)
+{
+  register POSCYCLES_t latency = POS_CYCLES() - posCtxWakeCycles_g;
+
+  posCtxPending_g = 0;
+  if (latency > posCtxTickLatency_g)
+    posCtxTickLatency_g = latency;
+  if (latency > posCtxStats_g.maxlatency)
+    posCtxStats_g.maxlatency = latency;
+}
+
+#endif
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posCtxSwitchStats(POSCTXSTATS_t *stats)
+{
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posCtxSwitchStats: stats valid", stats != NULL);
+  if (stats == NULL)
+    return -E_ARG;
+
+  POS_SCHED_LOCK;
+  stats->events    = posCtxStats_g.events;
+  stats->deferred  = posCtxStats_g.deferred;
+  stats->delayed   = posCtxStats_g.delayed;
+  stats->threshold = posCtxCombineThr_g;
+#if POSCFG_FEATURE_HRTIME != 0
+  stats->latency    = posCtxStats_g.latency;
+  stats->maxlatency = posCtxStats_g.maxlatency;
+#endif
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+#endif /* POSCFG_CTXSW_ADAPTIVE */
+
 
 
 /*---------------------------------------------------------------------------
@@ -772,11 +1965,11 @@ void POSCALL c_pos_intEnter(void)
 #if POSCFG_ISR_INTERRUPTABLE != 0
   POS_LOCKFLAGS;
   POS_SCHED_LOCK;
-  ++posInInterrupt_g;
+  ++POS_INTNESTING;
   pos_taskHistory(NULL);
   POS_SCHED_UNLOCK;
 #else
-  ++posInInterrupt_g;
+  ++POS_INTNESTING;
   pos_taskHistory(NULL);
 #endif
 }
@@ -792,7 +1985,7 @@ void POSCALL c_pos_intExit(void)
   POS_SCHED_LOCK;
 #endif
 
-  if (--posInInterrupt_g == 0)
+  if (--POS_INTNESTING == 0)
   {
     pos_doSoftInts();
 #if POSCFG_FEATURE_INHIBITSCHED != 0
@@ -803,16 +1996,19 @@ void POSCALL c_pos_intExit(void)
       {
         posMustSchedule_g = 0;
 #if POSCFG_CTXSW_COMBINE > 1
+        pos_ctxScheduled();
         posCtxCombineCtr_g = 0;
 #endif
+#if SYS_SMP != 0
+        pos_smpCheckAffinity();
+#endif
 
 #if SYS_TASKTABSIZE_Y > 1
-        ym = POS_FINDBIT(posReadyTasks_g.ymask);
+        ym = POS_FINDROW(&posReadyTasks_g);
 #else
         ym = 0;
 #endif
-        xt = POS_FINDBIT_EX(posReadyTasks_g.xtable[ym],
-                            POS_NEXTROUNDROBIN(ym));
+        xt = POS_FINDREADY(ym);
 
 #if (SYS_TASKTABSIZE_X > 1) && (POSCFG_ROUNDROBIN != 0)
         posNextRoundRobin_g[ym] = (xt + 1) & (SYS_TASKTABSIZE_X - 1);
@@ -820,12 +2016,16 @@ void POSCALL c_pos_intExit(void)
 
         posNextTask_g = posTaskTable_g[(ym * SYS_TASKTABSIZE_X) + xt];
 
-        if (posCurrentTask_g != posNextTask_g)
+        if (POS_CURRENTTASK != posNextTask_g)
         {
 #if POSCFG_ISR_INTERRUPTABLE == 0
           /* all ctx switch functions need to be called with lock acquired */
           POS_SCHED_LOCK;
 #endif
+          pos_countSwitch();
+          pos_statSwitch();
+          pos_checkStack(POS_CURRENTTASK);
+          pos_lockProfSwitch();
 #ifdef POS_DEBUGHELP
           posCurrentTask_g->deb.state = task_suspended;
           posNextTask_g->deb.state = task_running;
@@ -856,6 +2056,27 @@ void POSCALL c_pos_intExit(void)
 
 /*-------------------------------------------------------------------------*/
 
+#if POSCFG_FEATURE_STACKCHECK != 0
+void POSCALL c_pos_setStackGuard(POSTASK_t task, void *guard)
+{
+  register UVAR_t *g = (UVAR_t*) guard;
+  register UVAR_t i;
+
+  P_ASSERT("c_pos_setStackGuard: guard aligned",
+           ((MEMPTR_t) guard & (sizeof(UVAR_t) - 1)) == 0);
+  if (g != NULL)
+  {
+    for (i = 0; i < POSCFG_STACKGUARD_WORDS; ++i)
+    {
+      g[i] = POS_STACKGUARD_PATTERN;
+    }
+  }
+  task->stkguard = g;
+}
+#endif
+
+/*-------------------------------------------------------------------------*/
+
 #if POSCFG_INT_EXIT_QUICK == 1
 void POSCALL c_pos_intExitQuick(void)
 {
@@ -865,7 +2086,7 @@ void POSCALL c_pos_intExitQuick(void)
   POS_SCHED_LOCK;
 #endif
 
-  if (--posInInterrupt_g == 0)
+  if (--POS_INTNESTING == 0)
   {
 #if POSCFG_FEATURE_INHIBITSCHED != 0
     if (posInhibitSched_g == 0)
@@ -896,6 +2117,10 @@ void POSCALL c_pos_timerInterrupt(void)
 #if POSCFG_FEATURE_TIMER != 0
   register TIMER_t   *tmr;
 #endif
+#if POSCFG_FEATURE_TIMERCALLBACK != 0
+  TIMER_t  *fired = NULL;
+  TIMER_t  *lastfired = NULL;
+#endif
 #if POSCFG_ISR_INTERRUPTABLE != 0
   POS_LOCKFLAGS;
 #endif
@@ -907,6 +2132,21 @@ void POSCALL c_pos_timerInterrupt(void)
   POS_SCHED_LOCK;
 #endif
 
+#if SYS_SMP != 0
+  pos_smpPull();
+  if (POS_CPUID != 0)
+  {
+    /* the system time is maintained by core 0 */
+    posMustSchedule_g = 1;
+    POS_SCHED_UNLOCK;
+    return;
+  }
+#endif
+
+#if POS_TIMESEQ != 0
+  ++pos_timeSeq_g;
+  POS_MEMBARRIER();
+#endif
 #if POSCFG_FEATURE_JIFFIES != 0
 #if POSCFG_FEATURE_LARGEJIFFIES == 0
   ++jiffies;
@@ -914,6 +2154,17 @@ void POSCALL c_pos_timerInterrupt(void)
   ++pos_jiffies_g;
 #endif
 #endif
+#if POSCFG_FEATURE_HRTIME != 0
+  ++pos_hrTicks_g;
+  pos_tickCycles_g = POS_CYCLES();
+#endif
+#if POS_TIMESEQ != 0
+  POS_MEMBARRIER();
+  ++pos_timeSeq_g;
+#endif
+#if POSCFG_CTXSW_ADAPTIVE != 0
+  pos_ctxAdapt();
+#endif
 
 #if POSCFG_FEATURE_TIMER != 0
   tmr = posActiveTimers_g;
@@ -922,7 +2173,43 @@ void POSCALL c_pos_timerInterrupt(void)
     --(tmr->counter);
     if (tmr->counter == 0)
     {
-      posSemaSignal(tmr->sema);
+#if POSCFG_FEATURE_TIMERCALLBACK != 0
+      if (tmr->func == NULL)
+      {
+        pos_semaSignal(EV_PTR(tmr->sema));
+      }
+      else
+      if (tmr->context == POSTIMER_TICKCTX)
+      {
+        /* called below, when the kernel is unlocked again */
+        tmr->cbnext = TMR_NIL;
+        if (fired == NULL)
+          fired = tmr;
+        else
+          lastfired->cbnext = TMR_LINK(tmr);
+        lastfired = tmr;
+      }
+#if POS_TIMERTASK != 0
+      else
+      if (tmr->queued == 0)
+      {
+        tmr->queued = 1;
+        tmr->cbnext = TMR_NIL;
+        if (posTimerQueueHead_g == NULL)
+        {
+          posTimerQueueHead_g = tmr;
+          pos_semaSignal((EVENT_t) posTimerTaskSema_g);
+        }
+        else
+        {
+          posTimerQueueTail_g->cbnext = TMR_LINK(tmr);
+        }
+        posTimerQueueTail_g = tmr;
+      }
+#endif
+#else
+      pos_semaSignal(EV_PTR(tmr->sema));
+#endif
 #if POSCFG_FEATURE_TIMERFIRED != 0
       tmr->fired = 1;
 #endif
@@ -935,7 +2222,7 @@ void POSCALL c_pos_timerInterrupt(void)
         pos_removeFromTimerList(tmr);
       }
     }
-    tmr = tmr->next;
+    tmr = TMR_PTR(tmr->next);
   }
 #endif
 
@@ -948,24 +2235,24 @@ void POSCALL c_pos_timerInterrupt(void)
       pos_enableTask(task);
 #if SYS_TASKDOUBLELINK != 0
       pos_removeFromSleepList(task);
-      task->prev = task;
+      task->prev = TASK_LINK(task);
     }
-    task = task->next;
+    task = TASK_PTR(task->next);
 #else
-      task = task->next;
+      task = TASK_PTR(task->next);
       if (last == NULL)
       {
         posSleepingTasks_g = task;
       }
       else
       {
-        last->next = task;
+        last->next = TASK_LINK(task);
       }
     }
     else
     {
       last = task;
-      task = task->next;
+      task = TASK_PTR(task->next);
     }
 #endif
   }
@@ -973,6 +2260,15 @@ void POSCALL c_pos_timerInterrupt(void)
 #if POSCFG_ISR_INTERRUPTABLE != 0
   POS_SCHED_UNLOCK;
 #endif
+
+#if POSCFG_FEATURE_TIMERCALLBACK != 0
+  while (fired != NULL)
+  {
+    tmr   = fired;
+    fired = TMR_PTR(tmr->cbnext);
+    (tmr->func)((POSTIMER_t) tmr, tmr->arg);
+  }
+#endif
 }
 
 
@@ -999,7 +2295,7 @@ void POSCALL posTaskYield(void)
   POS_LOCKFLAGS;
 
   POS_SCHED_LOCK;
-  if (posInInterrupt_g == 0)
+  if (POS_INTNESTING == 0)
   {
 #ifdef POS_DEBUGHELP
     posCurrentTask_g->deb.state = task_suspended;
@@ -1009,8 +2305,11 @@ void POSCALL posTaskYield(void)
     if (posInhibitSched_g == 0)
     {
 #endif
-      p = posCurrentTask_g->idx_y;
+      p = POS_CURRENTTASK->idx_y;
       if ((p >= (SYS_TASKTABSIZE_Y - 1)) ||
+#if SYS_SMP != 0
+          ((POS_CURRENTTASK->affinity & pos_shift1l(POS_CPUID)) == 0) ||
+#endif
           (posMustSchedule_g != 0))
       {
         pos_schedule();
@@ -1019,21 +2318,21 @@ void POSCALL posTaskYield(void)
       }
 
 #if POSCFG_CTXSW_COMBINE > 1
+      pos_ctxScheduled();
       posCtxCombineCtr_g = 0;
 #endif
 
-      ym = POS_FINDBIT(posReadyTasks_g.ymask);
+      ym = POS_FINDROW(&posReadyTasks_g);
       if (ym == p)
       {
         if ((UVAR_t)(posReadyTasks_g.xtable[ym] &
-            ~posCurrentTask_g->bit_x) == 0)
+            ~POS_CURRENTTASK->bit_x) == 0)
         {
-          ym = POS_FINDBIT(posReadyTasks_g.ymask & pos_zmask(ym));
+          ym = POS_FINDROWBELOW(&posReadyTasks_g, ym);
         }
       }
 
-      xt = POS_FINDBIT_EX(posReadyTasks_g.xtable[ym],
-                          POS_NEXTROUNDROBIN(ym));
+      xt = POS_FINDREADY(ym);
 
 #if SYS_TASKTABSIZE_X > 1
       posNextRoundRobin_g[ym] = (xt + 1) & (SYS_TASKTABSIZE_X - 1);
@@ -1041,8 +2340,12 @@ void POSCALL posTaskYield(void)
 
       posNextTask_g = posTaskTable_g[(ym * SYS_TASKTABSIZE_X) + xt];
 
-      if (posCurrentTask_g != posNextTask_g)
+      if (POS_CURRENTTASK != posNextTask_g)
       {
+        pos_countSwitch();
+        pos_statSwitch();
+        pos_checkStack(POS_CURRENTTASK);
+        pos_lockProfSwitch();
 #ifdef POS_DEBUGHELP
         posNextTask_g->deb.state = task_running;
         pos_taskHistory(&posNextTask_g->deb);
@@ -1090,6 +2393,7 @@ POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
   p_pos_lock();
 #endif
   POS_SCHED_LOCK;
+  pos_waitSchedLockFree();
   task = posFreeTasks_g;
 #if SYS_POSTALLOCATE != 0
   if (task == NULL)
@@ -1106,7 +2410,8 @@ POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
     }
     task = MEMALIGN(POSTASK_t, task);
     POS_SCHED_LOCK;
-    task->next = posFreeTasks_g;
+    pos_waitSchedLockFree();
+    task->next = TASK_LINK(posFreeTasks_g);
     posFreeTasks_g = task;
   }
 #endif /* SYS_POSTALLOCATE */
@@ -1128,7 +2433,7 @@ POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
   if (b >= SYS_TASKTABSIZE_X)
     goto retNull;
 #endif
-  posFreeTasks_g = task->next;
+  posFreeTasks_g = TASK_PTR(task->next);
 
   m = (unsigned char*) task;
   i = sizeof(struct POSTASK);
@@ -1138,12 +2443,13 @@ POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
   task->magic = POSMAGIC_TASK;
 #endif
 #if SYS_TASKEVENTLINK != 0
-  task->event = NULL;
+  task->event = EV_NIL;
 #endif
-#if SYS_TASKTABSIZE_Y > 1
-  task->idx_y = p;
-  task->bit_y = pos_shift1l(p);
+#if SYS_SMP != 0
+  task->core     = POS_CPUID;
+  task->affinity = POS_SMP_ALLCORES;
 #endif
+  pos_setTaskRow(task, p);
   task->bit_x = pos_shift1l(b);
   posTaskTable_g[(p * SYS_TASKTABSIZE_X) + b] = task;
 
@@ -1152,14 +2458,14 @@ POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
 #elif POSCFG_TASKSTACKTYPE == 1
   if (p_pos_initTask(task, stacksize, funcptr, funcarg) != 0)
   {
-    task->next = posFreeTasks_g;
+    task->next = TASK_LINK(posFreeTasks_g);
     posFreeTasks_g = task;
     goto retNull;
   }
 #else
   if (p_pos_initTask(task, funcptr, funcarg) != 0)
   {
-    task->next = posFreeTasks_g;
+    task->next = TASK_LINK(posFreeTasks_g);
     posFreeTasks_g = task;
     goto retNull;
   }
@@ -1191,6 +2497,7 @@ POSTASK_t POSCALL posTaskCreate(POSTASKFUNC_t funcptr, void *funcarg,
   return task;
 
 retNull:
+  pos_statInc(posSysStats_g.allocfail);
   POS_SCHED_UNLOCK;
 #if POSCFG_PORTMUTEX != 0
   p_pos_unlock();
@@ -1215,29 +2522,35 @@ void POSCALL posTaskExit(void)
     (task->exithook)(task, texh_exitcalled);
 #endif
 #if POSCFG_FEATURE_MSGBOXES != 0
-  if (task->msgsem != NULL)
+  if (task->msgsem != EV_NIL)
   {
-    posSemaDestroy(task->msgsem);
+    posSemaDestroy((POSSEMA_t) EV_PTR(task->msgsem));
   }
   POS_SCHED_LOCK;
+  pos_waitSchedLockFree();
   task->state = POSTASKSTATE_ZOMBIE;
-  if (task->firstmsg != NULL)
+  if (task->firstmsg != MSG_NIL)
   {
-    ((MSGBUF_t*)(task->lastmsg))->next = posFreeMessagebuf_g;
-    posFreeMessagebuf_g = (MSGBUF_t*)(task->firstmsg);
+    MSG_PTR(task->lastmsg)->next = MSG_LINK(posFreeMessagebuf_g);
+    posFreeMessagebuf_g = MSG_PTR(task->firstmsg);
     if (msgAllocWaitReq_g != 0)
     {
       msgAllocWaitReq_g = 0;
       POS_SCHED_UNLOCK;
       posSemaSignal(msgAllocWaitSem_g);
       POS_SCHED_LOCK;
+      pos_waitSchedLockFree();
     }
   }
 #else
   POS_SCHED_LOCK;
+  pos_waitSchedLockFree();
 #endif
   pos_disableTask(task);
   pos_delTableBit(&posAllocatedTasks_g, task);
+#if POSCFG_FEATURE_STACKCHECK != 0
+  task->stkguard = NULL;
+#endif
 #if (POSCFG_TASKSTACKTYPE == 1) || (POSCFG_TASKSTACKTYPE == 2)
   p_pos_freeStack(task);
 #endif
@@ -1258,7 +2571,7 @@ void POSCALL posTaskExit(void)
 #if SYS_TASKSTATE != 0
   task->state = POSTASKSTATE_UNUSED;
 #endif
-  task->next = posFreeTasks_g;
+  task->next = TASK_LINK(posFreeTasks_g);
   posFreeTasks_g = task;
 #if POSCFG_PORTMUTEX != 0
   p_pos_unlock();
@@ -1331,8 +2644,13 @@ VAR_t POSCALL posTaskSetPriority(POSTASK_t taskhandle, VAR_t priority)
     return -E_FAIL;
   }
 #endif
-  ev = (EVENT_t) taskhandle->event;
+  ev = EV_PTR(taskhandle->event);
+#if SYS_SMP != 0
+  taskruns = pos_isTableBitSet(&posCoreReadyTasks_g[taskhandle->core],
+                               taskhandle);
+#else
   taskruns = pos_isTableBitSet(&posReadyTasks_g, taskhandle);
+#endif
   if (taskruns)
   {
     pos_disableTask(taskhandle);
@@ -1343,17 +2661,29 @@ VAR_t POSCALL posTaskSetPriority(POSTASK_t taskhandle, VAR_t priority)
       pos_eventRemoveTask(ev, taskhandle);
   }
   pos_delTableBit(&posAllocatedTasks_g, taskhandle);
-#if SYS_TASKTABSIZE_Y > 1
-  taskhandle->idx_y = p;
-  taskhandle->bit_y = pos_shift1l(p);
+#if POSCFG_FEATURE_EDF != 0
+  if ((taskhandle->edfperiod != 0) && (p != POS_EDF_ROW))
+  {
+    /* the task leaves the EDF priority level */
+    pos_edfRemove(taskhandle);
+    taskhandle->edfperiod = 0;
+  }
 #endif
+  pos_setTaskRow(taskhandle, p);
   taskhandle->bit_x = pos_shift1l(b);
   posTaskTable_g[(p * SYS_TASKTABSIZE_X) + b] = taskhandle;
   pos_setTableBit(&posAllocatedTasks_g, taskhandle);
 
   if (taskruns)
   {
+#if SYS_SMP != 0
+    /* the task may have been preempted, so it keeps its core */
+    pos_setTableBit(&posCoreReadyTasks_g[taskhandle->core], taskhandle);
+    pos_edfReady(taskhandle);
+    pos_smpKick(taskhandle->core);
+#else
     pos_enableTask(taskhandle);
+#endif
   }
   else
   {
@@ -1415,23 +2745,286 @@ void POSCALL posTaskSleep(UINT_t ticks)
     pos_addToSleepList(task);
   }
 #ifdef POS_DEBUGHELP
-  posCurrentTask_g->deb.state = task_sleeping;
+  posCurrentTask_g->deb.state = task_sleeping;
+#endif
+  pos_schedule();
+  POS_SCHED_UNLOCK;
+}
+
+#endif  /* POSCFG_FEATURE_SLEEP */
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_SLEEPUNTIL != 0
+
+/* Converts an absolute time into a relative timeout in ticks.
+ * The kernel must be locked, so no tick can pass before the task
+ * is added to the sleep list.
+ */
+static UINT_t POSCALL pos_ticksUntil(JIF_t deadline)
+{
+  register SJIF_t  ticks = (SJIF_t) (deadline - POS_JIFFIES);
+
+  if (ticks <= 0)
+    return 0;
+  if ((JIF_t) ticks >= (JIF_t) INFINITE)
+    return INFINITE - 1;
+  return (UINT_t) ticks;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL posTaskSleepUntil(JIF_t wakeup)
+{
+  register POSTASK_t task;
+  register SJIF_t    ticks;
+  POS_LOCKFLAGS;
+
+#if POSCFG_ARGCHECK > 1
+  if (posInInterrupt_g != 0)
+    return;
+#endif
+
+  POS_SCHED_LOCK;
+  /* The time is read with the kernel locked, so the
+     task wakes up exactly at the requested tick. */
+  ticks = (SJIF_t) (wakeup - POS_JIFFIES);
+  if (ticks > 0)
+  {
+    task = posCurrentTask_g;
+    tasktimerticks(task) = ((JIF_t) ticks < (JIF_t) INFINITE) ?
+                           (UINT_t) ticks : (INFINITE - 1);
+    pos_disableTask(task);
+    pos_addToSleepList(task);
+#ifdef POS_DEBUGHELP
+    task->deb.state = task_sleeping;
+#endif
+  }
+  pos_schedule();
+  POS_SCHED_UNLOCK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+UINT_t POSCALL posTaskSleepPeriodic(JIF_t *wakeup, UINT_t period)
+{
+  register JIF_t   late;
+  register UINT_t  skipped = 0;
+
+  P_ASSERT("posTaskSleepPeriodic: wakeup valid", wakeup != NULL);
+  P_ASSERT("posTaskSleepPeriodic: period valid", period != 0);
+  if ((wakeup == NULL) || (period == 0))
+    return 0;
+
+  *wakeup += (JIF_t) period;
+  late = (JIF_t) (jiffies - *wakeup);
+  if ((SJIF_t) late > 0)
+  {
+    /* skip the release times that have already passed */
+    skipped  = (UINT_t) ((late + period - 1) / period);
+    *wakeup += (JIF_t) (skipped * period);
+  }
+  posTaskSleepUntil(*wakeup);
+  return skipped;
+}
+
+#endif  /* POSCFG_FEATURE_SLEEPUNTIL */
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_EDF != 0
+
+VAR_t POSCALL posTaskSetDeadline(POSTASK_t taskhandle, UINT_t period,
+                                 UINT_t deadline)
+{
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posTaskSetDeadline: task handle valid", taskhandle != NULL);
+  POS_ARGCHECK_RET(taskhandle, taskhandle->magic, POSMAGIC_TASK, -E_ARG); 
+  if (deadline == 0)
+    deadline = period;
+  if (deadline > period)
+    return -E_ARG;
+
+  POS_SCHED_LOCK;
+#if SYS_TASKTABSIZE_Y > 1
+  if (taskhandle->idx_y != POS_EDF_ROW)
+  {
+    POS_SCHED_UNLOCK;
+    return -E_ARG;
+  }
+#endif
+  pos_edfRemove(taskhandle);
+  taskhandle->edfperiod  = period;
+  taskhandle->edfreldl   = deadline;
+  taskhandle->edfmisses  = 0;
+  if (period != 0)
+  {
+    taskhandle->edfrelease  = POS_EDF_NOW;
+    taskhandle->edfdeadline = taskhandle->edfrelease + deadline;
+    if (POS_EDF_ISREADY(taskhandle))
+      pos_edfInsert(taskhandle);
+  }
+  posMustSchedule_g = 1;
+  pos_schedule();
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posTaskWaitPeriod(void)
+{
+  register POSTASK_t task = posCurrentTask_g;
+  register JIF_t  now;
+  register SJIF_t delay;
+  VAR_t  missed = 0;
+  POS_LOCKFLAGS;
+
+  if (task->edfperiod == 0)
+    return -E_FAIL;
+
+  POS_SCHED_LOCK;
+  now = POS_EDF_NOW;
+  if ((SJIF_t)(now - task->edfdeadline) > 0)
+  {
+    ++(task->edfmisses);
+    missed = 1;
+  }
+
+  /* Compute the next release. If the task is late by more than
+     its relative deadline, it is resynchronized to the current time
+     instead of trying to catch up with the lost periods. */
+  task->edfrelease += task->edfperiod;
+  if ((SJIF_t)(now - task->edfrelease) > (SJIF_t) task->edfreldl)
+    task->edfrelease = now;
+  task->edfdeadline = task->edfrelease + task->edfreldl;
+
+  /* the task is still ready, move it to its new place in the queue */
+  pos_edfRemove(task);
+  pos_edfInsert(task);
+
+  delay = (SJIF_t)(task->edfrelease - now);
+  if (delay > 0)
+  {
+    tasktimerticks(task) = (UINT_t) delay;
+    pos_disableTask(task);
+    pos_addToSleepList(task);
+#ifdef POS_DEBUGHELP
+    task->deb.state = task_sleeping;
+#endif
+  }
+  pos_schedule();
+  POS_SCHED_UNLOCK;
+  return missed;
+}
+
+/*-------------------------------------------------------------------------*/
+
+UINT_t POSCALL posTaskGetDeadlineMisses(POSTASK_t taskhandle)
+{
+  register UINT_t misses;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posTaskGetDeadlineMisses: task handle valid", taskhandle != NULL);
+  POS_ARGCHECK_RET(taskhandle, taskhandle->magic, POSMAGIC_TASK, 0); 
+  POS_SCHED_LOCK;
+  misses = taskhandle->edfmisses;
+  POS_SCHED_UNLOCK;
+  return misses;
+}
+
+#endif  /* POSCFG_FEATURE_EDF */
+
+/*-------------------------------------------------------------------------*/
+
+#if SYS_SMP != 0
+
+VAR_t POSCALL posTaskSetAffinity(POSTASK_t taskhandle, UVAR_t coremask)
+{
+  register UVAR_t c;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posTaskSetAffinity: task handle valid", taskhandle != NULL);
+  POS_ARGCHECK_RET(taskhandle, taskhandle->magic, POSMAGIC_TASK, -E_ARG);
+  coremask &= POS_SMP_ALLCORES;
+  if (coremask == 0)
+    return -E_ARG;
+
+  POS_SCHED_LOCK;
+  taskhandle->affinity = coremask;
+  c = taskhandle->core;
+  if ((coremask & pos_shift1l(c)) == 0)
+  {
+    if (taskhandle == POS_CURRENTTASK)
+    {
+      /* pos_schedule moves the task to an allowed core */
+#ifdef POS_DEBUGHELP
+      taskhandle->deb.state = task_suspended;
 #endif
-  pos_schedule();
+      pos_schedule();
+    }
+    else
+    if (taskhandle == posCoreCurrentTask_g[c])
+    {
+      /* the scheduler of the other core moves the task */
+      pos_smpKick(c);
+    }
+    else
+    if (pos_isTableBitSet(&posCoreReadyTasks_g[c], taskhandle))
+    {
+      pos_disableTask(taskhandle);
+      pos_enableTask(taskhandle);
+    }
+  }
   POS_SCHED_UNLOCK;
+  return E_OK;
 }
 
-#endif  /* POSCFG_FEATURE_SLEEP */
+#endif  /* SYS_SMP */
 
 /*-------------------------------------------------------------------------*/
 
 #if POSCFG_FEATURE_INHIBITSCHED != 0
 
+#if POSCFG_FEATURE_LOCKPROF != 0
+
+#undef posTaskSchedLock
+
 void POSCALL posTaskSchedLock(void)
+{
+  static POSLOCKSITE_t site = POS_LOCKSITE_INIT(POSLOCK_INHIBIT);
+
+  c_pos_taskSchedLock(&site);
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL c_pos_taskSchedLock(POSLOCKSITE_t *site)
+#else
+void POSCALL posTaskSchedLock(void)
+#endif
 {
   POS_LOCKFLAGS;
 
   POS_SCHED_LOCK;
+#if SYS_SMP != 0
+  /* only one core at a time may hold the scheduler lock */
+  while ((posSchedLockCore_g != 0) &&
+         (posSchedLockCore_g != (UVAR_t)(POS_CPUID + 1)))
+  {
+    POS_SCHED_UNLOCK;
+    POS_SCHED_LOCK;
+  }
+  posSchedLockCore_g = (UVAR_t)(POS_CPUID + 1);
+#endif
+#if POSCFG_FEATURE_LOCKPROF != 0
+  if (posInhibitSched_g == 0)
+  {
+    posLockProf_g[POS_LOCKPROF_INHIBIT].site  = site;
+    posLockProf_g[POS_LOCKPROF_INHIBIT].start = POS_CYCLES();
+  }
+#endif
   ++posInhibitSched_g;
   POS_SCHED_UNLOCK;
 }
@@ -1444,6 +3037,17 @@ void POSCALL posTaskSchedUnlock(void)
 
   POS_SCHED_LOCK;
   --posInhibitSched_g;
+#if SYS_SMP != 0
+  if (posInhibitSched_g == 0)
+    posSchedLockCore_g = 0;
+#endif
+#if POSCFG_FEATURE_LOCKPROF != 0
+  if (posInhibitSched_g == 0)
+  {
+    pos_lockProfRecord(posLockProf_g[POS_LOCKPROF_INHIBIT].site,
+                       posLockProf_g[POS_LOCKPROF_INHIBIT].start);
+  }
+#endif
   if ((posInhibitSched_g == 0) &&
       (posMustSchedule_g != 0))
   {
@@ -1529,14 +3133,20 @@ POSSEMA_t POSCALL posSemaCreate(INT_t initcount)
 
     ev->e.d.counter = initcount;
 #if POSCFG_FEATURE_MUTEXES != 0
-    ev->e.task = NULL;
+    ev->e.task = TASK_NIL;
 #endif
     for (i=0; i<SYS_TASKTABSIZE_Y; ++i)
     {
       ev->e.pend.xtable[i] = 0;
     }
-#if SYS_TASKTABSIZE_Y > 1
-    ev->e.pend.ymask = 0;
+    pos_clearTableRows(&ev->e.pend);
+#if POSCFG_FEATURE_STATISTICS != 0
+    ev->e.stats.signals   = 0;
+    ev->e.stats.contended = 0;
+    ev->e.stats.timeouts  = 0;
+#endif
+#if POSCFG_FEATURE_MUTEXPROF != 0
+    pos_mutexProfClear(&ev->e.mprof);
 #endif
 #ifdef POS_DEBUGHELP
     ev->e.deb.handle = ev;
@@ -1551,6 +3161,10 @@ POSSEMA_t POSCALL posSemaCreate(INT_t initcount)
 #endif
 #if SYS_POSTALLOCATE == 0
   }
+  else
+  {
+    pos_statInc(posSysStats_g.allocfail);
+  }
 #endif
   POS_SCHED_UNLOCK;
   return (POSSEMA_t) ev;
@@ -1571,11 +3185,7 @@ void POSCALL posSemaDestroy(POSSEMA_t sema)
            ev->e.magic == POSMAGIC_EVENTU);
 #endif
   POS_ARGCHECK(ev, ev->e.magic, POSMAGIC_EVENTU); 
-#if SYS_TASKTABSIZE_Y > 1
-  if (ev->e.pend.ymask == 0)
-#else
-  if (ev->e.pend.xtable[0] == 0)
-#endif
+  if (pos_isTableEmpty(&ev->e.pend))
   {
     POS_SCHED_LOCK;
 #ifdef POS_DEBUGHELP
@@ -1628,6 +3238,7 @@ VAR_t POSCALL posSemaGet(POSSEMA_t sema)
   }
   else
   {
+    pos_statInc(ev->e.stats.contended);
     pos_disableTask(task);
     pos_eventAddTask(ev, task);
 #ifdef POS_DEBUGHELP
@@ -1644,7 +3255,25 @@ VAR_t POSCALL posSemaGet(POSSEMA_t sema)
 
 #if POSCFG_FEATURE_SEMAWAIT != 0
 
+#if POSCFG_FEATURE_SLEEPUNTIL != 0
+VAR_t POSCALL posSemaWaitUntil(POSSEMA_t sema, JIF_t deadline)
+{
+  return pos_semaWait(sema, 0, &deadline);
+}
+
 VAR_t POSCALL posSemaWait(POSSEMA_t sema, UINT_t timeoutticks)
+{
+  return pos_semaWait(sema, timeoutticks, NULL);
+}
+
+/* Waits for a semaphore. If deadline is not NULL, the timeout is
+ * computed from the deadline with the kernel locked.
+ */
+static VAR_t POSCALL pos_semaWait(POSSEMA_t sema, UINT_t timeoutticks,
+                                  const JIF_t *deadline)
+#else
+VAR_t POSCALL posSemaWait(POSSEMA_t sema, UINT_t timeoutticks)
+#endif
 {
   register EVENT_t   ev = (EVENT_t) sema;
   register POSTASK_t task = posCurrentTask_g;
@@ -1662,6 +3291,10 @@ VAR_t POSCALL posSemaWait(POSSEMA_t sema, UINT_t timeoutticks)
     return -E_FORB;
 #endif
   POS_SCHED_LOCK;
+#if POSCFG_FEATURE_SLEEPUNTIL != 0
+  if (deadline != NULL)
+    timeoutticks = pos_ticksUntil(*deadline);
+#endif
 
   if (ev->e.d.counter > 0)
   {
@@ -1690,17 +3323,20 @@ VAR_t POSCALL posSemaWait(POSSEMA_t sema, UINT_t timeoutticks)
 #endif
     }
 
+    pos_statInc(ev->e.stats.contended);
     pos_disableTask(task);
     pos_eventAddTask(ev, task);
     pos_schedule();
 
     if (timeoutticks != INFINITE)
     {
-      if (task->prev == task)
+      if (task->prev == TASK_LINK(task))
       {
         if (pos_isTableBitSet(&ev->e.pend, task))
         {
           pos_eventRemoveTask(ev, task);
+          pos_statInc(ev->e.stats.timeouts);
+          pos_statInc(task->stats.timeouts);
           POS_SCHED_UNLOCK;
           return 1;
         }
@@ -1732,7 +3368,16 @@ VAR_t POSCALL posSemaSignal(POSSEMA_t sema)
 #endif
   POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
   POS_SCHED_LOCK;
+  pos_semaSignal(ev);
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
 
+/* Signals a semaphore. The kernel must be locked. */
+static void POSCALL pos_semaSignal(EVENT_t ev)
+{
   if (ev->e.d.counter == 0)
   {
     if (pos_sched_event(ev) == 0)
@@ -1745,6 +3390,11 @@ VAR_t POSCALL posSemaSignal(POSSEMA_t sema)
   }
   else
   {
+#if POSCFG_CTXSW_ADAPTIVE != 0
+    ++posCtxTickEvents_g;
+    ++posCtxStats_g.events;
+#endif
+    pos_statInc(ev->e.stats.signals);
     if (ev->e.d.counter != (((UINT_t)~0) >> 1))
     {
       ++(ev->e.d.counter);
@@ -1753,8 +3403,6 @@ VAR_t POSCALL posSemaSignal(POSSEMA_t sema)
 #endif
     }
   }
-  POS_SCHED_UNLOCK;
-  return E_OK;
 }
 
 #endif  /* SYS_FEATURE_EVENTS */
@@ -1767,6 +3415,57 @@ VAR_t POSCALL posSemaSignal(POSSEMA_t sema)
 
 #if POSCFG_FEATURE_MUTEXES != 0
 
+#if POSCFG_FEATURE_MUTEXPROF != 0
+
+/* Clears the contention record of a mutex. */
+static void POSCALL pos_mutexProfClear(POSMUTEXPROF_t *prof)
+{
+  prof->locks     = 0;
+  prof->contended = 0;
+  prof->waittotal = 0;
+  prof->waitmax   = 0;
+  prof->holdtotal = 0;
+  prof->holdmax   = 0;
+  prof->holder    = NULL;
+  prof->maxholder = NULL;
+}
+
+/* Called with the kernel locked when a task has acquired the mutex. */
+static void POSCALL pos_mutexProfLocked(EVENT_t ev)
+{
+  ++(ev->e.mprof.locks);
+  ev->e.mlocked = POS_CYCLES();
+}
+
+/* Called with the kernel locked when a task that has blocked
+ * in posMutexLock is running again. */
+static void POSCALL pos_mutexProfWaited(EVENT_t ev, POSCYCLES_t start)
+{
+  register POSCYCLES_t wait = POS_CYCLES() - start;
+
+  ++(ev->e.mprof.contended);
+  ev->e.mprof.waittotal += wait;
+  if (wait > ev->e.mprof.waitmax)
+    ev->e.mprof.waitmax = wait;
+}
+
+/* Called with the kernel locked before the owner releases the mutex. */
+static void POSCALL pos_mutexProfUnlocked(EVENT_t ev)
+{
+  register POSCYCLES_t hold = POS_CYCLES() - ev->e.mlocked;
+
+  ev->e.mprof.holdtotal += hold;
+  if (hold > ev->e.mprof.holdmax)
+  {
+    ev->e.mprof.holdmax   = hold;
+    ev->e.mprof.maxholder = TASK_PTR(ev->e.task);
+  }
+}
+
+#endif /* POSCFG_FEATURE_MUTEXPROF */
+
+/*-------------------------------------------------------------------------*/
+
 POSMUTEX_t POSCALL posMutexCreate(void)
 {
 #ifdef POS_DEBUGHELP
@@ -1808,7 +3507,7 @@ VAR_t POSCALL posMutexTryLock(POSMUTEX_t mutex)
   POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
   POS_SCHED_LOCK;
 
-  if (ev->e.task == task)
+  if (ev->e.task == TASK_LINK(task))
   {
     --(ev->e.d.counter);
 #ifdef POS_DEBUGHELP
@@ -1823,7 +3522,8 @@ VAR_t POSCALL posMutexTryLock(POSMUTEX_t mutex)
       return 1;  /* no lock */
     }
     ev->e.d.counter = 0;
-    ev->e.task = task;
+    ev->e.task = TASK_LINK(task);
+    pos_mutexProfLocked(ev);
 #ifdef POS_DEBUGHELP
     ev->e.deb.counter = 0;
 #endif
@@ -1840,6 +3540,9 @@ VAR_t POSCALL posMutexLock(POSMUTEX_t mutex)
 {
   register EVENT_t  ev = (EVENT_t) mutex;
   register POSTASK_t task = posCurrentTask_g;
+#if POSCFG_FEATURE_MUTEXPROF != 0
+  POSCYCLES_t waitstart;
+#endif
   POS_LOCKFLAGS;
 
   P_ASSERT("posMutexLock: mutex valid", ev != NULL);
@@ -1851,7 +3554,7 @@ VAR_t POSCALL posMutexLock(POSMUTEX_t mutex)
   POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
   POS_SCHED_LOCK;
 
-  if (ev->e.task == task)
+  if (ev->e.task == TASK_LINK(task))
   {
     --(ev->e.d.counter);
 #ifdef POS_DEBUGHELP
@@ -1869,14 +3572,20 @@ VAR_t POSCALL posMutexLock(POSMUTEX_t mutex)
     }
     else
     {
+      pos_statInc(ev->e.stats.contended);
+#if POSCFG_FEATURE_MUTEXPROF != 0
+      waitstart = POS_CYCLES();
+#endif
       pos_disableTask(task);
       pos_eventAddTask(ev, task);
 #ifdef POS_DEBUGHELP
       task->deb.state = task_waitingForMutex;
 #endif
       pos_schedule();
+      pos_mutexProfWaited(ev, waitstart);
     }
-    ev->e.task = task;
+    ev->e.task = TASK_LINK(task);
+    pos_mutexProfLocked(ev);
   }
   POS_SCHED_UNLOCK;
   return E_OK;
@@ -1899,7 +3608,8 @@ VAR_t POSCALL posMutexUnlock(POSMUTEX_t mutex)
 
   if (ev->e.d.counter == 0)
   {
-    ev->e.task = NULL;
+    pos_mutexProfUnlocked(ev);
+    ev->e.task = TASK_NIL;
     if (pos_sched_event(ev) == 0)
     {
       ev->e.d.counter = 1;
@@ -1919,6 +3629,54 @@ VAR_t POSCALL posMutexUnlock(POSMUTEX_t mutex)
   return E_OK;
 }
 
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_MUTEXPROF != 0
+
+VAR_t POSCALL posMutexGetProf(POSMUTEX_t mutex, POSMUTEXPROF_t *prof)
+{
+  register EVENT_t  ev = (EVENT_t) mutex;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posMutexGetProf: mutex valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posMutexGetProf: mutex allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  P_ASSERT("posMutexGetProf: prof valid", prof != NULL);
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+  if (prof == NULL)
+    return -E_ARG;
+
+  POS_SCHED_LOCK;
+  *prof = ev->e.mprof;
+  prof->holder = TASK_PTR(ev->e.task);
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posMutexProfReset(POSMUTEX_t mutex)
+{
+  register EVENT_t  ev = (EVENT_t) mutex;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posMutexProfReset: mutex valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posMutexProfReset: mutex allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+
+  POS_SCHED_LOCK;
+  pos_mutexProfClear(&ev->e.mprof);
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+#endif  /* POSCFG_FEATURE_MUTEXPROF */
+
 #endif  /* POSCFG_FEATURE_MUTEXES */
 
 
@@ -1940,7 +3698,11 @@ void* POSCALL posMessageAlloc(void)
 
   if ((posInInterrupt_g != 0)
 #if POSCFG_FEATURE_INHIBITSCHED != 0
+#if SYS_SMP != 0
+      || (pos_smpReadVar(posCoreInhibitSched_g) != 0)
+#else
       || (posInhibitSched_g != 0)
+#endif
 #endif
     )
   {
@@ -1950,7 +3712,11 @@ void* POSCALL posMessageAlloc(void)
     mbuf = posFreeMessagebuf_g;
     if (mbuf != NULL)
     {
-      posFreeMessagebuf_g = (MSGBUF_t*) mbuf->next;
+      posFreeMessagebuf_g = MSG_PTR(mbuf->next);
+    }
+    else
+    {
+      pos_statInc(posSysStats_g.allocfail);
     }
 #if POSCFG_ISR_INTERRUPTABLE != 0
     POS_SCHED_UNLOCK;
@@ -1967,7 +3733,7 @@ void* POSCALL posMessageAlloc(void)
   mbuf = posFreeMessagebuf_g;
   if (mbuf != NULL)
   {
-    posFreeMessagebuf_g = (MSGBUF_t*) mbuf->next;
+    posFreeMessagebuf_g = MSG_PTR(mbuf->next);
     POS_SCHED_UNLOCK;
 #if POSCFG_MSG_MEMORY == 0
     return mbuf;
@@ -1995,6 +3761,10 @@ void* POSCALL posMessageAlloc(void)
   posSemaGet(msgAllocSyncSem_g);
   POS_SCHED_LOCK;
   mbuf = posFreeMessagebuf_g;
+  if (mbuf == NULL)
+  {
+    pos_statInc(posSysStats_g.allocfail);
+  }
   while (mbuf == NULL)
   {
     msgAllocWaitReq_g = 1;
@@ -2003,7 +3773,7 @@ void* POSCALL posMessageAlloc(void)
     POS_SCHED_LOCK;
     mbuf = posFreeMessagebuf_g;
   }
-  posFreeMessagebuf_g = (MSGBUF_t*) mbuf->next;
+  posFreeMessagebuf_g = MSG_PTR(mbuf->next);
   POS_SCHED_UNLOCK;
   posSemaSignal(msgAllocSyncSem_g);
 #if POSCFG_MSG_MEMORY == 0
@@ -2029,7 +3799,7 @@ void POSCALL posMessageFree(void *buf)
   POS_ARGCHECK(mbuf, mbuf->magic, POSMAGIC_MSGBUF); 
 #endif
   POS_SCHED_LOCK;
-  mbuf->next = (void*) posFreeMessagebuf_g;
+  mbuf->next = MSG_LINK(posFreeMessagebuf_g);
   posFreeMessagebuf_g = mbuf;
   if (msgAllocWaitReq_g != 0)
   {
@@ -2043,9 +3813,31 @@ void POSCALL posMessageFree(void *buf)
 
 /*-------------------------------------------------------------------------*/
 
+#if POSCFG_FEATURE_MSGURGENT != 0
+
+static VAR_t POSCALL pos_msgSend(void *buf, POSTASK_t taskhandle,
+                                 UVAR_t urgent);
+
+VAR_t POSCALL posMessageSend(void *buf, POSTASK_t taskhandle)
+{
+  return pos_msgSend(buf, taskhandle, 0);
+}
+
+VAR_t POSCALL posMessageSendUrgent(void *buf, POSTASK_t taskhandle)
+{
+  return pos_msgSend(buf, taskhandle, 1);
+}
+
+static VAR_t POSCALL pos_msgSend(void *buf, POSTASK_t taskhandle,
+                                 UVAR_t urgent)
+#else
 VAR_t POSCALL posMessageSend(void *buf, POSTASK_t taskhandle)
+#endif
 {
   register MSGBUF_t *mbuf;
+#if POSCFG_FEATURE_MSGURGENT != 0
+  MSGBUF_t *prev;
+#endif
   POS_LOCKFLAGS;
 
 #if POSCFG_ARGCHECK != 0
@@ -2089,21 +3881,46 @@ VAR_t POSCALL posMessageSend(void *buf, POSTASK_t taskhandle)
     return -E_FAIL;
   }
 #endif
-  mbuf->next = NULL;
-  if (taskhandle->lastmsg == NULL)
+  mbuf->next = MSG_NIL;
+#if POSCFG_FEATURE_MSGURGENT != 0
+  if (urgent != 0)
+  {
+    /* Urgent messages are queued in front of all normal messages,
+       but behind the urgent messages that are already waiting. */
+    prev = MSG_PTR(taskhandle->lasturgent);
+    if (prev == NULL)
+    {
+      mbuf->next = taskhandle->firstmsg;
+      taskhandle->firstmsg = MSG_LINK(mbuf);
+    }
+    else
+    {
+      mbuf->next = prev->next;
+      prev->next = MSG_LINK(mbuf);
+    }
+    taskhandle->lasturgent = MSG_LINK(mbuf);
+    if (mbuf->next == MSG_NIL)
+    {
+      taskhandle->lastmsg = MSG_LINK(mbuf);
+    }
+  }
+  else
+#endif
+  if (taskhandle->lastmsg == MSG_NIL)
   {
-    taskhandle->firstmsg = (void*) mbuf;
-    taskhandle->lastmsg = (void*) mbuf;
+    taskhandle->firstmsg = MSG_LINK(mbuf);
+    taskhandle->lastmsg = MSG_LINK(mbuf);
   }
   else
   {
-    ((MSGBUF_t*)(taskhandle->lastmsg))->next = mbuf;
-    taskhandle->lastmsg = (void*) mbuf;
+    MSG_PTR(taskhandle->lastmsg)->next = MSG_LINK(mbuf);
+    taskhandle->lastmsg = MSG_LINK(mbuf);
   }
+  pos_statMsgAdd(taskhandle);
   if (taskhandle->msgwait != 0)
   {
     taskhandle->msgwait = 0;
-    pos_sched_event((EVENT_t)taskhandle->msgsem);
+    pos_sched_event(EV_PTR(taskhandle->msgsem));
 
 #if (POSCFG_SOFT_MTASK !=0)&&(SYS_TASKTABSIZE_Y >1)&&(POSCFG_ROUNDROBIN !=0)
     if ((posMustSchedule_g != 0) &&
@@ -2144,7 +3961,7 @@ void* POSCALL posMessageGet(void)
     return NULL;
 #endif
 
-  if (task->msgsem == NULL)
+  if (task->msgsem == EV_NIL)
   {
     sem = posSemaCreate(0);
     P_ASSERT("posMessageGet: event allocation", sem != NULL);
@@ -2154,30 +3971,37 @@ void* POSCALL posMessageGet(void)
     }
     POS_SETEVENTNAME(sem, "taskMessageSem");
     POS_SCHED_LOCK;
-    task->msgsem = sem;
+    task->msgsem = EV_LINK((EVENT_t) sem);
   }
   else
   {
     POS_SCHED_LOCK;
   }
 
-  mbuf = (MSGBUF_t*) (task->firstmsg);
+  mbuf = MSG_PTR(task->firstmsg);
   if (mbuf == NULL)
   {
     task->msgwait = 1;
     pos_disableTask(task);
-    pos_eventAddTask((EVENT_t)task->msgsem, task);
+    pos_eventAddTask(EV_PTR(task->msgsem), task);
 #ifdef POS_DEBUGHELP
     task->deb.state = task_waitingForMessage;
 #endif
     pos_schedule();
-    mbuf = (MSGBUF_t*) (task->firstmsg);
+    mbuf = MSG_PTR(task->firstmsg);
+  }
+  task->firstmsg = mbuf->next;
+  pos_statDec(task->stats.msgcount);
+  if (task->firstmsg == MSG_NIL)
+  {
+    task->lastmsg = MSG_NIL;
   }
-  task->firstmsg = (void*) (mbuf->next);
-  if (task->firstmsg == NULL)
+#if POSCFG_FEATURE_MSGURGENT != 0
+  if (task->lasturgent == MSG_LINK(mbuf))
   {
-    task->lastmsg = NULL;
+    task->lasturgent = MSG_NIL;
   }
+#endif
   POS_SCHED_UNLOCK;
 
 #if POSCFG_MSG_MEMORY == 0
@@ -2192,25 +4016,155 @@ void* POSCALL posMessageGet(void)
 
 /*-------------------------------------------------------------------------*/
 
-#if POSCFG_FEATURE_MSGWAIT != 0
+#if POSCFG_FEATURE_MSGWAIT != 0
+
+#if POSCFG_FEATURE_SLEEPUNTIL != 0
+void* POSCALL posMessageWaitUntil(JIF_t deadline)
+{
+  return pos_messageWait(0, &deadline);
+}
+
+void* POSCALL posMessageWait(UINT_t timeoutticks)
+{
+  return pos_messageWait(timeoutticks, NULL);
+}
+
+/* Waits for a message. If deadline is not NULL, the timeout is
+ * computed from the deadline with the kernel locked.
+ */
+static void* POSCALL pos_messageWait(UINT_t timeoutticks,
+                                     const JIF_t *deadline)
+#else
+void* POSCALL posMessageWait(UINT_t timeoutticks)
+#endif
+{
+  register POSTASK_t task = posCurrentTask_g;
+  register MSGBUF_t *mbuf;
+  register POSSEMA_t sem;
+#if POSCFG_MSG_MEMORY == 0
+  void *buf;
+#endif
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posMessageWait: not in an interrupt", posInInterrupt_g == 0);
+#if POSCFG_ARGCHECK > 1
+  if (posInInterrupt_g != 0)
+    return NULL;
+#endif
+
+  if (task->msgsem == EV_NIL)
+  {
+    sem = posSemaCreate(0);
+    if (sem == NULL)
+    {
+      return NULL;
+    }
+    POS_SETEVENTNAME(sem, "taskMessageSem");
+    POS_SCHED_LOCK;
+    task->msgsem = EV_LINK((EVENT_t) sem);
+  }
+  else
+  {
+    POS_SCHED_LOCK;
+  }
+#if POSCFG_FEATURE_SLEEPUNTIL != 0
+  if (deadline != NULL)
+    timeoutticks = pos_ticksUntil(*deadline);
+#endif
+
+  mbuf = MSG_PTR(task->firstmsg);
+
+  if ((timeoutticks != 0) && (mbuf == NULL))
+  {
+    if (timeoutticks != INFINITE)
+    {
+      tasktimerticks(task) = timeoutticks;
+      pos_addToSleepList(task);
+#ifdef POS_DEBUGHELP
+      task->deb.state = task_waitingForMessageWithTimeout;
+    }
+    else
+    {
+      task->deb.state = task_waitingForMessage;
+#endif
+    }
+
+    task->msgwait = 1;
+    pos_disableTask(task);
+    pos_eventAddTask(EV_PTR(task->msgsem), task);
+    pos_schedule();
+    mbuf = MSG_PTR(task->firstmsg);
+
+    if (task->msgwait != 0)
+    {
+      pos_eventRemoveTask(EV_PTR(task->msgsem), task);
+      task->msgwait = 0;
+    }
+    if ((timeoutticks != INFINITE) &&
+        (task->prev != TASK_LINK(task)))
+    {
+      cleartimerticks(task);
+      pos_removeFromSleepList(task);
+    }
+  }
+
+  if (mbuf != NULL)
+  {
+    task->firstmsg = mbuf->next;
+    pos_statDec(task->stats.msgcount);
+    if (task->firstmsg == MSG_NIL)
+    {
+      task->lastmsg = MSG_NIL;
+    }
+#if POSCFG_FEATURE_MSGURGENT != 0
+    if (task->lasturgent == MSG_LINK(mbuf))
+    {
+      task->lasturgent = MSG_NIL;
+    }
+#endif
+    POS_SCHED_UNLOCK;
+#if POSCFG_MSG_MEMORY == 0
+    buf = mbuf->bufptr;
+    pos_msgFree(mbuf);
+    return buf;
+#else
+    return (void*) (mbuf->buffer);
+#endif
+  }
+
+  if (timeoutticks != 0)
+  {
+    pos_statInc(task->stats.timeouts);
+  }
+  POS_SCHED_UNLOCK;
+  return NULL;
+}
+
+#endif  /* POSCFG_FEATURE_MSGWAIT */
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_MSGMATCH != 0
 
-void* POSCALL posMessageWait(UINT_t timeoutticks)
+void* POSCALL posMessageWaitMatch(POSMSGMATCH_t match, void *arg,
+                                  UINT_t timeoutticks)
 {
   register POSTASK_t task = posCurrentTask_g;
   register MSGBUF_t *mbuf;
-  register POSSEMA_t sem;
-#if POSCFG_MSG_MEMORY == 0
-  void *buf;
-#endif
+  MSGBUF_t *prev;
+  POSSEMA_t sem;
+  UVAR_t   sleeping;
+  void     *buf;
   POS_LOCKFLAGS;
 
-  P_ASSERT("posMessageWait: not in an interrupt", posInInterrupt_g == 0);
+  P_ASSERT("posMessageWaitMatch: not in an interrupt", posInInterrupt_g == 0);
+  P_ASSERT("posMessageWaitMatch: filter function valid", match != NULL);
 #if POSCFG_ARGCHECK > 1
-  if (posInInterrupt_g != 0)
+  if ((posInInterrupt_g != 0) || (match == NULL))
     return NULL;
 #endif
 
-  if (task->msgsem == NULL)
+  if (task->msgsem == EV_NIL)
   {
     sem = posSemaCreate(0);
     if (sem == NULL)
@@ -2219,21 +4173,51 @@ void* POSCALL posMessageWait(UINT_t timeoutticks)
     }
     POS_SETEVENTNAME(sem, "taskMessageSem");
     POS_SCHED_LOCK;
-    task->msgsem = sem;
+    task->msgsem = EV_LINK((EVENT_t) sem);
   }
   else
   {
     POS_SCHED_LOCK;
   }
 
-  mbuf = (MSGBUF_t*) (task->firstmsg);
-
-  if ((timeoutticks != 0) && (mbuf == NULL))
+  sleeping = 0;
+  for (;;)
   {
+    prev = NULL;
+    buf  = NULL;
+    mbuf = MSG_PTR(task->firstmsg);
+    while (mbuf != NULL)
+    {
+#if POSCFG_MSG_MEMORY == 0
+      buf = mbuf->bufptr;
+#else
+      buf = (void*) (mbuf->buffer);
+#endif
+      if ((match)(buf, arg) != 0)
+        break;
+      prev = mbuf;
+      mbuf = MSG_PTR(mbuf->next);
+    }
+
+    if ((mbuf != NULL) || (timeoutticks == 0))
+      break;
+
+    /* The sleep timer keeps running while the task is woken up by
+       messages that do not match, so the timeout is not extended. */
     if (timeoutticks != INFINITE)
     {
-      tasktimerticks(task) = timeoutticks;
-      pos_addToSleepList(task);
+      if (sleeping == 0)
+      {
+        tasktimerticks(task) = timeoutticks;
+        pos_addToSleepList(task);
+        sleeping = 1;
+      }
+      else
+      if (task->prev == TASK_LINK(task))
+      {
+        sleeping = 0;
+        break;
+      }
 #ifdef POS_DEBUGHELP
       task->deb.state = task_waitingForMessageWithTimeout;
     }
@@ -2245,51 +4229,66 @@ void* POSCALL posMessageWait(UINT_t timeoutticks)
 
     task->msgwait = 1;
     pos_disableTask(task);
-    pos_eventAddTask((EVENT_t)task->msgsem, task);
+    pos_eventAddTask(EV_PTR(task->msgsem), task);
     pos_schedule();
-    mbuf = (MSGBUF_t*) (task->firstmsg);
 
     if (task->msgwait != 0)
     {
-      pos_eventRemoveTask((EVENT_t)task->msgsem, task);
+      pos_eventRemoveTask(EV_PTR(task->msgsem), task);
       task->msgwait = 0;
     }
-    if ((timeoutticks != INFINITE) &&
-        (task->prev != task))
-    {
-      cleartimerticks(task);
-      pos_removeFromSleepList(task);
-    }
   }
 
-  if (mbuf != NULL)
+  if ((sleeping != 0) && (task->prev != TASK_LINK(task)))
   {
-    task->firstmsg = (void*) (mbuf->next);
-    if (task->firstmsg == NULL)
+    cleartimerticks(task);
+    pos_removeFromSleepList(task);
+  }
+
+  if (mbuf == NULL)
+  {
+    if (timeoutticks != 0)
     {
-      task->lastmsg = NULL;
+      pos_statInc(task->stats.timeouts);
     }
     POS_SCHED_UNLOCK;
-#if POSCFG_MSG_MEMORY == 0
-    buf = mbuf->bufptr;
-    pos_msgFree(mbuf);
-    return buf;
-#else
-    return (void*) (mbuf->buffer);
-#endif
+    return NULL;
   }
 
+  if (prev == NULL)
+  {
+    task->firstmsg = mbuf->next;
+  }
+  else
+  {
+    prev->next = mbuf->next;
+  }
+  pos_statDec(task->stats.msgcount);
+  if (task->lastmsg == MSG_LINK(mbuf))
+  {
+    task->lastmsg = MSG_LINK(prev);
+  }
+#if POSCFG_FEATURE_MSGURGENT != 0
+  if (task->lasturgent == MSG_LINK(mbuf))
+  {
+    task->lasturgent = MSG_LINK(prev);
+  }
+#endif
   POS_SCHED_UNLOCK;
-  return NULL;
+
+#if POSCFG_MSG_MEMORY == 0
+  pos_msgFree(mbuf);
+#endif
+  return buf;
 }
 
-#endif  /* POSCFG_FEATURE_MSGWAIT */
+#endif  /* POSCFG_FEATURE_MSGMATCH */
 
 /*-------------------------------------------------------------------------*/
 
 VAR_t POSCALL posMessageAvailable(void)
 {
-  return (posCurrentTask_g->firstmsg != NULL) ? 1 : 0;
+  return (posCurrentTask_g->firstmsg != MSG_NIL) ? 1 : 0;
 }
 
 #endif  /* POSCFG_FEATURE_MSGBOXES */
@@ -2304,17 +4303,65 @@ VAR_t POSCALL posMessageAvailable(void)
 JIF_t POSCALL posGetJiffies(void)
 {
   register JIF_t  jif;
-  POS_LOCKFLAGS;
- 
-  POS_SCHED_LOCK;
-  jif = pos_jiffies_g;
-  POS_SCHED_UNLOCK;
+  register UVAR_t seq;
+
+  /* retry when the timer interrupt has changed the variable meanwhile */
+  do
+  {
+    seq = pos_timeSeq_g;
+    POS_MEMBARRIER();
+    jif = pos_jiffies_g;
+    POS_MEMBARRIER();
+  }
+  while (((seq & 1) != 0) || (seq != pos_timeSeq_g));
   return jif;
 }
 #endif  /* POSCFG_FEATURE_JIFFIES */
 
 /*-------------------------------------------------------------------------*/
 
+#if POSCFG_FEATURE_HRTIME != 0
+
+POSCYCLES_t POSCALL posGetCycles(void)
+{
+  return POS_CYCLES();
+}
+
+/*-------------------------------------------------------------------------*/
+
+#define POS_NSEC_PER_SEC  1000000000UL
+
+POSTIME_t POSCALL posGetTimeNs(void)
+{
+  POSTIME_t    ticks;
+  POSCYCLES_t  delta, pertick;
+  register UVAR_t seq;
+
+  do
+  {
+    seq   = pos_timeSeq_g;
+    POS_MEMBARRIER();
+    ticks = pos_hrTicks_g;
+    delta = POS_CYCLES() - pos_tickCycles_g;
+    POS_MEMBARRIER();
+  }
+  while (((seq & 1) != 0) || (seq != pos_timeSeq_g));
+
+  /* A late timer interrupt must not let the time run backwards,
+     so the time since the last tick is limited to one tick. */
+  pertick = (POSCYCLES_t) (POS_CYCLES_HZ / HZ);
+  if (delta >= pertick)
+    delta = pertick - 1;
+
+  return ((ticks / HZ) * POS_NSEC_PER_SEC) +
+         (((ticks % HZ) * POS_NSEC_PER_SEC) / HZ) +
+         (((POSTIME_t) delta * POS_NSEC_PER_SEC) / POS_CYCLES_HZ);
+}
+
+#endif  /* POSCFG_FEATURE_HRTIME */
+
+/*-------------------------------------------------------------------------*/
+
 #if POSCFG_FEATURE_TIMER != 0
 
 POSTIMER_t POSCALL posTimerCreate(void)
@@ -2341,7 +4388,7 @@ POSTIMER_t POSCALL posTimerCreate(void)
   }
   else
   {
-    posFreeTimer_g = t->next;
+    posFreeTimer_g = TMR_PTR(t->next);
     POS_SCHED_UNLOCK;
   }
 #else /* SYS_POSTALLOCATE */
@@ -2351,19 +4398,24 @@ POSTIMER_t POSCALL posTimerCreate(void)
 #endif
      )
   {
+    pos_statInc(posSysStats_g.allocfail);
     POS_SCHED_UNLOCK;
     return NULL;
   }
-  posFreeTimer_g = t->next;
+  posFreeTimer_g = TMR_PTR(t->next);
   POS_SCHED_UNLOCK;
 #endif /* SYS_POSTALLOCATE */
-  t->prev   = t;
+  t->prev   = TMR_LINK(t);
 #if POSCFG_ARGCHECK > 1
   t->wait   = 0;
   t->reload = 0;
 #endif
 #if POSCFG_FEATURE_TIMERFIRED != 0
   t->fired  = 0;
+#endif
+#if POSCFG_FEATURE_TIMERCALLBACK != 0
+  t->func   = NULL;
+  t->queued = 0;
 #endif
   return (POSTIMER_t) t;
 }
@@ -2381,9 +4433,9 @@ void POSCALL posTimerDestroy(POSTIMER_t tmr)
   POS_ARGCHECK(t, t->magic, POSMAGIC_TIMER); 
   posTimerStop(tmr);
   POS_SCHED_LOCK;
-  if (t == t->prev)
+  if (t->prev == TMR_LINK(t))
   {
-    t->next = posFreeTimer_g;
+    t->next = TMR_LINK(posFreeTimer_g);
     posFreeTimer_g = t;
   }
   POS_SCHED_UNLOCK;
@@ -2411,13 +4463,57 @@ VAR_t POSCALL posTimerSet(POSTIMER_t tmr, POSSEMA_t sema,
 
   posTimerStop(tmr);
   POS_SCHED_LOCK;
-  t->sema   = sema;
+  t->sema   = EV_LINK((EVENT_t) sema);
   t->wait   = waitticks;
   t->reload = periodticks;
+#if POSCFG_FEATURE_TIMERCALLBACK != 0
+  t->func   = NULL;
+#endif
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_TIMERCALLBACK != 0
+
+VAR_t POSCALL posTimerSetCallback(POSTIMER_t tmr,
+                                  POSTIMERFUNC_t func, void *arg,
+                                  UVAR_t context,
+                                  UINT_t waitticks, UINT_t periodticks)
+{
+  register TIMER_t  *t = (TIMER_t*) tmr;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posTimerSetCallback: timer valid", tmr != NULL);
+  P_ASSERT("posTimerSetCallback: function valid", func != NULL);
+  POS_ARGCHECK_RET(t, t->magic, POSMAGIC_TIMER, -E_ARG); 
+  if ((func == NULL) ||
+#if POS_TIMERTASK != 0
+      ((context != POSTIMER_TICKCTX) && (context != POSTIMER_TASKCTX))
+#else
+      (context != POSTIMER_TICKCTX)
+#endif
+     )
+    return -E_ARG;
+#if POSCFG_ARGCHECK > 1
+  if (waitticks == 0)
+     return -E_ARG;
+#endif
+
+  posTimerStop(tmr);
+  POS_SCHED_LOCK;
+  t->sema    = EV_NIL;
+  t->func    = func;
+  t->arg     = arg;
+  t->context = context;
+  t->wait    = waitticks;
+  t->reload  = periodticks;
   POS_SCHED_UNLOCK;
   return E_OK;
 }
 
+#endif  /* POSCFG_FEATURE_TIMERCALLBACK */
 /*-------------------------------------------------------------------------*/
 
 VAR_t POSCALL posTimerStart(POSTIMER_t tmr)
@@ -2429,7 +4525,7 @@ VAR_t POSCALL posTimerStart(POSTIMER_t tmr)
   POS_ARGCHECK_RET(t, t->magic, POSMAGIC_TIMER, -E_ARG); 
   POS_SCHED_LOCK;
   t->counter = t->wait;
-  if (t->prev == t)
+  if (t->prev == TMR_LINK(t))
   {
 #if POSCFG_FEATURE_TIMERFIRED != 0
     t->fired = 0;
@@ -2450,10 +4546,30 @@ VAR_t POSCALL posTimerStop(POSTIMER_t tmr)
   P_ASSERT("posTimerStop: timer valid", tmr != NULL);
   POS_ARGCHECK_RET(t, t->magic, POSMAGIC_TIMER, -E_ARG); 
   POS_SCHED_LOCK;
-  if (t->prev != t)
+  if (t->prev != TMR_LINK(t))
   {
     pos_removeFromTimerList(t);
   }
+#if POS_TIMERTASK != 0
+  if (t->queued != 0)
+  {
+    /* remove the timer from the queue of the timer service task */
+    register TIMER_t *last = NULL;
+    register TIMER_t *q = posTimerQueueHead_g;
+    while (q != t)
+    {
+      last = q;
+      q = TMR_PTR(q->cbnext);
+    }
+    if (last == NULL)
+      posTimerQueueHead_g = TMR_PTR(t->cbnext);
+    else
+      last->cbnext = t->cbnext;
+    if (posTimerQueueTail_g == t)
+      posTimerQueueTail_g = last;
+    t->queued = 0;
+  }
+#endif
   POS_SCHED_UNLOCK;
   return E_OK;
 }
@@ -2479,6 +4595,48 @@ VAR_t POSCALL posTimerFired(POSTIMER_t tmr)
 
 #endif  /* POSCFG_FEATURE_TIMERFIRED */
 
+/*-------------------------------------------------------------------------*/
+
+#if POS_TIMERTASK != 0
+
+/* The timer service task executes the callback functions of all
+ * timers that were set up with context POSTIMER_TASKCTX.
+ */
+static void pos_timertask(void *arg)
+{
+  register TIMER_t  *t;
+  POSTIMERFUNC_t    func;
+  void              *farg;
+  POS_LOCKFLAGS;
+
+  (void) arg;
+
+  for(;;)
+  {
+    posSemaGet(posTimerTaskSema_g);
+
+    for(;;)
+    {
+      POS_SCHED_LOCK;
+      t = posTimerQueueHead_g;
+      if (t == NULL)
+      {
+        POS_SCHED_UNLOCK;
+        break;
+      }
+      posTimerQueueHead_g = TMR_PTR(t->cbnext);
+      t->queued = 0;
+      func = t->func;
+      farg = t->arg;
+      POS_SCHED_UNLOCK;
+
+      (func)((POSTIMER_t) t, farg);
+    }
+  }
+}
+
+#endif  /* POS_TIMERTASK */
+
 #endif  /* POSCFG_FEATURE_TIMER */
 
 
@@ -2564,6 +4722,7 @@ VAR_t POSCALL posFlagGet(POSFLAG_t flg, UVAR_t mode)
   POS_SCHED_LOCK;
   if (ev->e.d.flags == 0)
   {
+    pos_statInc(ev->e.stats.contended);
     do
     {
       pos_disableTask(task);
@@ -2593,7 +4752,25 @@ VAR_t POSCALL posFlagGet(POSFLAG_t flg, UVAR_t mode)
 
 #if POSCFG_FEATURE_FLAGWAIT != 0
 
+#if POSCFG_FEATURE_SLEEPUNTIL != 0
+VAR_t POSCALL posFlagWaitUntil(POSFLAG_t flg, JIF_t deadline)
+{
+  return pos_flagWait(flg, 0, &deadline);
+}
+
+VAR_t POSCALL posFlagWait(POSFLAG_t flg, UINT_t timeoutticks)
+{
+  return pos_flagWait(flg, timeoutticks, NULL);
+}
+
+/* Waits for flags. If deadline is not NULL, the timeout is
+ * computed from the deadline with the kernel locked.
+ */
+static VAR_t POSCALL pos_flagWait(POSFLAG_t flg, UINT_t timeoutticks,
+                                  const JIF_t *deadline)
+#else
 VAR_t POSCALL posFlagWait(POSFLAG_t flg, UINT_t timeoutticks)
+#endif
 {
   register EVENT_t  ev = (EVENT_t) flg;
   register POSTASK_t task = posCurrentTask_g;
@@ -2608,6 +4785,10 @@ VAR_t POSCALL posFlagWait(POSFLAG_t flg, UINT_t timeoutticks)
   P_ASSERT("posFlagWait: not in an interrupt", posInInterrupt_g == 0);
   POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
   POS_SCHED_LOCK;
+#if POSCFG_FEATURE_SLEEPUNTIL != 0
+  if (deadline != NULL)
+    timeoutticks = pos_ticksUntil(*deadline);
+#endif
 
   if ((timeoutticks != 0) && (ev->e.d.flags == 0))
   {
@@ -2624,23 +4805,31 @@ VAR_t POSCALL posFlagWait(POSFLAG_t flg, UINT_t timeoutticks)
 #endif
     }
 
+    pos_statInc(ev->e.stats.contended);
     do
     {
       pos_disableTask(task);
       pos_eventAddTask(ev, task);
       pos_schedule();
     }
-    while ((ev->e.d.flags == 0) && 
-           ((timeoutticks == INFINITE) || (task->prev != task)));
+    while ((ev->e.d.flags == 0) &&
+           ((timeoutticks == INFINITE) ||
+            (task->prev != TASK_LINK(task))));
 
     if (timeoutticks != INFINITE)
     {
       pos_eventRemoveTask(ev, task);
-      if (task->prev != task)
+      if (task->prev != TASK_LINK(task))
       {
         cleartimerticks(task);
         pos_removeFromSleepList(task);
       }
+      else
+      if (ev->e.d.flags == 0)
+      {
+        pos_statInc(ev->e.stats.timeouts);
+        pos_statInc(task->stats.timeouts);
+      }
     }
   }
   f = ev->e.d.flags;
@@ -2734,16 +4923,66 @@ VAR_t POSCALL posSoftIntDelHandler(UVAR_t intno)
 
 #if POSCFG_FEATURE_ATOMICVAR != 0
 
+#if POSCFG_ATOMIC_BUILTIN != 1
+
+/* operations for pos_atomicModify */
+#define POS_ATOMIC_ADD  0
+#define POS_ATOMIC_SUB  1
+#define POS_ATOMIC_OR   2
+#define POS_ATOMIC_AND  3
+
+static INT_t pos_atomicModify(POSATOMIC_t *var, INT_t value, UVAR_t op);
+static INT_t pos_atomicModify(POSATOMIC_t *var, INT_t value, UVAR_t op)
+{
+  INT_t lastval, newval;
+#if POSCFG_ATOMIC_BUILTIN == 0
+  POS_LOCKFLAGS;
+
+  POS_SCHED_LOCK;
+#else
+  do
+  {
+#endif
+    lastval = *var;
+    switch (op)
+    {
+      case POS_ATOMIC_ADD:  newval = lastval + value;  break;
+      case POS_ATOMIC_SUB:  newval = lastval - value;  break;
+      case POS_ATOMIC_OR:   newval = lastval | value;  break;
+      default:              newval = lastval & value;  break;
+    }
+#if POSCFG_ATOMIC_BUILTIN == 0
+    *var = newval;
+  POS_SCHED_UNLOCK;
+#else
+  }
+  while (p_pos_atomicCAS(var, lastval, newval) != lastval);
+#endif
+  return lastval;
+}
+
+#endif /* POSCFG_ATOMIC_BUILTIN != 1 */
+
+/*-------------------------------------------------------------------------*/
+
 void POSCALL posAtomicSet(POSATOMIC_t *var, INT_t value)
 {
+#if POSCFG_ATOMIC_BUILTIN == 0
   POS_LOCKFLAGS;
+#endif
 
   P_ASSERT("posAtomicSet: variable pointer", var != NULL);
   if (var != NULL)
   {
+#if POSCFG_ATOMIC_BUILTIN == 0
     POS_SCHED_LOCK;
     *var = value;
     POS_SCHED_UNLOCK;
+#elif POSCFG_ATOMIC_BUILTIN == 1
+    __atomic_store_n(var, value, __ATOMIC_SEQ_CST);
+#else
+    *var = value;
+#endif
   }
 }
 
@@ -2751,53 +4990,192 @@ void POSCALL posAtomicSet(POSATOMIC_t *var, INT_t value)
 
 INT_t POSCALL posAtomicGet(POSATOMIC_t *var)
 {
+#if POSCFG_ATOMIC_BUILTIN == 0
   INT_t value;
   POS_LOCKFLAGS;
+#endif
 
   P_ASSERT("posAtomicGet: variable pointer", var != NULL);
   if (var == NULL)
     return 0;
 
-  POS_SCHED_LOCK;
-  value = *var;
-  POS_SCHED_UNLOCK;
-  return value;
+#if POSCFG_ATOMIC_BUILTIN == 0
+  POS_SCHED_LOCK;
+  value = *var;
+  POS_SCHED_UNLOCK;
+  return value;
+#elif POSCFG_ATOMIC_BUILTIN == 1
+  return __atomic_load_n(var, __ATOMIC_SEQ_CST);
+#else
+  return *var;
+#endif
+}
+
+/*-------------------------------------------------------------------------*/
+
+INT_t POSCALL posAtomicAdd(POSATOMIC_t *var, INT_t value)
+{
+  P_ASSERT("posAtomicAdd: variable pointer", var != NULL);
+  if (var == NULL)
+    return 0;
+
+#if POSCFG_ATOMIC_BUILTIN == 1
+  return __atomic_fetch_add(var, value, __ATOMIC_SEQ_CST);
+#else
+  return pos_atomicModify(var, value, POS_ATOMIC_ADD);
+#endif
+}
+
+/*-------------------------------------------------------------------------*/
+
+INT_t POSCALL posAtomicSub(POSATOMIC_t *var, INT_t value)
+{
+  P_ASSERT("posAtomicSub: variable pointer", var != NULL);
+  if (var == NULL)
+    return 0;
+
+#if POSCFG_ATOMIC_BUILTIN == 1
+  return __atomic_fetch_sub(var, value, __ATOMIC_SEQ_CST);
+#else
+  return pos_atomicModify(var, value, POS_ATOMIC_SUB);
+#endif
+}
+
+/*-------------------------------------------------------------------------*/
+
+INT_t POSCALL posAtomicOr(POSATOMIC_t *var, INT_t value)
+{
+  P_ASSERT("posAtomicOr: variable pointer", var != NULL);
+  if (var == NULL)
+    return 0;
+
+#if POSCFG_ATOMIC_BUILTIN == 1
+  return __atomic_fetch_or(var, value, __ATOMIC_SEQ_CST);
+#else
+  return pos_atomicModify(var, value, POS_ATOMIC_OR);
+#endif
+}
+
+/*-------------------------------------------------------------------------*/
+
+INT_t POSCALL posAtomicAnd(POSATOMIC_t *var, INT_t value)
+{
+  P_ASSERT("posAtomicAnd: variable pointer", var != NULL);
+  if (var == NULL)
+    return 0;
+
+#if POSCFG_ATOMIC_BUILTIN == 1
+  return __atomic_fetch_and(var, value, __ATOMIC_SEQ_CST);
+#else
+  return pos_atomicModify(var, value, POS_ATOMIC_AND);
+#endif
+}
+
+/*-------------------------------------------------------------------------*/
+
+INT_t POSCALL posAtomicCAS(POSATOMIC_t *var, INT_t oldval, INT_t newval)
+{
+#if POSCFG_ATOMIC_BUILTIN == 0
+  INT_t lastval;
+  POS_LOCKFLAGS;
+#endif
+
+  P_ASSERT("posAtomicCAS: variable pointer", var != NULL);
+  if (var == NULL)
+    return 0;
+
+#if POSCFG_ATOMIC_BUILTIN == 0
+  POS_SCHED_LOCK;
+  lastval = *var;
+  if (lastval == oldval)
+    *var = newval;
+  POS_SCHED_UNLOCK;
+  return lastval;
+#elif POSCFG_ATOMIC_BUILTIN == 1
+  /* on failure, oldval is overwritten with the current value */
+  (void) __atomic_compare_exchange_n(var, &oldval, newval, 0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  return oldval;
+#else
+  return p_pos_atomicCAS(var, oldval, newval);
+#endif
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL posAtomicPtrSet(POSATOMICPTR_t *var, void *ptr)
+{
+#if POSCFG_ATOMIC_BUILTIN == 0
+  POS_LOCKFLAGS;
+#endif
+
+  P_ASSERT("posAtomicPtrSet: variable pointer", var != NULL);
+  if (var != NULL)
+  {
+#if POSCFG_ATOMIC_BUILTIN == 0
+    POS_SCHED_LOCK;
+    *var = ptr;
+    POS_SCHED_UNLOCK;
+#elif POSCFG_ATOMIC_BUILTIN == 1
+    __atomic_store_n(var, ptr, __ATOMIC_SEQ_CST);
+#else
+    *var = ptr;
+#endif
+  }
 }
 
 /*-------------------------------------------------------------------------*/
 
-INT_t POSCALL posAtomicAdd(POSATOMIC_t *var, INT_t value)
+void* POSCALL posAtomicPtrGet(POSATOMICPTR_t *var)
 {
-  INT_t lastval;
+#if POSCFG_ATOMIC_BUILTIN == 0
+  void *ptr;
   POS_LOCKFLAGS;
+#endif
 
-  P_ASSERT("posAtomicAdd: variable pointer", var != NULL);
+  P_ASSERT("posAtomicPtrGet: variable pointer", var != NULL);
   if (var == NULL)
-    return 0;
+    return NULL;
 
+#if POSCFG_ATOMIC_BUILTIN == 0
   POS_SCHED_LOCK;
-  lastval = *var;
-  *var += value;
+  ptr = *var;
   POS_SCHED_UNLOCK;
-  return lastval;
+  return ptr;
+#elif POSCFG_ATOMIC_BUILTIN == 1
+  return __atomic_load_n(var, __ATOMIC_SEQ_CST);
+#else
+  return *var;
+#endif
 }
 
 /*-------------------------------------------------------------------------*/
 
-INT_t POSCALL posAtomicSub(POSATOMIC_t *var, INT_t value)
+void* POSCALL posAtomicPtrCAS(POSATOMICPTR_t *var, void *oldptr, void *newptr)
 {
-  INT_t lastval;
+#if POSCFG_ATOMIC_BUILTIN == 0
+  void *lastptr;
   POS_LOCKFLAGS;
+#endif
 
-  P_ASSERT("posAtomicSub: variable pointer", var != NULL);
+  P_ASSERT("posAtomicPtrCAS: variable pointer", var != NULL);
   if (var == NULL)
-    return 0;
+    return NULL;
 
+#if POSCFG_ATOMIC_BUILTIN == 0
   POS_SCHED_LOCK;
-  lastval = *var;
-  *var -= value;
+  lastptr = *var;
+  if (lastptr == oldptr)
+    *var = newptr;
   POS_SCHED_UNLOCK;
-  return lastval;
+  return lastptr;
+#elif POSCFG_ATOMIC_BUILTIN == 1
+  (void) __atomic_compare_exchange_n(var, &oldptr, newptr, 0,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  return oldptr;
+#else
+  return p_pos_atomicPtrCAS(var, oldptr, newptr);
+#endif
 }
 
 #endif /* POSCFG_FEATURE_ATOMICVAR */
@@ -2812,7 +5190,6 @@ INT_t POSCALL posAtomicSub(POSATOMIC_t *var, INT_t value)
 
 void POSCALL posListAdd(POSLISTHEAD_t *listhead, UVAR_t pos, POSLIST_t *new)
 {
-  register POSLIST_t *next, *prev;
   POS_LOCKFLAGS;
 
   P_ASSERT("posListAdd: list valid", listhead != NULL);
@@ -2821,34 +5198,20 @@ void POSCALL posListAdd(POSLISTHEAD_t *listhead, UVAR_t pos, POSLIST_t *new)
   P_ASSERT("posListAdd: new element valid", new != NULL);
 
   POS_SCHED_LOCK;
-  if (pos == POSLIST_HEAD)
-  {
-    next = listhead->next;
-    prev = (POSLIST_t*) listhead;
-  }
-  else
-  {
-    next = (POSLIST_t*) listhead;
-    prev = listhead->prev;
-  }
-  next->prev = new;
-  new->next  = next;
-  new->prev  = prev;
-  prev->next = new;
-#if POSCFG_FEATURE_LISTLEN != 0
-  new->head  = listhead;
-  listhead->length++;
-#endif
+  pos_listAdd(listhead, pos, new);
+
+  /* The flag is set only while a task waits for the list to become
+     non-empty, so the semaphore is signalled once per waiting period
+     and not once per element. The semaphore is signalled without
+     releasing the lock, so this function can also be called from an
+     interrupt service routine; the task switch is then done when
+     the interrupt exits. */
   if (listhead->flag != 0)
   {
     listhead->flag = 0;
-    POS_SCHED_UNLOCK;
-    posSemaSignal(listhead->sema);
-  }
-  else
-  {
-    POS_SCHED_UNLOCK;
+    pos_semaSignal((EVENT_t) listhead->sema);
   }
+  POS_SCHED_UNLOCK;
 }
 
 /*-------------------------------------------------------------------------*/
@@ -2934,6 +5297,42 @@ POSLIST_t* POSCALL posListGet(POSLISTHEAD_t *listhead, UVAR_t pos,
 
 /*-------------------------------------------------------------------------*/
 
+#if POSCFG_FEATURE_LISTGETN != 0
+
+UINT_t POSCALL posListGetN(POSLISTHEAD_t *listhead, POSLISTHEAD_t *dest,
+                           UINT_t count, UINT_t timeout)
+{
+  register POSLIST_t *elem;
+  UINT_t n;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posListGetN: list valid", listhead != NULL);
+  P_ASSERT("posListGetN: destination list valid", dest != NULL);
+
+  POS_SCHED_LOCK;
+  n = pos_listMove(dest, listhead, count);
+  POS_SCHED_UNLOCK;
+
+  if ((n == 0) && (count != 0) && (timeout != 0))
+  {
+    /* The list is empty. Wait for the first element,
+       and take all elements that have arrived meanwhile. */
+    elem = posListGet(listhead, POSLIST_HEAD, timeout);
+    if (elem != NULL)
+    {
+      POS_SCHED_LOCK;
+      pos_listAdd(dest, POSLIST_TAIL, elem);
+      n = 1 + pos_listMove(dest, listhead, count - 1);
+      POS_SCHED_UNLOCK;
+    }
+  }
+  return n;
+}
+
+#endif /* POSCFG_FEATURE_LISTGETN */
+
+/*-------------------------------------------------------------------------*/
+
 void POSCALL posListRemove(POSLIST_t *listelem)
 {
   POS_LOCKFLAGS;
@@ -2998,13 +5397,9 @@ void POSCALL posListJoin(POSLISTHEAD_t *baselisthead, UVAR_t pos,
     if (baselisthead->flag != 0)
     {
       baselisthead->flag = 0;
-      POS_SCHED_UNLOCK;
-      posSemaSignal(baselisthead->sema);
-    }
-    else
-    {
-      POS_SCHED_UNLOCK;
+      pos_semaSignal((EVENT_t) baselisthead->sema);
     }
+    POS_SCHED_UNLOCK;
   }
 }
 
@@ -3075,6 +5470,170 @@ void POSCALL posListTerm(POSLISTHEAD_t *listhead)
 
 
 
+/*---------------------------------------------------------------------------
+ * EXPORTED FUNCTIONS:  STATISTICS
+ *-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_STATISTICS != 0
+
+/* Returns the state of a task, must be called with the kernel locked */
+static UVAR_t POSCALL pos_taskRunState(POSTASK_t task);
+static UVAR_t POSCALL pos_taskRunState(POSTASK_t task)
+{
+#if SYS_SMP != 0
+  register UVAR_t c;
+
+  for (c = 0; c < POSCFG_SMP_CORES; ++c)
+  {
+    if (posCoreCurrentTask_g[c] == task)
+      return POSTASKRUN_RUNNING;
+  }
+  if (pos_isTableBitSet(&posCoreReadyTasks_g[task->core], task))
+    return POSTASKRUN_READY;
+#else
+  if (task == posCurrentTask_g)
+    return POSTASKRUN_RUNNING;
+  if (pos_isTableBitSet(&posReadyTasks_g, task))
+    return POSTASKRUN_READY;
+#endif
+#if POSCFG_FEATURE_MSGBOXES != 0
+  if (task->msgwait != 0)
+    return POSTASKRUN_WAITMSG;
+#endif
+  return POSTASKRUN_BLOCKED;
+}
+
+VAR_t POSCALL posTaskGetStats(POSTASK_t taskhandle, POSTASKSTATS_t *stats)
+{
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posTaskGetStats: task handle valid", taskhandle != NULL);
+  P_ASSERT("posTaskGetStats: stats valid", stats != NULL);
+  POS_ARGCHECK_RET(taskhandle, taskhandle->magic, POSMAGIC_TASK, -E_ARG); 
+  if (stats == NULL)
+    return -E_ARG;
+
+  POS_SCHED_LOCK;
+  *stats = taskhandle->stats;
+  stats->state = pos_taskRunState(taskhandle);
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+/*-------------------------------------------------------------------------*/
+
+#if SYS_FEATURE_EVENTS != 0
+
+VAR_t POSCALL posEventGetStats(void *event, POSEVENTSTATS_t *stats)
+{
+  register EVENT_t  ev = (EVENT_t) event;
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posEventGetStats: event valid", ev != NULL);
+#if POSCFG_ARGCHECK > 1
+  P_ASSERT("posEventGetStats: event allocated",
+           ev->e.magic == POSMAGIC_EVENTU);
+#endif
+  P_ASSERT("posEventGetStats: stats valid", stats != NULL);
+  POS_ARGCHECK_RET(ev, ev->e.magic, POSMAGIC_EVENTU, -E_ARG); 
+  if (stats == NULL)
+    return -E_ARG;
+
+  POS_SCHED_LOCK;
+  *stats = ev->e.stats;
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+#endif  /* SYS_FEATURE_EVENTS */
+
+/*-------------------------------------------------------------------------*/
+
+VAR_t POSCALL posSystemGetStats(POSSYSSTATS_t *stats)
+{
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posSystemGetStats: stats valid", stats != NULL);
+  if (stats == NULL)
+    return -E_ARG;
+
+  POS_SCHED_LOCK;
+  *stats = posSysStats_g;
+  POS_SCHED_UNLOCK;
+  return E_OK;
+}
+
+#endif  /* POSCFG_FEATURE_STATISTICS */
+
+
+
+/*---------------------------------------------------------------------------
+ * EXPORTED FUNCTIONS:  LOCK PROFILER
+ *-------------------------------------------------------------------------*/
+
+#if POSCFG_FEATURE_LOCKPROF != 0
+
+void POSCALL c_pos_lockProfEnter(POSLOCKSITE_t *site)
+{
+  register LOCKPROF_t *lp = &posLockProf_g[POS_LOCKPROF_IRQ];
+
+  if (lp->depth++ == 0)
+  {
+    lp->site  = site;
+    lp->start = POS_CYCLES();
+  }
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL c_pos_lockProfLeave(void)
+{
+  register LOCKPROF_t *lp = &posLockProf_g[POS_LOCKPROF_IRQ];
+
+  /* the depth is zero when the section was ended by a context switch */
+  if ((lp->depth != 0) && (--lp->depth == 0))
+    pos_lockProfRecord(lp->site, lp->start);
+}
+
+/*-------------------------------------------------------------------------*/
+
+POSLOCKSITE_t* POSCALL posLockProfNext(POSLOCKSITE_t *site,
+                                       POSLOCKSTATS_t *stats)
+{
+  POS_LOCKFLAGS;
+
+  P_ASSERT("posLockProfNext: stats valid", stats != NULL);
+  POS_SCHED_LOCK;
+  site = (site == NULL) ? posLockSites_g : site->next;
+  if ((site != NULL) && (stats != NULL))
+    *stats = site->stats;
+  POS_SCHED_UNLOCK;
+  return site;
+}
+
+/*-------------------------------------------------------------------------*/
+
+void POSCALL posLockProfReset(void)
+{
+  register POSLOCKSITE_t *site;
+  register UVAR_t b;
+  POS_LOCKFLAGS;
+
+  POS_SCHED_LOCK;
+  for (site = posLockSites_g; site != NULL; site = site->next)
+  {
+    site->stats.count = 0;
+    site->stats.max = 0;
+    for (b = 0; b < POSCFG_LOCKPROF_BUCKETS; ++b)
+      site->stats.hist[b] = 0;
+  }
+  POS_SCHED_UNLOCK;
+}
+
+#endif /* POSCFG_FEATURE_LOCKPROF */
+
+
+
 /*---------------------------------------------------------------------------
  * EXPORTED FUNCTION:  INSTALL IDLE HOOK FUNCTION
  *-------------------------------------------------------------------------*/
@@ -3124,7 +5683,10 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #if POSCFG_DYNAMIC_MEMORY != 0
   void      *m;
 #endif
-  UVAR_t   i;
+  UINT_t   i;
+#if SYS_SMP != 0
+  UVAR_t   c;
+#endif
   POS_LOCKFLAGS;
 
 #if POSCFG_CALLINITARCH != 0
@@ -3222,6 +5784,19 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 
 #endif /* POSCFG_DYNAMIC_MEMORY */
 
+#if POSCFG_COMPACT_OBJECTS != 0
+  posTaskBase_g = posFreeTasks_g;
+#if SYS_FEATURE_EVENTS != 0
+  posEventBase_g = posFreeEvents_g;
+#endif
+#if POSCFG_FEATURE_MSGBOXES != 0
+  posMessageBase_g = posFreeMessagebuf_g;
+#endif
+#if POSCFG_FEATURE_TIMER != 0
+  posTimerBase_g = posFreeTimer_g;
+#endif
+#endif
+
 #if POSCFG_MAX_TASKS != 0
   task = posFreeTasks_g;
   for (i=0; i<POSCFG_MAX_TASKS-1; ++i)
@@ -3229,13 +5804,13 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #if SYS_TASKSTATE != 0
     task->state = POSTASKSTATE_UNUSED;
 #endif
-    task->next = NEXTALIGNED(POSTASK_t, task);
-    task = task->next;
+    task->next = TASK_LINK(NEXTALIGNED(POSTASK_t, task));
+    task = NEXTALIGNED(POSTASK_t, task);
   }
 #if SYS_TASKSTATE != 0
   task->state = POSTASKSTATE_UNUSED;
 #endif
-  task->next = NULL;
+  task->next = TASK_NIL;
 #endif
   
 #if SYS_FEATURE_EVENTS != 0
@@ -3275,13 +5850,13 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #if POSCFG_ARGCHECK > 1
     mbuf->magic = POSMAGIC_MSGBUF;
 #endif
-    mbuf->next = NEXTALIGNED(MSGBUF_t*, mbuf);
-    mbuf = mbuf->next;
+    mbuf->next = MSG_LINK(NEXTALIGNED(MSGBUF_t*, mbuf));
+    mbuf = NEXTALIGNED(MSGBUF_t*, mbuf);
   }
 #if POSCFG_ARGCHECK > 1
   mbuf->magic = POSMAGIC_MSGBUF;
 #endif
-  mbuf->next = NULL;
+  mbuf->next = MSG_NIL;
 #endif
 #endif
 
@@ -3295,14 +5870,14 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #if POSCFG_ARGCHECK > 1
     tmr->magic = POSMAGIC_TIMER;
 #endif
-    tmr->next = NEXTALIGNED(TIMER_t*, tmr);
-    tmr = tmr->next;
+    tmr->next = TMR_LINK(NEXTALIGNED(TIMER_t*, tmr));
+    tmr = NEXTALIGNED(TIMER_t*, tmr);
   }
 #endif
 #if POSCFG_ARGCHECK > 1
   tmr->magic = POSMAGIC_TIMER;
 #endif
-  tmr->next = NULL;
+  tmr->next = TMR_NIL;
 #endif
 #endif
 
@@ -3316,11 +5891,34 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #else
     posAllocatedTasks_g.xtable[i] = 0;
 #endif
+#if SYS_SMP != 0
+    for (c = 0; c < POSCFG_SMP_CORES; ++c)
+    {
+      posCoreNextRoundRobin_g[c][i] = 0;
+      posCoreReadyTasks_g[c].xtable[i] = 0;
+    }
+#else
     posReadyTasks_g.xtable[i] = 0;
+#endif
   }
-#if SYS_TASKTABSIZE_Y > 1
-  posAllocatedTasks_g.ymask = 0;
-  posReadyTasks_g.ymask = 0;
+  pos_clearTableRows(&posAllocatedTasks_g);
+#if SYS_SMP != 0
+  for (c = 0; c < POSCFG_SMP_CORES; ++c)
+  {
+    pos_clearTableRows(&posCoreReadyTasks_g[c]);
+    posCoreMustSchedule_g[c] = 0;
+#if POSCFG_FEATURE_INHIBITSCHED != 0
+    posCoreInhibitSched_g[c] = 0;
+#endif
+    posCoreCurrentTask_g[c]  = NULL;
+    posCoreNextTask_g[c]     = NULL;
+    posCoreInInterrupt_g[c]  = 1;
+  }
+#if POSCFG_FEATURE_INHIBITSCHED != 0
+  posSchedLockCore_g = 0;
+#endif
+#else
+  pos_clearTableRows(&posReadyTasks_g);
 #endif
 
 #if POSCFG_FEATURE_SOFTINTS != 0
@@ -3334,11 +5932,26 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #if POSCFG_CTXSW_COMBINE > 1
   posCtxCombineCtr_g = 0;
 #endif
+#if POSCFG_CTXSW_ADAPTIVE != 0
+  posCtxCombineThr_g = 1;
+  posCtxTickEvents_g = 0;
+  posCtxStats_g.events   = 0;
+  posCtxStats_g.deferred = 0;
+  posCtxStats_g.delayed  = 0;
+#if POSCFG_FEATURE_HRTIME != 0
+  posCtxStats_g.latency    = 0;
+  posCtxStats_g.maxlatency = 0;
+  posCtxPending_g     = 0;
+  posCtxTickLatency_g = 0;
+  posCtxMaxLatency_g  = (POSCYCLES_t) (((POSTIME_t) POS_CYCLES_HZ *
+                                        POSCFG_CTXSW_LATENCY) / 1000000UL);
+#endif
+#endif
 #if POSCFG_FEATURE_INHIBITSCHED != 0
   posInhibitSched_g = 0;
 #endif
   posMustSchedule_g = 0;
-  posInInterrupt_g  = 1;
+  POS_INTNESTING    = 1;
   posSleepingTasks_g   = NULL;
 #if POSCFG_FEATURE_JIFFIES != 0
 #if POSCFG_FEATURE_LARGEJIFFIES == 0
@@ -3347,10 +5960,40 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
   pos_jiffies_g = 0;
 #endif
 #endif
+#if POS_TIMESEQ != 0
+  pos_timeSeq_g = 0;
+#endif
+#if POSCFG_FEATURE_HRTIME != 0
+  pos_hrTicks_g    = 0;
+  pos_tickCycles_g = POS_CYCLES();
+#endif
+#if POSCFG_FEATURE_EDF != 0
+  posEdfReady_g = NULL;
+#endif
 #if POSCFG_FEATURE_IDLETASKHOOK != 0
   posIdleTaskFuncHook_g = NULL;
 #endif
 
+#if SYS_SMP != 0
+  /* every core gets its own idle task */
+  for (c = 0; c < POSCFG_SMP_CORES; ++c)
+  {
+#if POSCFG_TASKSTACKTYPE == 1
+    task = posTaskCreate(pos_idletask, NULL, 0, idleStackSize);
+#else
+    task = posTaskCreate(pos_idletask, NULL, 0);
+#endif
+    POS_SCHED_LOCK;
+    pos_disableTask(task);
+    task->core     = c;
+    task->affinity = pos_shift1l(c);
+    pos_setTableBit(&posCoreReadyTasks_g[c], task);
+    POS_SCHED_UNLOCK;
+#ifdef POS_DEBUGHELP
+    POS_SETTASKNAME(task, "idle task");
+#endif
+  }
+#else
 #ifdef POS_DEBUGHELP
   task =
 #endif
@@ -3364,6 +6007,22 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #ifdef POS_DEBUGHELP
   POS_SETTASKNAME(task, "idle task");
 #endif
+#endif /* SYS_SMP */
+
+#if POS_TIMERTASK != 0
+  posTimerQueueHead_g = NULL;
+  posTimerTaskSema_g  = posSemaCreate(0);
+#if POSCFG_TASKSTACKTYPE == 1
+  task = posTaskCreate(pos_timertask, NULL, POSCFG_TIMERTASK_PRIO,
+                       (POSCFG_TIMERTASK_STACKSIZE != 0) ?
+                       POSCFG_TIMERTASK_STACKSIZE : taskStackSize);
+#else
+  task = posTaskCreate(pos_timertask, NULL, POSCFG_TIMERTASK_PRIO);
+#endif
+  P_ASSERT("posInit: timer task created",
+           (posTimerTaskSema_g != NULL) && (task != NULL));
+  POS_SETTASKNAME(task, "timer task");
+#endif
 
   /* start mutlitasking */
   posNextTask_g = posTaskCreate(firstfunc, funcarg,
@@ -3376,12 +6035,64 @@ void  POSCALL posInit(POSTASKFUNC_t firstfunc, void *funcarg, VAR_t priority)
 #endif
   POS_SETTASKNAME(posNextTask_g, "root task");
   POS_SCHED_LOCK;
-  posCurrentTask_g  = posNextTask_g;
+  POS_CURRENTTASK   = posNextTask_g;
   posRunning_g      = 1;
-  posInInterrupt_g  = 0;
+  POS_INTNESTING    = 0;
+  pos_lockProfSwitch();
+  pos_statStart();
+  p_pos_startFirstContext();
+  for(;;);
+}
+
+/*-------------------------------------------------------------------------*/
+
+#if SYS_SMP != 0
+
+void POSCALL c_pos_coreStart(void)
+{
+  register UVAR_t ym, xt;
+  POS_LOCKFLAGS;
+
+  while (posRunning_g == 0);
+
+  POS_SCHED_LOCK;
+  ym = POS_FINDROW(&posReadyTasks_g);
+  xt = POS_FINDREADY(ym);
+  posNextTask_g     = posTaskTable_g[(ym * SYS_TASKTABSIZE_X) + xt];
+  POS_CURRENTTASK   = posNextTask_g;
+  posMustSchedule_g = 0;
+  POS_INTNESTING    = 0;
+  pos_lockProfSwitch();
+  pos_statStart();
   p_pos_startFirstContext();
   for(;;);
 }
 
 /*-------------------------------------------------------------------------*/
 
+POSTASK_t POSCALL c_pos_smpCurrentTask(void)
+{
+  register POSTASK_t task;
+  register UVAR_t c, ctr;
+
+  do
+  {
+    c    = POS_CPUID;
+    ctr  = posCoreSwitchCtr_g[c];
+    task = posCoreCurrentTask_g[c];
+  }
+  while ((c != POS_CPUID) || (ctr != posCoreSwitchCtr_g[c]));
+  return task;
+}
+
+/*-------------------------------------------------------------------------*/
+
+UVAR_t POSCALL c_pos_smpInInterrupt(void)
+{
+  return pos_smpReadVar(posCoreInInterrupt_g);
+}
+
+#endif /* SYS_SMP */
+
+/*-------------------------------------------------------------------------*/
+